@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/common/clock.cpp" "CMakeFiles/banking_common.dir/src/common/clock.cpp.o" "gcc" "CMakeFiles/banking_common.dir/src/common/clock.cpp.o.d"
+  "/root/repo/src/common/pending_counter.cpp" "CMakeFiles/banking_common.dir/src/common/pending_counter.cpp.o" "gcc" "CMakeFiles/banking_common.dir/src/common/pending_counter.cpp.o.d"
+  "/root/repo/src/common/prefault.cpp" "CMakeFiles/banking_common.dir/src/common/prefault.cpp.o" "gcc" "CMakeFiles/banking_common.dir/src/common/prefault.cpp.o.d"
+  "/root/repo/src/common/utils.cpp" "CMakeFiles/banking_common.dir/src/common/utils.cpp.o" "gcc" "CMakeFiles/banking_common.dir/src/common/utils.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
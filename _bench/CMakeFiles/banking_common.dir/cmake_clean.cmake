@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/banking_common.dir/src/common/clock.cpp.o"
+  "CMakeFiles/banking_common.dir/src/common/clock.cpp.o.d"
+  "CMakeFiles/banking_common.dir/src/common/pending_counter.cpp.o"
+  "CMakeFiles/banking_common.dir/src/common/pending_counter.cpp.o.d"
+  "CMakeFiles/banking_common.dir/src/common/prefault.cpp.o"
+  "CMakeFiles/banking_common.dir/src/common/prefault.cpp.o.d"
+  "CMakeFiles/banking_common.dir/src/common/utils.cpp.o"
+  "CMakeFiles/banking_common.dir/src/common/utils.cpp.o.d"
+  "libbanking_common.a"
+  "libbanking_common.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/banking_common.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/history/balance_history.cpp" "CMakeFiles/banking_history.dir/src/history/balance_history.cpp.o" "gcc" "CMakeFiles/banking_history.dir/src/history/balance_history.cpp.o.d"
+  "/root/repo/src/history/history_aggregator.cpp" "CMakeFiles/banking_history.dir/src/history/history_aggregator.cpp.o" "gcc" "CMakeFiles/banking_history.dir/src/history/history_aggregator.cpp.o.d"
+  "/root/repo/src/history/history_archive.cpp" "CMakeFiles/banking_history.dir/src/history/history_archive.cpp.o" "gcc" "CMakeFiles/banking_history.dir/src/history/history_archive.cpp.o.d"
+  "/root/repo/src/history/history_collector.cpp" "CMakeFiles/banking_history.dir/src/history/history_collector.cpp.o" "gcc" "CMakeFiles/banking_history.dir/src/history/history_collector.cpp.o.d"
+  "/root/repo/src/history/history_index.cpp" "CMakeFiles/banking_history.dir/src/history/history_index.cpp.o" "gcc" "CMakeFiles/banking_history.dir/src/history/history_index.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench/CMakeFiles/banking_common.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
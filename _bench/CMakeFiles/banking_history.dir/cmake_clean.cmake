@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/banking_history.dir/src/history/balance_history.cpp.o"
+  "CMakeFiles/banking_history.dir/src/history/balance_history.cpp.o.d"
+  "CMakeFiles/banking_history.dir/src/history/history_aggregator.cpp.o"
+  "CMakeFiles/banking_history.dir/src/history/history_aggregator.cpp.o.d"
+  "CMakeFiles/banking_history.dir/src/history/history_archive.cpp.o"
+  "CMakeFiles/banking_history.dir/src/history/history_archive.cpp.o.d"
+  "CMakeFiles/banking_history.dir/src/history/history_collector.cpp.o"
+  "CMakeFiles/banking_history.dir/src/history/history_collector.cpp.o.d"
+  "CMakeFiles/banking_history.dir/src/history/history_index.cpp.o"
+  "CMakeFiles/banking_history.dir/src/history/history_index.cpp.o.d"
+  "libbanking_history.a"
+  "libbanking_history.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/banking_history.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
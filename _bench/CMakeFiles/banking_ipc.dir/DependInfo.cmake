@@ -0,0 +1,23 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/ipc/process_barrier.cpp" "CMakeFiles/banking_ipc.dir/src/ipc/process_barrier.cpp.o" "gcc" "CMakeFiles/banking_ipc.dir/src/ipc/process_barrier.cpp.o.d"
+  "/root/repo/src/ipc/shared_ledger.cpp" "CMakeFiles/banking_ipc.dir/src/ipc/shared_ledger.cpp.o" "gcc" "CMakeFiles/banking_ipc.dir/src/ipc/shared_ledger.cpp.o.d"
+  "/root/repo/src/ipc/shm_transport.cpp" "CMakeFiles/banking_ipc.dir/src/ipc/shm_transport.cpp.o" "gcc" "CMakeFiles/banking_ipc.dir/src/ipc/shm_transport.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench/CMakeFiles/banking_common.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_history.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/banking_ipc.dir/src/ipc/process_barrier.cpp.o"
+  "CMakeFiles/banking_ipc.dir/src/ipc/process_barrier.cpp.o.d"
+  "CMakeFiles/banking_ipc.dir/src/ipc/shared_ledger.cpp.o"
+  "CMakeFiles/banking_ipc.dir/src/ipc/shared_ledger.cpp.o.d"
+  "CMakeFiles/banking_ipc.dir/src/ipc/shm_transport.cpp.o"
+  "CMakeFiles/banking_ipc.dir/src/ipc/shm_transport.cpp.o.d"
+  "libbanking_ipc.a"
+  "libbanking_ipc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/banking_ipc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
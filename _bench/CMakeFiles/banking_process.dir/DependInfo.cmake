@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/process/child_worker.cpp" "CMakeFiles/banking_process.dir/src/process/child_worker.cpp.o" "gcc" "CMakeFiles/banking_process.dir/src/process/child_worker.cpp.o.d"
+  "/root/repo/src/process/multi_account_worker.cpp" "CMakeFiles/banking_process.dir/src/process/multi_account_worker.cpp.o" "gcc" "CMakeFiles/banking_process.dir/src/process/multi_account_worker.cpp.o.d"
+  "/root/repo/src/process/parent_controller.cpp" "CMakeFiles/banking_process.dir/src/process/parent_controller.cpp.o" "gcc" "CMakeFiles/banking_process.dir/src/process/parent_controller.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench/CMakeFiles/banking_common.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_history.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_ipc.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_shard.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
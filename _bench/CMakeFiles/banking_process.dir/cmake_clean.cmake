@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/banking_process.dir/src/process/child_worker.cpp.o"
+  "CMakeFiles/banking_process.dir/src/process/child_worker.cpp.o.d"
+  "CMakeFiles/banking_process.dir/src/process/multi_account_worker.cpp.o"
+  "CMakeFiles/banking_process.dir/src/process/multi_account_worker.cpp.o.d"
+  "CMakeFiles/banking_process.dir/src/process/parent_controller.cpp.o"
+  "CMakeFiles/banking_process.dir/src/process/parent_controller.cpp.o.d"
+  "libbanking_process.a"
+  "libbanking_process.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/banking_process.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,23 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/shard/account_shard.cpp" "CMakeFiles/banking_shard.dir/src/shard/account_shard.cpp.o" "gcc" "CMakeFiles/banking_shard.dir/src/shard/account_shard.cpp.o.d"
+  "/root/repo/src/shard/shard_manager.cpp" "CMakeFiles/banking_shard.dir/src/shard/shard_manager.cpp.o" "gcc" "CMakeFiles/banking_shard.dir/src/shard/shard_manager.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench/CMakeFiles/banking_common.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_history.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_ipc.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/banking_shard.dir/src/shard/account_shard.cpp.o"
+  "CMakeFiles/banking_shard.dir/src/shard/account_shard.cpp.o.d"
+  "CMakeFiles/banking_shard.dir/src/shard/shard_manager.cpp.o"
+  "CMakeFiles/banking_shard.dir/src/shard/shard_manager.cpp.o.d"
+  "libbanking_shard.a"
+  "libbanking_shard.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/banking_shard.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/main.cpp" "CMakeFiles/banking_system.dir/src/main.cpp.o" "gcc" "CMakeFiles/banking_system.dir/src/main.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench/CMakeFiles/banking_common.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_history.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_ipc.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_shard.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_process.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/banking_system.dir/src/main.cpp.o"
+  "CMakeFiles/banking_system.dir/src/main.cpp.o.d"
+  "banking_system"
+  "banking_system.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/banking_system.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/banking_test_support.dir/tests/test_support.cpp.o"
+  "CMakeFiles/banking_test_support.dir/tests/test_support.cpp.o.d"
+  "libbanking_test_support.a"
+  "libbanking_test_support.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/banking_test_support.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/clock_benchmark.dir/benchmarks/clock_benchmark.cpp.o"
+  "CMakeFiles/clock_benchmark.dir/benchmarks/clock_benchmark.cpp.o.d"
+  "clock_benchmark"
+  "clock_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/clock_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/unit/history_test.cpp" "CMakeFiles/history_test.dir/tests/unit/history_test.cpp.o" "gcc" "CMakeFiles/history_test.dir/tests/unit/history_test.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench/CMakeFiles/banking_history.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_test_support.dir/DependInfo.cmake"
+  "/root/repo/_bench/CMakeFiles/banking_common.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,16 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_bench
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(history_test "/root/repo/_bench/history_test")
+set_tests_properties(history_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;150;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(ring_test "/root/repo/_bench/ring_test")
+set_tests_properties(ring_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;159;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(transfer_test "/root/repo/_bench/transfer_test")
+set_tests_properties(transfer_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;168;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(shard_test "/root/repo/_bench/shard_test")
+set_tests_properties(shard_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;177;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(system_test "/root/repo/_bench/system_test" "/root/repo/_bench/banking_system")
+set_tests_properties(system_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;183;add_test;/root/repo/CMakeLists.txt;0;")
@@ -0,0 +1,127 @@
+/**
+ * @file clock_benchmark.cpp
+ * @brief Lamport时钟性能基准
+ *
+ * 比较四种实现在多线程下的吞吐：
+ * 1. 互斥锁版本（原实现，作为基线）
+ * 2. 无锁全局时钟（所有线程共享一个原子变量）
+ * 3. 每分片时钟域（每个线程独立时钟，每隔若干次事件合并一次其他分片的时间）
+ * 4. 混合逻辑时钟（无锁全局时钟 + 每次事件读取物理时间），
+ *    同时报告结束时 l 领先物理时间的毫秒数和逻辑计数
+ *
+ * 用法: clock_benchmark [线程数] [每线程事件数] [跨分片间隔]
+ */
+
+#include "banking_system/common/clock.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief 原互斥锁版本的Lamport时钟（基线）
+ */
+class MutexLamportClock {
+public:
+    lamport_time_t update(lamport_time_t received_time = 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        time_ = std::max(time_, received_time) + 1;
+        return time_;
+    }
+
+private:
+    lamport_time_t time_ = 0;
+    std::mutex mutex_;
+};
+
+/**
+ * @brief 启动 threads 个线程执行 body，返回总耗时（秒）
+ */
+double run_threads(int threads, const std::function<void(int)>& body) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(body, t);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double>(elapsed).count();
+}
+
+void report(const char* name, int threads, long ops, double seconds) {
+    double total = static_cast<double>(threads) * ops;
+    std::printf("%-20s %10.2f ns/op %12.2f Mops/s\n",
+                name, seconds * 1e9 / total, total / seconds / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int threads = argc > 1 ? std::atoi(argv[1]) 
+                           : static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    long ops = argc > 2 ? std::atol(argv[2]) : 1000000;
+    long cross_every = argc > 3 ? std::atol(argv[3]) : 4;
+    if (threads < 1 || ops < 1 || cross_every < 1) {
+        std::fprintf(stderr, "用法: %s [线程数] [每线程事件数] [跨分片间隔]\n", argv[0]);
+        return 1;
+    }
+
+    std::printf("线程数: %d, 每线程事件数: %ld, 每 %ld 次事件跨分片一次\n\n",
+                threads, ops, cross_every);
+
+    MutexLamportClock mutex_clock;
+    double seconds = run_threads(threads, [&](int) {
+        for (long i = 0; i < ops; ++i) {
+            mutex_clock.update();
+        }
+    });
+    report("mutex (baseline)", threads, ops, seconds);
+
+    LamportClock atomic_clock;
+    seconds = run_threads(threads, [&](int) {
+        for (long i = 0; i < ops; ++i) {
+            atomic_clock.update();
+        }
+    });
+    report("atomic global", threads, ops, seconds);
+
+    std::vector<std::unique_ptr<LamportClock>> shard_clocks;
+    for (int t = 0; t < threads; ++t) {
+        shard_clocks.push_back(std::make_unique<LamportClock>());
+    }
+    seconds = run_threads(threads, [&](int self) {
+        LamportClock& own = *shard_clocks[self];
+        LamportClock& peer = *shard_clocks[(self + 1) % threads];
+        for (long i = 0; i < ops; ++i) {
+            if (i % cross_every == 0) {
+                // 模拟收到其他分片移交的任务
+                own.merge(peer.get_time());
+            }
+            own.update();
+        }
+    });
+    report("per-shard domains", threads, ops, seconds);
+
+    LamportClock hybrid_clock(TimeSource::HYBRID);
+    seconds = run_threads(threads, [&](int) {
+        for (long i = 0; i < ops; ++i) {
+            hybrid_clock.update();
+        }
+    });
+    report("hybrid (HLC)", threads, ops, seconds);
+    lamport_time_t hlc_time = hybrid_clock.get_time();
+    std::printf("%-20s %10ld ms (logical %ld)\n", "  HLC physical lead",
+                static_cast<long>(hlc_physical(hlc_time) - steady_physical_time()),
+                static_cast<long>(hlc_logical(hlc_time)));
+
+    return 0;
+}
@@ -12,10 +12,27 @@
 #include "banking_system/common/types.h"
 #include "banking_system/common/clock.h"
 #include "banking_system/common/utils.h"
+#include "banking_system/common/prefault.h"
+
+// ==================== 余额历史组件 ====================
+#include "banking_system/history/balance_history.h"
+#include "banking_system/history/history_wire.h"
+#include "banking_system/history/history_aggregator.h"
+#include "banking_system/history/history_index.h"
+#include "banking_system/history/history_archive.h"
+
+// ==================== 进程间通信组件 ====================
+#include "banking_system/ipc/shm_transport.h"
+#include "banking_system/ipc/shared_ledger.h"
+#include "banking_system/ipc/process_barrier.h"
+#include "banking_system/ipc/spanning_tree.h"
 
 // ==================== 转账组件 ====================
 #include "banking_system/transfer/transfer_task.h"
 #include "banking_system/transfer/cross_shard_context.h"
+#include "banking_system/transfer/transfer_handle.h"
+#include "banking_system/transfer/transfer_batch.h"
+#include "banking_system/transfer/account_directory.h"
 
 // ==================== 分片组件 ====================
 #include "banking_system/shard/account_shard.h"
@@ -24,6 +41,7 @@
 // ==================== 进程管理组件 ====================
 #include "banking_system/process/parent_controller.h"
 #include "banking_system/process/child_worker.h"
+#include "banking_system/process/multi_account_worker.h"
 
 // ==================== 外部依赖 ====================
 #include "labs_headers/message.h"
@@ -37,6 +55,7 @@
  * 
  * 提供多分片并发转账功能，支持：
  * - Lamport逻辑时钟
+ * - 共享内存消息传输
  * - 分片内/跨分片转账
  * - 并发处理
  * - 历史记录追踪
@@ -2,48 +2,193 @@
 #define BANKING_SYSTEM_COMMON_CLOCK_H
 
 #include "types.h"
-#include <mutex>
+#include <atomic>
 
-// ==================== Lamport逻辑时钟管理 ====================
+// ==================== 逻辑时钟管理 ====================
+
+/**
+ * @brief 时钟域模式
+ */
+enum class ClockMode {
+    GLOBAL,       ///< 所有分片共享进程级时钟
+    PER_SHARD     ///< 每个分片拥有独立时钟，只在消息跨分片时合并
+};
+
+/**
+ * @brief 时间来源
+ */
+enum class TimeSource {
+    LAMPORT,      ///< 纯Lamport计数器
+    HYBRID        ///< 混合逻辑时钟（HLC）：物理时间 + 逻辑计数
+};
+
+/**
+ * @brief 物理时钟函数类型
+ * 
+ * 实验库的 get_physical_time 返回16位 timestamp_t，
+ * 可以用无捕获的lambda包装后传入
+ */
+using PhysicalClock = lamport_time_t (*)();
+
+/**
+ * @brief 默认物理时钟：进程组公共起点以来的毫秒数
+ * 
+ * 起点在静态初始化时确定，fork出的子进程继承同一起点，
+ * 因此各账户进程的物理时间可以直接比较
+ */
+lamport_time_t steady_physical_time();
+
+// ==================== 混合逻辑时钟编码 ====================
+
+/**
+ * @brief HLC时间戳中逻辑计数占用的低位数
+ *
+ * HYBRID 模式下 64 位时间戳编码为 (l << kHlcLogicalBits) | c：
+ * l 为物理时间部分（毫秒），c 为同一 l 内的逻辑计数。
+ * 消息头只携带低16位，收发双方的时间戳相差须在 ±32767 以内才能还原，
+ * 因此计数只占8位：每毫秒可区分256个事件，允许的消息延迟约为127毫秒
+ */
+constexpr int kHlcLogicalBits = 8;
+
+/**
+ * @brief HLC逻辑计数的掩码
+ */
+constexpr lamport_time_t kHlcLogicalMask = (lamport_time_t(1) << kHlcLogicalBits) - 1;
+
+/**
+ * @brief HLC时间戳的物理时间部分 l
+ */
+inline lamport_time_t hlc_physical(lamport_time_t time) {
+    return time >> kHlcLogicalBits;
+}
+
+/**
+ * @brief HLC时间戳的逻辑计数部分 c
+ */
+inline lamport_time_t hlc_logical(lamport_time_t time) {
+    return time & kHlcLogicalMask;
+}
+
+/**
+ * @brief 由 (l, c) 组成HLC时间戳
+ *
+ * 计数超过 kHlcLogicalMask 时进位到 l（同一毫秒内事件超过256个），
+ * 时间戳仍然严格递增，l 暂时领先物理时间，物理时间追上后计数重新归零
+ */
+inline lamport_time_t hlc_pack(lamport_time_t physical, lamport_time_t logical) {
+    return (physical << kHlcLogicalBits) + logical;
+}
+
+/**
+ * @brief 取64位逻辑时间的低16位，写入消息头
+ */
+inline timestamp_t wire_timestamp(lamport_time_t time) {
+    return static_cast<timestamp_t>(static_cast<uint16_t>(time));
+}
+
+/**
+ * @brief 把消息头中的16位时间戳还原为64位逻辑时间
+ * 
+ * 取低16位与 wire 相同、且离 reference 最近的值。只要收发双方的
+ * 时钟相差不超过±32767，还原结果就是发送方的真实时间
+ * 
+ * @param wire 消息头时间戳
+ * @param reference 接收方当前时间
+ */
+inline lamport_time_t widen_timestamp(timestamp_t wire, lamport_time_t reference) {
+    auto delta = static_cast<int16_t>(static_cast<uint16_t>(wire) - static_cast<uint16_t>(reference));
+    return reference + delta;
+}
 
 /**
  * @brief Lamport逻辑时钟类
  * 
- * 提供线程安全的分布式逻辑时钟实现
+ * 提供线程安全的无锁分布式逻辑时钟实现（原子CAS循环），内部为64位时间，
+ * 消息头只携带低16位（见 wire_timestamp / widen_timestamp）
  * 遵循Lamport时钟算法：
  * - 本地事件发生时，时钟+1
  * - 接收消息时，时钟 = max(本地时钟, 消息时钟) + 1
+ * 
+ * 进程级时钟通过 instance() 获取；分片也可以持有自己的时钟实例
+ * （见 ClockMode::PER_SHARD）。
+ * 
+ * TimeSource::HYBRID 下按标准混合逻辑时钟 (l, c) 推进（编码见 hlc_pack）：
+ * - l' = max(l, 消息的 l, 物理时间)
+ * - l' 等于原来的 l 和/或消息的 l 时，c' = 其中较大的计数 + 1；否则 c' = 0
+ * 逻辑计数只在同一毫秒内累加，物理时间前进时归零，
+ * 因此 l 始终贴近物理时间，不会随消息数量持续增长
  */
 class LamportClock {
 public:
     /**
-     * @brief 获取单例实例
+     * @brief 构造函数
+     * @param source 时间来源
+     * @param physical 物理时钟（HYBRID模式使用，nullptr表示 steady_physical_time）
+     */
+    explicit LamportClock(TimeSource source = TimeSource::LAMPORT,
+                          PhysicalClock physical = nullptr)
+        : time_(0)
+        , source_(source)
+        , physical_(physical ? physical : &steady_physical_time) {}
+    ~LamportClock() = default;
+    
+    // 禁止拷贝和赋值
+    LamportClock(const LamportClock&) = delete;
+    LamportClock& operator=(const LamportClock&) = delete;
+    
+    /**
+     * @brief 获取进程级单例实例
      */
     static LamportClock& instance();
     
     /**
-     * @brief 更新Lamport时钟（线程安全）
+     * @brief 切换时间来源
+     * 
+     * 只能在时钟开始被并发使用之前调用（例如创建子进程和分片之前）
+     * 
+     * @param source 时间来源
+     * @param physical 物理时钟（nullptr表示 steady_physical_time）
+     */
+    void set_time_source(TimeSource source, PhysicalClock physical = nullptr) {
+        source_ = source;
+        physical_ = physical ? physical : &steady_physical_time;
+    }
+    
+    /**
+     * @brief 获取时间来源
+     */
+    TimeSource time_source() const { return source_; }
+    
+    /**
+     * @brief 获取HYBRID模式使用的物理时钟
+     */
+    PhysicalClock physical_clock() const { return physical_; }
+    
+    /**
+     * @brief 更新Lamport时钟（线程安全，无锁）
      * @param received_time 接收到的时间戳（默认为0表示本地事件）
      * @return 更新后的时间戳
      */
-    timestamp_t update(timestamp_t received_time = 0);
+    lamport_time_t update(lamport_time_t received_time = 0);
+    
+    /**
+     * @brief 合并其他时钟域的时间（只取最大值，不递增）
+     * @param other_time 其他时钟域的时间戳
+     */
+    void merge(lamport_time_t other_time);
     
     /**
      * @brief 获取当前Lamport时钟（线程安全）
      * @return 当前时间戳
      */
-    timestamp_t get_time() const;
+    lamport_time_t get_time() const {
+        return time_.load(std::memory_order_acquire);
+    }
 
 private:
-    LamportClock() : time_(0) {}
-    ~LamportClock() = default;
-    
-    // 禁止拷贝和赋值
-    LamportClock(const LamportClock&) = delete;
-    LamportClock& operator=(const LamportClock&) = delete;
-    
-    timestamp_t time_;           // 当前逻辑时间
-    mutable std::mutex mutex_;   // 保护时钟的互斥锁
+    alignas(64) std::atomic<lamport_time_t> time_;   // 当前逻辑时间（独占缓存行）
+    TimeSource source_;                           // 时间来源
+    PhysicalClock physical_;                      // 物理时钟（HYBRID模式）
 };
 
 // ==================== 全局便利函数 ====================
@@ -53,16 +198,38 @@ private:
  * @param received_time 接收到的时间戳
  * @return 更新后的时间戳
  */
-inline timestamp_t update_lamport_time(timestamp_t received_time = 0) {
+inline lamport_time_t update_lamport_time(lamport_time_t received_time = 0) {
     return LamportClock::instance().update(received_time);
 }
 
+/**
+ * @brief 收到消息时更新Lamport时钟（消息头时间戳先还原为64位）
+ * @param wire_time 消息头中的时间戳
+ * @return 更新后的时间戳
+ */
+inline lamport_time_t receive_lamport_time(timestamp_t wire_time) {
+    LamportClock& clock = LamportClock::instance();
+    return clock.update(widen_timestamp(wire_time, clock.get_time()));
+}
+
 /**
  * @brief 获取当前Lamport时钟的全局便利函数
  * @return 当前时间戳
  */
-inline timestamp_t get_lamport_time() {
+inline lamport_time_t get_lamport_time() {
     return LamportClock::instance().get_time();
 }
 
-#endif // BANKING_SYSTEM_COMMON_CLOCK_H
\ No newline at end of file
+/**
+ * @brief 把进程级时钟切换为混合逻辑时钟
+ * 
+ * 需在创建子进程之前调用，子进程继承该设置；PER_SHARD模式下
+ * 分片时钟在创建时沿用进程级时钟的时间来源
+ * 
+ * @param physical 物理时钟（nullptr表示 steady_physical_time）
+ */
+inline void use_hybrid_time(PhysicalClock physical = nullptr) {
+    LamportClock::instance().set_time_source(TimeSource::HYBRID, physical);
+}
+
+#endif // BANKING_SYSTEM_COMMON_CLOCK_H
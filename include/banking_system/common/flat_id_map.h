@@ -0,0 +1,195 @@
+#ifndef BANKING_SYSTEM_COMMON_FLAT_ID_MAP_H
+#define BANKING_SYSTEM_COMMON_FLAT_ID_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// ==================== 开放寻址ID表 ====================
+
+/**
+ * @brief 以64位ID为键的开放寻址哈希表（线性探测）
+ *
+ * 替代 unordered_map<uint64_t, V>：所有槽位在一块连续数组中，
+ * 插入和删除不分配节点；删除使用后移（backward shift），不留墓碑。
+ * 槽位数保持为元素数的两倍以上，超过时整体扩容一倍并重新插入，
+ * 按预期的在途深度预留后稳态下不再分配内存。
+ *
+ * 键0保留为空槽标记（关联ID从1开始分配，表分配的ID带最高位）。
+ * 非线程安全，由所属工作线程独占
+ *
+ * @tparam V 值类型（需可默认构造和移动赋值）
+ */
+template <typename V>
+class FlatIdMap {
+public:
+    /**
+     * @brief 构造函数
+     * @param expected 预期的最大元素数（槽位数取不小于其两倍的2的幂）
+     */
+    explicit FlatIdMap(size_t expected = 64)
+        : capacity_(round_up_pow2(expected * 2 < 8 ? 8 : expected * 2))
+        , slots_(new Slot[capacity_])
+        , size_(0)
+    {
+    }
+
+    // 禁止拷贝和赋值
+    FlatIdMap(const FlatIdMap&) = delete;
+    FlatIdMap& operator=(const FlatIdMap&) = delete;
+
+    /**
+     * @brief 查找键对应的值
+     * @return 不存在返回nullptr
+     */
+    V* find(uint64_t key) {
+        size_t index;
+        return locate(key, &index) ? &slots_[index].value : nullptr;
+    }
+
+    /**
+     * @brief 插入键值对（键不能为0）
+     * @return 键已存在返回false，原值不变
+     */
+    bool insert(uint64_t key, const V& value) {
+        if ((size_ + 1) * 2 > capacity_) {
+            grow();
+        }
+        size_t index = home(key);
+        while (slots_[index].key != kEmptyKey) {
+            if (slots_[index].key == key) {
+                return false;
+            }
+            index = (index + 1) & (capacity_ - 1);
+        }
+        slots_[index].key = key;
+        slots_[index].value = value;
+        ++size_;
+        return true;
+    }
+
+    /**
+     * @brief 删除键，可选地取出它的值
+     * @param key 键
+     * @param out 输出：被删除的值（可为nullptr）
+     * @return 键不存在返回false
+     */
+    bool erase(uint64_t key, V* out = nullptr) {
+        size_t hole;
+        if (!locate(key, &hole)) {
+            return false;
+        }
+        if (out != nullptr) {
+            *out = std::move(slots_[hole].value);
+        }
+        // 后移删除：把探测链上后续元素挪进空洞，直到遇到空槽
+        const size_t mask = capacity_ - 1;
+        size_t next = hole;
+        while (true) {
+            next = (next + 1) & mask;
+            if (slots_[next].key == kEmptyKey) {
+                break;
+            }
+            // 元素的理想位置不在 (hole, next] 之间时，才能移到空洞处
+            size_t ideal = home(slots_[next].key);
+            bool stays = hole <= next ? (hole < ideal && ideal <= next)
+                                      : (hole < ideal || ideal <= next);
+            if (!stays) {
+                slots_[hole] = std::move(slots_[next]);
+                hole = next;
+            }
+        }
+        slots_[hole].key = kEmptyKey;
+        slots_[hole].value = V();
+        --size_;
+        return true;
+    }
+
+    /**
+     * @brief 元素数量
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief 是否为空
+     */
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief 槽位数量
+     */
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief 依次访问每个元素 fn(key, value)（顺序不确定，访问期间不能修改表）
+     */
+    template <typename Fn>
+    void for_each(Fn fn) const {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (slots_[i].key != kEmptyKey) {
+                fn(slots_[i].key, slots_[i].value);
+            }
+        }
+    }
+
+private:
+    static constexpr uint64_t kEmptyKey = 0;
+
+    struct Slot {
+        uint64_t key = kEmptyKey;   ///< 键（0表示空槽）
+        V value{};                  ///< 值
+    };
+
+    static size_t round_up_pow2(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /**
+     * @brief 键的理想槽位（混合高低位，递增ID和带代数的表ID都能均匀分布）
+     */
+    size_t home(uint64_t key) const {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key) & (capacity_ - 1);
+    }
+
+    bool locate(uint64_t key, size_t* index) const {
+        if (key == kEmptyKey) {
+            return false;
+        }
+        size_t i = home(key);
+        while (slots_[i].key != kEmptyKey) {
+            if (slots_[i].key == key) {
+                *index = i;
+                return true;
+            }
+            i = (i + 1) & (capacity_ - 1);
+        }
+        return false;
+    }
+
+    void grow() {
+        size_t old_capacity = capacity_;
+        std::unique_ptr<Slot[]> old_slots = std::move(slots_);
+        capacity_ = old_capacity * 2;
+        slots_.reset(new Slot[capacity_]);
+        size_ = 0;
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old_slots[i].key != kEmptyKey) {
+                insert(old_slots[i].key, old_slots[i].value);
+            }
+        }
+    }
+
+    size_t capacity_;                   ///< 槽位数量（2的幂）
+    std::unique_ptr<Slot[]> slots_;     ///< 槽位数组
+    size_t size_;                       ///< 元素数量
+};
+
+#endif // BANKING_SYSTEM_COMMON_FLAT_ID_MAP_H
@@ -0,0 +1,192 @@
+#ifndef BANKING_SYSTEM_COMMON_MPSC_RING_H
+#define BANKING_SYSTEM_COMMON_MPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// ==================== 无锁有界MPSC环形队列 ====================
+
+/**
+ * @brief CPU自旋等待提示
+ */
+inline void spin_pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * @brief 有界多生产者/单消费者无锁队列（Vyukov算法）
+ *
+ * 每个槽位带一个序号：生产者通过CAS抢占写入位置，
+ * 写完数据后发布序号；唯一的消费者按序号判断槽位是否可读。
+ * 生产者之间只在 enqueue_pos_ 上竞争，不需要互斥锁。
+ *
+ * @tparam T 元素类型（需可默认构造和拷贝赋值）
+ */
+template <typename T>
+class MpscRing {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 容量（向上取整为2的幂）
+     */
+    explicit MpscRing(size_t capacity)
+        : capacity_(round_up_pow2(capacity < 2 ? 2 : capacity))
+        , mask_(capacity_ - 1)
+        , cells_(new Cell[capacity_])
+        , enqueue_pos_(0)
+        , dequeue_pos_(0)
+    {
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // 禁止拷贝和赋值
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /**
+     * @brief 尝试入队（任意线程）
+     * @return 队列已满返回false
+     */
+    bool try_push(const T& item) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                                       std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 批量入队（任意线程）
+     *
+     * 一次CAS抢占一段连续槽位，再逐个写入并发布。
+     * 消费者按顺序释放槽位，因此 dequeue_pos_ 之前的槽位必然空闲。
+     *
+     * @param items 元素数组
+     * @param count 元素数量
+     * @return 实际入队的元素数量（队列满时可能少于count，甚至为0）
+     */
+    size_t try_push_bulk(const T* items, size_t count) {
+        if (count == 0) {
+            return 0;
+        }
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t n;
+        while (true) {
+            size_t deq = dequeue_pos_.load(std::memory_order_acquire);
+            size_t used = pos > deq ? pos - deq : 0;
+            if (used >= capacity_) {
+                return 0;
+            }
+            n = std::min(count, capacity_ - used);
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + n,
+                                                   std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            cell.data = items[i];
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    /**
+     * @brief 尝试出队（仅消费者线程）
+     * @return 队列为空（或队首尚未发布）返回false
+     */
+    bool try_pop(T& item) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell = &cells_[pos & mask_];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false;
+        }
+        item = cell->data;
+        cell->sequence.store(pos + capacity_, std::memory_order_release);
+        dequeue_pos_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 批量出队（仅消费者线程）
+     * @param out 输出数组
+     * @param max_count 最多取出的元素数
+     * @return 实际取出的元素数
+     */
+    size_t pop_bulk(T* out, size_t max_count) {
+        size_t count = 0;
+        while (count < max_count && try_pop(out[count])) {
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief 近似元素数量（任意线程，仅作参考）
+     */
+    size_t size_approx() const {
+        size_t enq = enqueue_pos_.load(std::memory_order_acquire);
+        size_t deq = dequeue_pos_.load(std::memory_order_acquire);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    /**
+     * @brief 是否为空（近似）
+     */
+    bool empty_approx() const { return size_approx() == 0; }
+
+    /**
+     * @brief 是否已满（近似）
+     */
+    bool full_approx() const { return size_approx() >= capacity_; }
+
+    /**
+     * @brief 获取容量
+     */
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;   ///< 槽位序号
+        T data;                         ///< 元素
+    };
+
+    static size_t round_up_pow2(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;                             ///< 容量（2的幂）
+    const size_t mask_;                                 ///< 下标掩码
+    std::unique_ptr<Cell[]> cells_;                     ///< 槽位数组
+    alignas(64) std::atomic<size_t> enqueue_pos_;       ///< 生产者写入位置
+    alignas(64) std::atomic<size_t> dequeue_pos_;       ///< 消费者读取位置
+};
+
+#endif // BANKING_SYSTEM_COMMON_MPSC_RING_H
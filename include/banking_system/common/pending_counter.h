@@ -0,0 +1,66 @@
+#ifndef BANKING_SYSTEM_COMMON_PENDING_COUNTER_H
+#define BANKING_SYSTEM_COMMON_PENDING_COUNTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// ==================== 未完成工作计数器 ====================
+
+/**
+ * @brief 未完成工作计数器
+ * 
+ * 提交工作时 add()，工作彻底结束时 done()。
+ * 等待者阻塞在计数归零上：计数降到0的那一刻被唤醒，
+ * 只有归零时才会获取互斥锁，计数变化本身是无锁的。
+ */
+class PendingCounter {
+public:
+    PendingCounter() : count_(0) {}
+    
+    // 禁止拷贝和赋值
+    PendingCounter(const PendingCounter&) = delete;
+    PendingCounter& operator=(const PendingCounter&) = delete;
+    
+    /**
+     * @brief 增加未完成工作数量
+     * @param n 增加的数量
+     */
+    void add(size_t n = 1) {
+        count_.fetch_add(n, std::memory_order_acq_rel);
+    }
+    
+    /**
+     * @brief 减少未完成工作数量，归零时唤醒所有等待者
+     * @param n 减少的数量
+     */
+    void done(size_t n = 1);
+    
+    /**
+     * @brief 获取当前未完成工作数量
+     */
+    size_t pending() const {
+        return count_.load(std::memory_order_acquire);
+    }
+    
+    /**
+     * @brief 阻塞直到计数归零
+     */
+    void wait();
+    
+    /**
+     * @brief 阻塞直到计数归零或到达截止时间
+     * @param deadline 截止时间
+     * @return 计数已归零返回true，超时返回false
+     */
+    bool wait_until(std::chrono::steady_clock::time_point deadline);
+
+private:
+    std::atomic<size_t> count_;         ///< 未完成工作数量
+    std::mutex mutex_;                  ///< 等待者使用的互斥锁
+    std::condition_variable zero_cv_;   ///< 计数归零通知
+};
+
+#endif // BANKING_SYSTEM_COMMON_PENDING_COUNTER_H
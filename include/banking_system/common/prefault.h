@@ -0,0 +1,36 @@
+#ifndef BANKING_SYSTEM_COMMON_PREFAULT_H
+#define BANKING_SYSTEM_COMMON_PREFAULT_H
+
+#include <cstddef>
+
+// ==================== 共享段预缺页 ====================
+
+/**
+ * @brief 用多个线程预先写入映射区间的每一页
+ *
+ * 启动方在fork之前调用：共享匿名映射的物理页在这里并行分配、清零，
+ * 子进程继承后只剩轻量的页表缺页，不再在第一次收发消息或第一笔转账时
+ * 各自串行承担分配开销。写入的是页内原有的值，已初始化的内容不受影响，
+ * 但调用期间不能有其他线程或进程并发修改该区间
+ *
+ * @param base 区间起始地址
+ * @param length 区间长度（字节）
+ * @param threads 线程数（<=0 时使用硬件并发数）
+ */
+void prefault_pages(void* base, size_t length, int threads = 0);
+
+/**
+ * @brief 跨距版本：预缺页 count 个等距的子区间
+ *
+ * 第i个子区间从 base + i*stride 开始、长 length 字节，
+ * 用于只预热每个账户日志的开头等稀疏的访问模式
+ *
+ * @param base 第一个子区间的起始地址
+ * @param count 子区间个数
+ * @param stride 相邻子区间起始地址的间距（字节）
+ * @param length 每个子区间的长度（字节）
+ * @param threads 线程数（<=0 时使用硬件并发数）
+ */
+void prefault_strided(void* base, size_t count, size_t stride, size_t length, int threads = 0);
+
+#endif // BANKING_SYSTEM_COMMON_PREFAULT_H
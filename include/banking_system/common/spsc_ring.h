@@ -0,0 +1,111 @@
+#ifndef BANKING_SYSTEM_COMMON_SPSC_RING_H
+#define BANKING_SYSTEM_COMMON_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// ==================== 无锁有界SPSC环形队列 ====================
+
+/**
+ * @brief 有界单生产者/单消费者无锁队列
+ *
+ * 生产者只写 head_，消费者只写 tail_，两者位于不同缓存行；
+ * 双方各自缓存对方的位置，只有缓存值显示满/空时才重新读取原子变量。
+ *
+ * @tparam T 元素类型（需可默认构造和拷贝赋值）
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 容量（向上取整为2的幂）
+     */
+    explicit SpscRing(size_t capacity)
+        : capacity_(round_up_pow2(capacity < 2 ? 2 : capacity))
+        , mask_(capacity_ - 1)
+        , items_(new T[capacity_])
+        , head_(0)
+        , cached_tail_(0)
+        , tail_(0)
+        , cached_head_(0)
+    {}
+
+    // 禁止拷贝和赋值
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief 尝试入队（仅生产者线程）
+     * @return 队列已满返回false
+     */
+    bool try_push(const T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ >= capacity_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ >= capacity_) {
+                return false;
+            }
+        }
+        items_[head & mask_] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 尝试出队（仅消费者线程）
+     * @return 队列为空返回false
+     */
+    bool try_pop(T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) {
+                return false;
+            }
+        }
+        item = items_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 是否为空（近似，任意线程）
+     */
+    bool empty_approx() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 是否已满（近似，任意线程）
+     */
+    bool full_approx() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire) >=
+               capacity_;
+    }
+
+    /**
+     * @brief 获取容量
+     */
+    size_t capacity() const { return capacity_; }
+
+private:
+    static size_t round_up_pow2(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;                     ///< 容量（2的幂）
+    const size_t mask_;                         ///< 下标掩码
+    std::unique_ptr<T[]> items_;                ///< 元素数组
+    alignas(64) std::atomic<size_t> head_;      ///< 生产者写入位置
+    size_t cached_tail_;                        ///< 生产者缓存的消费者位置
+    alignas(64) std::atomic<size_t> tail_;      ///< 消费者读取位置
+    size_t cached_head_;                        ///< 消费者缓存的生产者位置
+};
+
+#endif // BANKING_SYSTEM_COMMON_SPSC_RING_H
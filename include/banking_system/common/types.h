@@ -1,33 +1,28 @@
 #ifndef BANKING_SYSTEM_COMMON_TYPES_H
 #define BANKING_SYSTEM_COMMON_TYPES_H
 
+#include "labs_headers/banking.h"
 #include <cstdint>
 
 // ==================== 基础类型定义 ====================
 
-/**
- * @brief 时间戳类型（Lamport逻辑时钟）
- */
-using timestamp_t = int;
-
-/**
- * @brief 余额类型
- */
-using balance_t = int;
-
-/**
- * @brief 本地进程ID类型
- */
-using local_id = uint8_t;
+// local_id、balance_t、BUF_SIZE、MAX_T 以及线上传输的16位 timestamp_t
+// 均由 labs_headers 定义，这里不再重复定义，避免与其冲突
 
 /**
- * @brief 缓冲区大小常量
+ * @brief 64位逻辑时间（Lamport / HLC）
+ * 
+ * 时钟和余额历史内部使用；消息头只携带其低16位（timestamp_t），
+ * 接收方用 widen_timestamp 还原
  */
-constexpr int BUF_SIZE = 256;
+using lamport_time_t = int64_t;
 
 /**
- * @brief 最大时间戳
+ * @brief 32位账户ID
+ * 
+ * 一个进程托管多个账户时（MultiAccountWorker），账户ID不再等于进程ID，
+ * 不受 local_id（int8_t）和 MAX_PROCESS_ID 的限制；有效账户ID从1开始
  */
-constexpr int MAX_T = 1024;
+using account_id_t = uint32_t;
 
-#endif // BANKING_SYSTEM_COMMON_TYPES_H
\ No newline at end of file
+#endif // BANKING_SYSTEM_COMMON_TYPES_H
@@ -0,0 +1,302 @@
+#ifndef BANKING_SYSTEM_HISTORY_BALANCE_HISTORY_H
+#define BANKING_SYSTEM_HISTORY_BALANCE_HISTORY_H
+
+#include "banking_system/common/types.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class HistoryArchive;
+
+// ==================== 可扩展余额历史 ====================
+
+/**
+ * @brief 带64位时间戳的余额状态
+ *
+ * 与 BalanceState 字段含义相同，只是时间戳扩展为64位
+ */
+typedef struct {
+    lamport_time_t s_time;              ///< 逻辑时间
+    balance_t      s_balance;           ///< 余额
+    balance_t      s_balance_pending_in;///< 已扣款但尚未入账的在途金额
+} __attribute__((packed)) WideBalanceState;
+
+/**
+ * @brief 可扩展余额历史（变化点表示）
+ *
+ * 替代固定 BalanceState[MAX_T + 1] 数组的 BalanceHistory：
+ * - 只记录余额或在途金额发生变化的时刻（变化点），两个变化点之间的
+ *   时刻沿用前一个变化点的状态；内存和传输量随事件数增长，而不是随逻辑时间
+ * - 时间戳为64位，可以记录数百万个时钟周期
+ * - 分块存储，每块 kChunkStates 个变化点，按需追加新块；已写满的块永不移动，
+ *   扩容不需要拷贝旧数据。第一块从 kInitialChunkStates 开始倍增到整块，
+ *   一个进程托管大量账户时，只有少量变化点的账户不会各占一整块
+ * - state_at 二分查找任意时刻的状态，O(log n)
+ * - 只有在 to_legacy / expand 时才展开为逐时刻的稠密形式
+ * - 可选冷存储：启用 enable_archive 后，内存中的块数超过上限时把最旧的整块
+ *   追加到按账户的内存映射段文件（HistoryArchive）并释放；下标访问、查询和
+ *   导出对两层透明，冷层直接读映射区域，不拷贝回内存。段文件在第一次转储时
+ *   才创建，历史销毁时删除
+ *
+ * 非线程安全，由所属账户进程独占
+ */
+class ScalableBalanceHistory {
+public:
+    /**
+     * @brief 每块容纳的变化点数
+     */
+    static constexpr size_t kChunkStates = 4096;
+
+    /**
+     * @brief 第一块的初始容量
+     */
+    static constexpr size_t kInitialChunkStates = 8;
+
+    /**
+     * @brief 构造函数
+     * @param id 账户ID
+     */
+    explicit ScalableBalanceHistory(account_id_t id = 0);
+    ~ScalableBalanceHistory();
+
+    // 允许移动，禁止拷贝（历史可能很大）
+    ScalableBalanceHistory(ScalableBalanceHistory&&);
+    ScalableBalanceHistory& operator=(ScalableBalanceHistory&&);
+    ScalableBalanceHistory(const ScalableBalanceHistory&) = delete;
+    ScalableBalanceHistory& operator=(const ScalableBalanceHistory&) = delete;
+
+    /**
+     * @brief 清空历史并写入时间0的初始余额
+     * @param id 账户ID
+     * @param initial_balance 初始余额
+     */
+    void reset(account_id_t id, balance_t initial_balance);
+
+    /**
+     * @brief 清空历史（保留已分配的块）
+     * @param id 账户ID
+     */
+    void clear(account_id_t id);
+
+    /**
+     * @brief 启用冷存储
+     *
+     * 之后每当内存中的块数达到 hot_chunks，最旧的一整块变化点会被追加到段文件。
+     * 最后一个变化点总在内存中（record 可能修改它）。段文件在第一次转储时才创建，
+     * 创建失败时历史继续只使用内存
+     *
+     * @param path 段文件路径（创建或截断，历史销毁时删除）
+     * @param hot_chunks 内存中最多保留的块数（至少为2）
+     * @return 已有变化点转入旧段文件、不能更换时返回false
+     */
+    bool enable_archive(const std::string& path, size_t hot_chunks);
+
+    /**
+     * @brief 已转入冷存储的变化点数（下标 [0, archived_size()) 在段文件中）
+     */
+    size_t archived_size() const { return base_; }
+
+    /**
+     * @brief 记录 time 时刻的状态
+     *
+     * 与当前状态相同时只延长历史的结束时间；与最后一个变化点同一时刻时
+     * 覆盖该变化点；否则追加新的变化点。time 早于结束时间时按结束时间处理
+     *
+     * @param time 逻辑时间
+     * @param balance 余额
+     * @param pending_in 在途金额
+     */
+    void record(lamport_time_t time, balance_t balance, balance_t pending_in);
+
+    /**
+     * @brief 在末尾原样追加一个变化点（解码时使用，调用方保证时间递增）
+     */
+    void push_back(const WideBalanceState& state);
+
+    /**
+     * @brief 从 from 时刻起把在途金额增加 amount（回溯修改已记录的变化点）
+     *
+     * 入账的发送时间可能早于本账户已记录的变化点（并发的其他转账），
+     * 此时 [from, 结束时间] 内的每个变化点都要计入这笔在途金额。
+     * from 不在变化点上时先在 from 处拆分出一个变化点
+     *
+     * @param from 在途区间的开始时刻（不晚于结束时间）
+     * @param amount 在途金额
+     * @return 第一个被修改的变化点下标（没有修改时返回 size()）
+     */
+    size_t raise_pending(lamport_time_t from, balance_t amount);
+
+    /**
+     * @brief 只保留前 count 个变化点（接收方重写已收到的分段时使用）
+     * @param count 保留的变化点数
+     * @return count 落在冷存储中时返回false，历史不变
+     */
+    bool truncate(size_t count);
+
+    /**
+     * @brief 设置历史的结束时间（解码时使用）
+     */
+    void set_end_time(lamport_time_t end_time) { end_time_ = end_time; }
+
+    /**
+     * @brief 账户ID
+     */
+    account_id_t id() const { return id_; }
+
+    /**
+     * @brief 变化点数量
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief 是否为空
+     */
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief 历史覆盖的最后时刻
+     */
+    lamport_time_t end_time() const { return end_time_; }
+
+    /**
+     * @brief 展开为稠密形式后的状态数（时刻 0 到 end_time）
+     */
+    size_t dense_size() const { return empty() ? 0 : static_cast<size_t>(end_time_) + 1; }
+
+    /**
+     * @brief 按下标访问变化点
+     */
+    const WideBalanceState& operator[](size_t index) const {
+        if (index < base_) {
+            return archived(index);
+        }
+        index -= base_;
+        return chunks_[index / kChunkStates].states[index % kChunkStates];
+    }
+    WideBalanceState& operator[](size_t index) {
+        if (index < base_) {
+            return archived(index);
+        }
+        index -= base_;
+        return chunks_[index / kChunkStates].states[index % kChunkStates];
+    }
+
+    /**
+     * @brief 最后一个变化点（历史不能为空）
+     */
+    const WideBalanceState& back() const { return (*this)[size_ - 1]; }
+    WideBalanceState& back() { return (*this)[size_ - 1]; }
+
+    /**
+     * @brief 查询 time 时刻的状态（二分查找，O(log n)）
+     *
+     * 早于第一个变化点时返回全零状态；晚于结束时间时沿用最后状态。
+     * 返回值的 s_time 为 time
+     *
+     * @param time 逻辑时间
+     */
+    WideBalanceState state_at(lamport_time_t time) const;
+
+    /**
+     * @brief 把 [first, first + count) 时刻展开为稠密状态
+     *
+     * 只对第一个时刻做一次二分查找，之后顺序推进，O(log n + count)
+     *
+     * @param first 第一个时刻
+     * @param count 时刻数
+     * @param out 输出数组（至少 count 个元素）
+     */
+    void expand(lamport_time_t first, size_t count, WideBalanceState* out) const;
+
+    /**
+     * @brief 把 [first, first + count) 时刻展开为结构数组（SoA）形式
+     *
+     * 与 expand 相同，但余额和在途金额分别写入两个连续数组，便于向量化汇总
+     *
+     * @param first 第一个时刻
+     * @param count 时刻数
+     * @param balances 输出余额数组（至少 count 个元素）
+     * @param pending_in 输出在途金额数组（至少 count 个元素）
+     */
+    void expand_soa(lamport_time_t first, size_t count,
+                    balance_t* balances, balance_t* pending_in) const;
+
+    /**
+     * @brief 导出固定结构的兼容视图（按需展开）
+     *
+     * 展开前 UINT8_MAX 个时刻（s_history_len 为 uint8_t），
+     * 时间戳截断为16位；超出部分只能通过本类访问
+     *
+     * @param out 调用方分配的 BalanceHistory
+     */
+    void to_legacy(BalanceHistory* out) const;
+
+private:
+    account_id_t id_;                                       ///< 账户ID
+    size_t size_;                                           ///< 变化点数量
+    lamport_time_t end_time_;                               ///< 历史覆盖的最后时刻
+    /**
+     * @brief 内存中的一块变化点
+     */
+    struct Chunk {
+        std::unique_ptr<WideBalanceState[]> states; ///< 变化点数组
+        size_t capacity;                            ///< 已分配的容量（不超过 kChunkStates）
+    };
+
+    std::vector<Chunk> chunks_;                             ///< 内存中的分块（热层，从下标 base_ 开始）
+    size_t base_;                                           ///< 已转入冷存储的变化点数（kChunkStates的整数倍）
+    size_t hot_chunks_;                                     ///< 热层最多保留的块数（0表示不转储）
+    std::unique_ptr<HistoryArchive> archive_;               ///< 冷存储段文件（第一次转储时创建）
+    std::string archive_path_;                              ///< 冷存储段文件路径
+
+    /**
+     * @brief 访问冷存储中的变化点
+     */
+    WideBalanceState& archived(size_t index) const;
+
+    /**
+     * @brief 把最旧的一整块转入冷存储并回收其内存
+     * @return 写入段文件失败时返回false（之后不再转储）
+     */
+    bool archive_oldest_chunk();
+
+    /**
+     * @brief 第一个时间晚于 time 的变化点下标
+     */
+    size_t upper_bound(lamport_time_t time) const;
+};
+
+// ==================== 辅助函数 ====================
+
+/**
+ * @brief 更新可扩展余额历史
+ *
+ * 语义与 BalanceHistory 版本的 update_history 相同（在途区间内余额不变、
+ * 在途金额为 pending_money，pending_end_time 时刻变为最终余额），
+ * 但只记录变化点，中间未变化的时刻不占空间。
+ * pending_start_time 早于上次记录的时刻时，其后已记录的变化点同样计入在途金额
+ *
+ * @param history 余额历史
+ * @param pending_start_time pending状态开始时间
+ * @param pending_end_time pending状态结束时间
+ * @param amount 最终余额
+ * @param pending_money pending中的金额
+ * @return 第一个被修改或追加的变化点下标，调用方据此重发已发送的部分
+ */
+size_t update_history(ScalableBalanceHistory* history,
+                      lamport_time_t pending_start_time,
+                      lamport_time_t pending_end_time,
+                      balance_t amount,
+                      balance_t pending_money);
+
+/**
+ * @brief 获取当前余额
+ * @param history 余额历史（不能为空）
+ * @return 当前余额
+ */
+inline balance_t now_balance(const ScalableBalanceHistory* history) {
+    return history->back().s_balance;
+}
+
+#endif // BANKING_SYSTEM_HISTORY_BALANCE_HISTORY_H
@@ -0,0 +1,114 @@
+#ifndef BANKING_SYSTEM_HISTORY_HISTORY_AGGREGATOR_H
+#define BANKING_SYSTEM_HISTORY_HISTORY_AGGREGATOR_H
+
+#include "banking_system/history/balance_history.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// ==================== 全账户余额历史汇总 ====================
+
+/**
+ * @brief 全账户余额历史汇总器（替代外部库的 print_history）
+ *
+ * 对时刻 0..end_time 的每一个逻辑时刻，汇总所有账户的余额和在途金额，
+ * 并检查资金守恒（总余额 + 总在途 == 时刻0的总余额）：
+ * - 按 kTileTicks 个时刻分块，每个账户把一块展开为余额/在途两个连续数组（SoA）
+ * - 块内累加和守恒检查使用AVX2（运行时检测CPU），不支持时退回标量实现
+ * - 不受 print_history 的 UINT8_MAX 个时刻和16位时间戳限制
+ *
+ * 输出既包括与原来相同风格的表格，也包括机器可读的JSON报告
+ */
+class HistoryAggregator {
+public:
+    /**
+     * @brief 每块时刻数
+     */
+    static constexpr size_t kTileTicks = 4096;
+
+    /**
+     * @brief 报告中最多列出的守恒违例时刻数
+     */
+    static constexpr size_t kMaxReportedViolations = 64;
+
+    /**
+     * @brief 表格最多单独列出的账户数（多账户模式下其余账户只计入合计列）
+     */
+    static constexpr size_t kMaxTableAccounts = MAX_PROCESS_ID;
+
+    /**
+     * @brief 构造函数
+     * @param histories 各账户的余额历史（按账户ID顺序，生命周期由调用方保证）
+     */
+    explicit HistoryAggregator(std::vector<const ScalableBalanceHistory*> histories);
+
+    /**
+     * @brief 计算每个时刻的总余额、总在途金额并检查资金守恒
+     */
+    void run();
+
+    /**
+     * @brief 当前CPU是否使用AVX2路径
+     */
+    static bool simd_enabled();
+
+    /**
+     * @brief 汇总覆盖的最后时刻
+     */
+    lamport_time_t end_time() const { return end_time_; }
+
+    /**
+     * @brief 时刻0的总余额（守恒的期望值）
+     */
+    int64_t expected_total() const { return expected_total_; }
+
+    /**
+     * @brief 每个时刻的总余额
+     */
+    const std::vector<int32_t>& total_balance() const { return total_balance_; }
+
+    /**
+     * @brief 每个时刻的总在途金额
+     */
+    const std::vector<int32_t>& total_pending_in() const { return total_pending_; }
+
+    /**
+     * @brief 资金不守恒的时刻数
+     */
+    size_t violation_count() const { return violation_count_; }
+
+    /**
+     * @brief 资金不守恒的时刻（最多 kMaxReportedViolations 个）
+     */
+    const std::vector<lamport_time_t>& violations() const { return violations_; }
+
+    /**
+     * @brief 每个时刻资金都守恒
+     */
+    bool conserved() const { return violation_count_ == 0; }
+
+    /**
+     * @brief 打印逐时刻表格（前 kMaxTableAccounts 个账户各一列，外加总余额和总在途列）
+     * @param out 输出流
+     * @param max_ticks 最多打印的时刻数，超出部分只在报告中汇总
+     */
+    void print_table(std::ostream& out, size_t max_ticks) const;
+
+    /**
+     * @brief 写出机器可读的JSON报告
+     * @param out 输出流
+     */
+    void write_report(std::ostream& out) const;
+
+private:
+    std::vector<const ScalableBalanceHistory*> histories_; ///< 各账户的历史
+    lamport_time_t end_time_;                        ///< 汇总覆盖的最后时刻
+    int64_t expected_total_;                         ///< 时刻0的总余额
+    std::vector<int32_t> total_balance_;             ///< 每个时刻的总余额
+    std::vector<int32_t> total_pending_;             ///< 每个时刻的总在途金额
+    size_t violation_count_;                         ///< 不守恒的时刻数
+    std::vector<lamport_time_t> violations_;         ///< 不守恒的时刻（截断）
+};
+
+#endif // BANKING_SYSTEM_HISTORY_HISTORY_AGGREGATOR_H
@@ -0,0 +1,141 @@
+#ifndef BANKING_SYSTEM_HISTORY_HISTORY_ARCHIVE_H
+#define BANKING_SYSTEM_HISTORY_HISTORY_ARCHIVE_H
+
+#include "banking_system/history/balance_history.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ==================== 余额历史冷存储段文件 ====================
+
+/**
+ * @brief 段文件头部
+ *
+ * 文件布局：HistoryArchiveHeader 后紧跟 s_count 个 WideBalanceState（紧凑排列，
+ * 每个12字节），只在末尾追加；s_count 随每次追加更新，文件本身即可自描述
+ */
+typedef struct {
+    uint32_t s_magic;       ///< 魔数 kArchiveMagic
+    uint16_t s_version;     ///< 格式版本
+    uint16_t s_state_size;  ///< 单个状态的字节数
+    uint32_t s_id;          ///< 账户ID
+    uint32_t s_reserved;    ///< 保留
+    uint64_t s_count;       ///< 已写入的状态数
+} __attribute__((packed)) HistoryArchiveHeader;
+
+/**
+ * @brief 余额历史冷存储（按账户、只追加、内存映射的段文件）
+ *
+ * ScalableBalanceHistory 把较旧的变化点整块追加到这里后释放内存，
+ * 查询时直接读取映射区域，不需要再拷贝回内存。
+ * 容量不足时按倍数扩展文件并重新映射（mremap）。
+ * 以临时方式打开的段文件在关闭时删除
+ *
+ * 非线程安全，由所属历史独占
+ */
+class HistoryArchive {
+public:
+    /**
+     * @brief 段文件魔数（"BHSG"）
+     */
+    static constexpr uint32_t kArchiveMagic = 0x47534842;
+
+    /**
+     * @brief 段文件格式版本
+     */
+    static constexpr uint16_t kArchiveVersion = 1;
+
+    HistoryArchive();
+    ~HistoryArchive();
+
+    // 禁止拷贝和赋值
+    HistoryArchive(const HistoryArchive&) = delete;
+    HistoryArchive& operator=(const HistoryArchive&) = delete;
+
+    /**
+     * @brief 设置临时段文件所在目录（进程级，fork之前设置，子进程继承）
+     * @param directory 目录（为空时使用 $TMPDIR，未设置时为 /tmp）
+     */
+    static void set_directory(const std::string& directory);
+
+    /**
+     * @brief 账户在当前进程中的临时段文件路径
+     *
+     * 形如 <目录>/balance_history_<pid>_<账户ID>.seg，多次运行和并发运行互不覆盖
+     *
+     * @param id 账户ID
+     */
+    static std::string temp_path(account_id_t id);
+
+    /**
+     * @brief 创建（或截断）段文件并映射
+     * @param path 文件路径
+     * @param id 账户ID
+     * @param temporary 关闭时是否删除文件
+     * @return 成功返回true，失败时输出错误信息并返回false
+     */
+    bool open(const std::string& path, account_id_t id, bool temporary = false);
+
+    /**
+     * @brief 解除映射并关闭文件（临时段文件同时删除，否则保留在磁盘上）
+     */
+    void close();
+
+    /**
+     * @brief 丢弃全部状态（文件截断为只有头部）
+     * @param id 账户ID
+     */
+    void reset(account_id_t id);
+
+    /**
+     * @brief 在末尾追加一组状态
+     * @param states 状态数组
+     * @param count 状态数量
+     * @return 扩展文件失败时输出错误信息并返回false（已有内容不变）
+     */
+    bool append(const WideBalanceState* states, size_t count);
+
+    /**
+     * @brief 是否已打开
+     */
+    bool is_open() const { return map_ != nullptr; }
+
+    /**
+     * @brief 已写入的状态数
+     */
+    size_t size() const { return count_; }
+
+    /**
+     * @brief 文件路径
+     */
+    const std::string& path() const { return path_; }
+
+    /**
+     * @brief 按下标访问状态（直接读映射区域）
+     */
+    const WideBalanceState& operator[](size_t index) const { return states()[index]; }
+    WideBalanceState& operator[](size_t index) { return states()[index]; }
+
+private:
+    int fd_;                ///< 文件描述符
+    char* map_;             ///< 映射起始地址
+    size_t map_bytes_;      ///< 映射（及文件）字节数
+    size_t count_;          ///< 已写入的状态数
+    std::string path_;      ///< 文件路径
+    bool temporary_;        ///< 关闭时是否删除文件
+
+    WideBalanceState* states() const {
+        return reinterpret_cast<WideBalanceState*>(map_ + sizeof(HistoryArchiveHeader));
+    }
+
+    HistoryArchiveHeader* header() const {
+        return reinterpret_cast<HistoryArchiveHeader*>(map_);
+    }
+
+    /**
+     * @brief 保证映射至少能容纳 states 个状态
+     */
+    bool reserve(size_t states);
+};
+
+#endif // BANKING_SYSTEM_HISTORY_HISTORY_ARCHIVE_H
@@ -0,0 +1,159 @@
+#ifndef BANKING_SYSTEM_HISTORY_HISTORY_COLLECTOR_H
+#define BANKING_SYSTEM_HISTORY_HISTORY_COLLECTOR_H
+
+#include "banking_system/history/balance_history.h"
+#include "banking_system/common/pending_counter.h"
+#include "banking_system/transfer/account_directory.h"
+#include "labs_headers/message.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ==================== 父进程余额历史收集器 ====================
+
+/**
+ * @brief 父进程余额历史收集器
+ *
+ * 子进程在运行期间按 BALANCE_HISTORY_SEGMENT 增量发送已封存的变化点，
+ * 收集器逐段追加到对应账户的历史中，因此 AllHistory 在转账过程中就已
+ * 基本就绪；结束时每个账户只需再发送带 HISTORY_SEGMENT_LAST 标志的最后一段（水位线）。
+ *
+ * 同一账户的消息必须按到达顺序、由同一线程应用；不同账户互不影响。
+ * 一个账户只由一个进程发送，apply_batch 据此把一批消息按发送方分组
+ * （保持每个账户的顺序），交给小型解码线程池并行校验和解码。
+ * 多账户模式下一个发送方托管多个账户，账户ID取自分段头部，并按
+ * AccountDirectory 校验它确实由发送方托管。
+ * 阶段2由ShardManager的ACK分发线程调用 apply，分发线程退出后再由
+ * 父进程主线程调用（线程join保证可见性）
+ */
+class HistoryCollector {
+public:
+    /**
+     * @brief 默认解码线程数
+     */
+    static constexpr int kDefaultDecodeThreads = 4;
+
+    /**
+     * @brief 构造函数（一个进程一个账户）
+     * @param accounts 账户数量（账户ID为 1..accounts，即发送方进程ID）
+     * @param decode_threads 解码线程数（不超过账户数；不大于1时在调用线程中解码）
+     */
+    explicit HistoryCollector(int accounts, int decode_threads = kDefaultDecodeThreads);
+
+    /**
+     * @brief 构造函数（多账户模式）
+     * @param directory 账户目录（账户ID为 1..directory.accounts()）
+     * @param decode_threads 解码线程数（不超过工作进程数；不大于1时在调用线程中解码）
+     */
+    explicit HistoryCollector(const AccountDirectory& directory,
+                              int decode_threads = kDefaultDecodeThreads);
+
+    /**
+     * @brief 析构函数 - 停止解码线程
+     */
+    ~HistoryCollector();
+
+    // 禁止拷贝和赋值
+    HistoryCollector(const HistoryCollector&) = delete;
+    HistoryCollector& operator=(const HistoryCollector&) = delete;
+
+    /**
+     * @brief 应用一条余额历史消息
+     *
+     * 支持 BALANCE_HISTORY_SEGMENT（增量分段）和旧格式 BALANCE_HISTORY（整段固定结构，
+     * 解码时压缩为变化点）。
+     * 拷贝负载之前先校验魔数和 s_payload_len
+     *
+     * @param from 发送方进程ID
+     * @param msg 历史消息
+     * @return 消息格式非法、分段不连续、账户ID越界或账户不由发送方托管时返回false
+     */
+    bool apply(local_id from, const Message& msg);
+
+    /**
+     * @brief 并行应用一批消息中的余额历史消息
+     *
+     * 非历史消息被忽略；同一账户的消息保持原有顺序。
+     * 返回时整批已应用完毕
+     *
+     * @param senders 每条消息的发送方ID
+     * @param msgs 消息数组
+     * @param count 消息数量
+     * @return 被拒绝（格式非法）的历史消息数量
+     */
+    size_t apply_batch(const local_id* senders, const Message* msgs, size_t count);
+
+    /**
+     * @brief 是否为余额历史消息
+     */
+    static bool is_history_message(const Message& msg);
+
+    /**
+     * @brief 账户是否已收到最后一段
+     */
+    bool complete(account_id_t account) const;
+
+    /**
+     * @brief 是否所有账户都已收到最后一段
+     */
+    bool all_complete() const {
+        return complete_count_.load(std::memory_order_acquire) ==
+               static_cast<int>(histories_.size());
+    }
+
+    /**
+     * @brief 账户数量
+     */
+    account_id_t accounts() const { return static_cast<account_id_t>(histories_.size()); }
+
+    /**
+     * @brief 获取账户的余额历史
+     */
+    const ScalableBalanceHistory& history(account_id_t account) const {
+        return histories_[account - 1];
+    }
+
+    /**
+     * @brief 导出 print_history 使用的 AllHistory 兼容视图
+     *
+     * AllHistory 最多容纳 MAX_PROCESS_ID + 1 个账户，多出的账户不导出
+     *
+     * @param out 调用方分配的 AllHistory
+     */
+    void to_all_history(AllHistory* out) const;
+
+private:
+    AccountDirectory directory_;                     ///< 账户目录（账户ID → 发送方进程）
+    std::vector<ScalableBalanceHistory> histories_;  ///< 按账户ID-1索引的历史
+    std::vector<char> complete_;                     ///< 是否已收到最后一段（按账户独立写入，不用vector<bool>）
+    std::atomic<int> complete_count_;                ///< 已完成的账户数
+
+    // 解码线程池
+    std::vector<std::thread> workers_;               ///< 解码线程
+    std::mutex pool_mutex_;                          ///< 保护批次代数和停止标志
+    std::condition_variable pool_cv_;                ///< 新批次通知
+    uint64_t generation_;                            ///< 批次代数（每个新批次加1）
+    bool pool_stop_;                                 ///< 停止标志
+    PendingCounter batch_pending_;                   ///< 当前批次尚未完成的线程数
+    std::vector<std::vector<const Message*>> groups_; ///< 当前批次按发送方分组的消息
+    std::atomic<size_t> rejected_;                   ///< 当前批次被拒绝的消息数
+
+    /**
+     * @brief 解码线程主循环：处理发送方ID ≡ worker (mod 线程数) 的分组
+     */
+    void decode_worker(size_t worker);
+
+    /**
+     * @brief 按顺序应用一个发送方在当前批次中的消息
+     */
+    void decode_group(size_t sender);
+
+    /**
+     * @brief 标记账户已收到最后一段
+     */
+    void mark_complete(size_t index);
+};
+
+#endif // BANKING_SYSTEM_HISTORY_HISTORY_COLLECTOR_H
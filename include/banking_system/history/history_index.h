@@ -0,0 +1,73 @@
+#ifndef BANKING_SYSTEM_HISTORY_HISTORY_INDEX_H
+#define BANKING_SYSTEM_HISTORY_HISTORY_INDEX_H
+
+#include "banking_system/history/balance_history.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ==================== 余额历史时间点查询索引 ====================
+
+/**
+ * @brief 余额历史时间点查询索引
+ *
+ * 回答“账户X在逻辑时刻T的余额是多少”以及“时刻T所有账户的总余额是多少”：
+ * - 单账户查询直接在该账户按时间排序的变化点上二分查找，O(log n)
+ * - 跨账户查询使用构造时建立的前缀和索引：各账户的变化点本身按时间有序，
+ *   用k路归并（小顶堆，O(n log k)）换算成余额增量并做前缀和，
+ *   同一时刻的增量合并为一项；查询时二分查找，O(log n)
+ *
+ * 索引在构造时一次建立，之后只读，可被多个线程同时查询。
+ * 调用方保证历史在索引存活期间不再变化（例如阶段4收齐之后）
+ */
+class HistoryIndex {
+public:
+    /**
+     * @brief 构造函数 - 建立前缀和索引
+     * @param histories 各账户的余额历史（生命周期由调用方保证）
+     */
+    explicit HistoryIndex(const std::vector<const ScalableBalanceHistory*>& histories);
+
+    /**
+     * @brief 查询账户在 time 时刻的状态
+     * @param account 账户ID
+     * @param time 逻辑时间
+     * @return 账户不存在或 time 早于其第一个变化点时返回全零状态
+     */
+    WideBalanceState state_at(account_id_t account, lamport_time_t time) const;
+
+    /**
+     * @brief 查询账户在 time 时刻的余额
+     */
+    balance_t balance_at(account_id_t account, lamport_time_t time) const {
+        return state_at(account, time).s_balance;
+    }
+
+    /**
+     * @brief 查询 time 时刻所有账户的总余额
+     */
+    int64_t total_at(lamport_time_t time) const;
+
+    /**
+     * @brief 查询 time 时刻所有账户的总在途金额
+     */
+    int64_t pending_in_at(lamport_time_t time) const;
+
+    /**
+     * @brief 前缀和索引的项数（所有账户变化点的不同时刻数）
+     */
+    size_t size() const { return times_.size(); }
+
+private:
+    std::vector<const ScalableBalanceHistory*> by_id_; ///< 按账户ID索引的历史（不存在为nullptr）
+    std::vector<lamport_time_t> times_;   ///< 合并后的变化时刻（严格递增）
+    std::vector<int64_t> total_balance_;  ///< 每个变化时刻起的总余额（前缀和）
+    std::vector<int64_t> total_pending_;  ///< 每个变化时刻起的总在途金额（前缀和）
+
+    /**
+     * @brief 最后一个不晚于 time 的索引项下标加1（0表示早于所有变化）
+     */
+    size_t upper_bound(lamport_time_t time) const;
+};
+
+#endif // BANKING_SYSTEM_HISTORY_HISTORY_INDEX_H
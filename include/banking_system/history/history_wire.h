@@ -0,0 +1,142 @@
+#ifndef BANKING_SYSTEM_HISTORY_HISTORY_WIRE_H
+#define BANKING_SYSTEM_HISTORY_HISTORY_WIRE_H
+
+#include "banking_system/history/balance_history.h"
+#include "banking_system/transfer/transfer_batch.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ==================== 余额历史分段消息 ====================
+
+/**
+ * @brief 余额历史消息类型（接在 ExtendedMessageType 之后）
+ */
+enum HistoryMessageType : int16_t {
+    BALANCE_HISTORY_SEGMENT = TRANSFER_BATCH + 1  ///< 消息携带 HistorySegmentHeader + WideBalanceState数组
+};
+
+/**
+ * @brief 分段标志位（HistorySegmentHeader::s_flags）
+ */
+enum HistorySegmentFlag : uint8_t {
+    HISTORY_SEGMENT_LAST    = 1 << 0,   ///< 最后一段（最终水位线）
+    HISTORY_SEGMENT_REWRITE = 1 << 1    ///< 从 s_first_index 起覆盖接收方已有的变化点
+};
+
+/**
+ * @brief 余额历史分段负载头部
+ *
+ * 一个账户的历史按顺序拆成若干段发送（运行期间增量发送已封存的变化点，
+ * 结束时发送剩余部分），每段只携带变化点（不展开为逐时刻状态）：
+ * HistorySegmentHeader 后紧跟 s_count 个 WideBalanceState。
+ * s_first_index 用于校验分段连续；迟到的入账回溯修改了已发送的变化点时，
+ * 发送方从第一个被修改的下标重发，并带 HISTORY_SEGMENT_REWRITE 标志
+ */
+typedef struct {
+    account_id_t s_id;              ///< 账户ID（32位，多账户进程中不等于发送方进程ID）
+    uint8_t  s_flags;               ///< HistorySegmentFlag 的组合
+    uint16_t s_count;               ///< 本段变化点数
+    uint64_t s_first_index;         ///< 本段第一个变化点在整个历史中的下标
+    int64_t  s_end_time;            ///< 历史覆盖的最后时刻
+} __attribute__((packed)) HistorySegmentHeader;
+
+/**
+ * @brief 单条消息最多容纳的变化点数
+ */
+constexpr size_t MAX_SEGMENT_STATES =
+    (MAX_PAYLOAD_LEN - sizeof(HistorySegmentHeader)) / sizeof(WideBalanceState);
+
+/**
+ * @brief 把历史中 [first_index, end_index) 的变化点填入一条分段消息
+ *
+ * 一条消息放不下时只填入前 MAX_SEGMENT_STATES 个，调用方按返回值继续发送
+ *
+ * @param msg 调用方分配的消息
+ * @param time 时间戳
+ * @param history 余额历史
+ * @param first_index 本段第一个变化点的下标
+ * @param end_index 待发送范围的结束下标
+ * @param final 待发送范围是否为历史的最后部分（最后一条消息带 HISTORY_SEGMENT_LAST 标志）
+ * @param rewrite 是否覆盖接收方从 first_index 起已有的变化点
+ * @return 本段写入的变化点数
+ */
+inline size_t fill_history_segment(Message* msg, timestamp_t time,
+                                   const ScalableBalanceHistory& history,
+                                   size_t first_index, size_t end_index, bool final,
+                                   bool rewrite = false) {
+    size_t remaining = end_index > first_index ? end_index - first_index : 0;
+    size_t count = remaining < MAX_SEGMENT_STATES ? remaining : MAX_SEGMENT_STATES;
+    uint8_t flags = 0;
+    if (final && first_index + count == end_index) {
+        flags |= HISTORY_SEGMENT_LAST;
+    }
+    if (rewrite) {
+        flags |= HISTORY_SEGMENT_REWRITE;
+    }
+    HistorySegmentHeader header = {
+        history.id(),
+        flags,
+        static_cast<uint16_t>(count),
+        first_index,
+        history.end_time()
+    };
+    fill_message(msg, static_cast<MessageType>(BALANCE_HISTORY_SEGMENT), time, nullptr, 0);
+    std::memcpy(msg->s_payload, &header, sizeof(header));
+    char* states = msg->s_payload + sizeof(header);
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(states + i * sizeof(WideBalanceState), &history[first_index + i],
+                    sizeof(WideBalanceState));
+    }
+    msg->s_header.s_payload_len =
+        static_cast<uint16_t>(sizeof(header) + count * sizeof(WideBalanceState));
+    return count;
+}
+
+/**
+ * @brief 把一条分段消息追加到历史末尾
+ *
+ * 历史为空时第一段（s_first_index为0）会先清空历史并设置账户ID；
+ * 带 HISTORY_SEGMENT_REWRITE 标志时先丢弃 s_first_index 及之后已收到的变化点
+ * （从0开始重写时同样清空）。已有变化点时不带该标志的0号段是乱序或重复的段，
+ * 按不连续拒绝，不会清掉已收到的历史
+ *
+ * @param msg BALANCE_HISTORY_SEGMENT消息
+ * @param history 接收方的余额历史
+ * @param last 输出：是否为最后一段
+ * @return 负载格式非法或分段不连续时返回false
+ */
+inline bool read_history_segment(const Message* msg, ScalableBalanceHistory* history, bool* last) {
+    if (msg->s_header.s_magic != MESSAGE_MAGIC ||
+        msg->s_header.s_payload_len < sizeof(HistorySegmentHeader) ||
+        msg->s_header.s_payload_len > MAX_PAYLOAD_LEN) {
+        return false;
+    }
+    HistorySegmentHeader header;
+    std::memcpy(&header, msg->s_payload, sizeof(header));
+    if (sizeof(header) + header.s_count * sizeof(WideBalanceState) > msg->s_header.s_payload_len) {
+        return false;
+    }
+    bool rewrite = (header.s_flags & HISTORY_SEGMENT_REWRITE) != 0;
+    if (header.s_first_index == 0 && (history->empty() || rewrite)) {
+        history->clear(header.s_id);
+    } else if (rewrite &&
+               header.s_first_index < history->size() &&
+               !history->truncate(header.s_first_index)) {
+        return false;
+    }
+    if (header.s_first_index != history->size() || header.s_id != history->id()) {
+        return false;
+    }
+    const char* states = msg->s_payload + sizeof(header);
+    for (size_t i = 0; i < header.s_count; ++i) {
+        WideBalanceState state;
+        std::memcpy(&state, states + i * sizeof(WideBalanceState), sizeof(state));
+        history->push_back(state);
+    }
+    history->set_end_time(header.s_end_time);
+    *last = (header.s_flags & HISTORY_SEGMENT_LAST) != 0;
+    return true;
+}
+
+#endif // BANKING_SYSTEM_HISTORY_HISTORY_WIRE_H
@@ -0,0 +1,55 @@
+#ifndef BANKING_SYSTEM_IPC_FUTEX_H
+#define BANKING_SYSTEM_IPC_FUTEX_H
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// ==================== 共享段等待原语（IPC模块内部使用） ====================
+
+/**
+ * @brief 自旋等待阶段的最大轮数，超过后转入futex睡眠
+ */
+constexpr int kSpinIterations = 256;
+
+/**
+ * @brief 自旋等待中的CPU让步提示（x86上为PAUSE，其他平台为空操作）
+ */
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * @brief 在 *addr 仍等于 expected 时睡眠，直到被唤醒或超时
+ *
+ * 共享段跨进程使用，因此不能使用 FUTEX_PRIVATE_FLAG
+ *
+ * @param addr futex字
+ * @param expected 调用方最后看到的值
+ * @param timeout 相对超时（nullptr表示不超时）
+ * @return 系统调用返回值
+ */
+inline int futex_wait(std::atomic<uint32_t>* addr, uint32_t expected,
+                      const struct timespec* timeout = nullptr) {
+    return static_cast<int>(syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr),
+                                    FUTEX_WAIT, expected, timeout, nullptr, 0));
+}
+
+/**
+ * @brief 唤醒在 addr 上等待的所有进程
+ *
+ * @param addr futex字
+ * @return 被唤醒的等待者数
+ */
+inline int futex_wake(std::atomic<uint32_t>* addr) {
+    return static_cast<int>(syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr),
+                                    FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0));
+}
+
+#endif // BANKING_SYSTEM_IPC_FUTEX_H
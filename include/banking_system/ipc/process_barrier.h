@@ -0,0 +1,128 @@
+#ifndef BANKING_SYSTEM_IPC_PROCESS_BARRIER_H
+#define BANKING_SYSTEM_IPC_PROCESS_BARRIER_H
+
+#include "banking_system/common/types.h"
+#include "labs_headers/message.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// ==================== 进程屏障 ====================
+
+/**
+ * @brief 屏障算法
+ */
+enum class BarrierAlgorithm {
+    ALL_TO_ALL,       ///< 子进程广播、互相等待：O(n²) 条消息（原 STARTED 交换）
+    DISSEMINATION,    ///< 传播屏障：ceil(log2 n) 轮，每轮每个节点收发各一条，O(n log n) 条消息
+    TREE,             ///< 以父进程为根的二叉树：先向上汇合再向下释放，2(n-1) 条消息
+    SHARED_MEMORY     ///< 共享内存中的感应反转屏障：不发消息，在futex上等待
+};
+
+/**
+ * @brief 所有进程（父进程和全部子进程）参与的屏障
+ *
+ * 替代“每个子进程广播 STARTED、再从每个对等进程接收”的全互连握手。
+ * 基于消息的算法沿用调用方给出的消息类型（例如 STARTED）和负载，
+ * 每条消息都推进Lamport时钟；同一对进程之间的通道保持FIFO，
+ * 因此屏障之后才发出的业务消息不会被屏障误收。
+ *
+ * 与传输层一样是进程级单例：启动方在fork之前选择算法，
+ * 使用 SHARED_MEMORY 时还需在fork之前调用 create_shared 创建共享段
+ */
+class ProcessBarrier {
+public:
+    /**
+     * @brief 获取单例实例
+     */
+    static ProcessBarrier& instance();
+
+    /**
+     * @brief 选择屏障算法（fork之前调用，所有进程必须一致）
+     */
+    void set_algorithm(BarrierAlgorithm algorithm) { algorithm_ = algorithm; }
+
+    /**
+     * @brief 当前屏障算法
+     */
+    BarrierAlgorithm algorithm() const { return algorithm_; }
+
+    /**
+     * @brief 创建共享内存屏障（SHARED_MEMORY 算法，父进程在fork之前调用）
+     * @param count_nodes 参与进程数（包括父进程）
+     * @return 成功返回true
+     */
+    bool create_shared(int count_nodes);
+
+    /**
+     * @brief 解除映射共享内存屏障
+     */
+    void destroy();
+
+    /**
+     * @brief 到达屏障并等待所有进程到达
+     *
+     * SHARED_MEMORY 算法未创建共享段时退回 DISSEMINATION
+     *
+     * @param self 当前进程ID
+     * @param count_nodes 参与进程数（包括父进程）
+     * @param type 屏障消息的类型
+     * @param payload 屏障消息的负载（可为空，例如 STARTED 日志行）
+     * @param payload_len 负载长度
+     * @return 所有进程都已到达返回true，收发失败或收到非屏障消息返回false
+     */
+    bool wait(local_id self, int count_nodes, MessageType type,
+              const char* payload = nullptr, size_t payload_len = 0);
+
+    /**
+     * @brief 算法名称（用于日志和命令行）
+     */
+    static const char* name(BarrierAlgorithm algorithm);
+
+private:
+    ProcessBarrier() = default;
+    ~ProcessBarrier();
+
+    // 禁止拷贝和赋值
+    ProcessBarrier(const ProcessBarrier&) = delete;
+    ProcessBarrier& operator=(const ProcessBarrier&) = delete;
+
+    struct SharedState;
+
+    BarrierAlgorithm algorithm_ = BarrierAlgorithm::DISSEMINATION; ///< 屏障算法
+    SharedState* shared_ = nullptr;     ///< 共享内存屏障状态（未创建时为空）
+    uint32_t local_sense_ = 0;          ///< 本进程的感应位（fork后各自翻转）
+
+    /**
+     * @brief 全互连：子进程广播并接收所有对等进程，父进程接收所有子进程
+     */
+    bool wait_all_to_all(local_id self, int count_nodes, const Message& msg);
+
+    /**
+     * @brief 传播屏障：第k轮发给 self+2^k，接收 self-2^k
+     */
+    bool wait_dissemination(local_id self, int count_nodes, const Message& msg);
+
+    /**
+     * @brief 二叉树屏障：沿 SpanningTree 先汇合再释放
+     */
+    bool wait_tree(local_id self, int count_nodes, const Message& msg);
+
+    /**
+     * @brief 共享内存感应反转屏障
+     */
+    bool wait_shared(int count_nodes);
+
+    /**
+     * @brief 以新的Lamport时间发送屏障消息
+     */
+    static bool send_stamped(local_id dst, Message msg);
+
+    /**
+     * @brief 从指定进程接收一条屏障消息并推进Lamport时钟
+     * @return 收到类型为 type 的消息返回true
+     */
+    static bool receive_expected(local_id from, MessageType type);
+};
+
+#endif // BANKING_SYSTEM_IPC_PROCESS_BARRIER_H
@@ -0,0 +1,178 @@
+#ifndef BANKING_SYSTEM_IPC_SHARED_LEDGER_H
+#define BANKING_SYSTEM_IPC_SHARED_LEDGER_H
+
+#include "banking_system/common/types.h"
+#include "banking_system/history/balance_history.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// ==================== 共享内存账本 ====================
+
+/**
+ * @brief 同一主机上的共享内存账本（可选的转账快速路径）
+ *
+ * 启用后账户余额不再只保存在各自的账户进程中，而是放在父进程fork之前
+ * 创建的共享mmap段里，所有进程继承同一映射：
+ * - 每个账户一个按缓存行对齐的槽位（写锁 + 已发布的日志长度），
+ *   不同账户的写入不会互相伪共享
+ * - 每个账户一段只追加的变化点日志（WideBalanceState），当前余额和在途金额
+ *   就是日志的最后一项；写入方先写日志项，再以release发布长度，
+ *   读取方以acquire读取长度后无锁读取已发布的日志项（已发布的项不再修改）
+ * - 一笔转账按账户ID顺序锁住两个槽位，两端日志各追加一项，
+ *   使用同一个Lamport时间戳（不早于调用方时钟，且晚于两端最后一项），
+ *   因此任何时刻总余额都守恒，不存在在途区间
+ *
+ * 两端账户都在账本中的转账由父进程的分片线程直接结算，
+ * 不再经过 父进程→源账户→目标账户→父进程 三跳消息；
+ * 消息只用于控制流程（STARTED/STOP/DONE）和余额历史。
+ * 账户进程在启动时写入初始余额，结束时从账本导出历史发送给父进程
+ */
+class SharedLedger {
+public:
+    /**
+     * @brief 每个账户日志的默认容量（变化点数）
+     */
+    static constexpr size_t kDefaultLogCapacity = 1 << 14;
+
+    /**
+     * @brief prefault 默认为每个账户预热的变化点数
+     */
+    static constexpr size_t kPrefaultStates = 64;
+
+    /**
+     * @brief 获取单例实例
+     */
+    static SharedLedger& instance();
+
+    /**
+     * @brief 创建共享账本（父进程在fork之前调用）
+     *
+     * 日志区按需分配物理页（MAP_NORESERVE），容量只占虚拟地址空间。
+     * 账本必须覆盖全部账户才会启用（见 covers）
+     *
+     * @param accounts 账户总数（账户ID为 1..accounts）
+     * @param log_capacity 每个账户日志的容量
+     * @return 成功返回true
+     */
+    bool create(account_id_t accounts, size_t log_capacity = kDefaultLogCapacity);
+
+    /**
+     * @brief 并行预缺页槽位数组和每个账户日志的开头（create 之后、fork 之前调用）
+     *
+     * 日志区只占虚拟地址空间，这里不会整段写入：每个账户只预热
+     * 前 states 个变化点所在的页，其余部分仍按需分配
+     *
+     * @param states 每个账户预热的变化点数
+     * @param threads 线程数（<=0 时使用硬件并发数）
+     */
+    void prefault(size_t states = kPrefaultStates, int threads = 0);
+
+    /**
+     * @brief 解除映射共享账本
+     */
+    void destroy();
+
+    /**
+     * @brief 账本是否已创建
+     */
+    bool active() const { return segment_ != nullptr; }
+
+    /**
+     * @brief 账户总数
+     */
+    account_id_t accounts() const { return accounts_; }
+
+    /**
+     * @brief 账本是否覆盖账户 1..accounts
+     *
+     * 父进程和账户进程都以此决定是否启用账本，保证双方选择一致
+     */
+    bool covers(account_id_t accounts) const {
+        return segment_ != nullptr && accounts <= accounts_;
+    }
+
+    /**
+     * @brief 账户是否在账本中
+     */
+    bool contains(account_id_t account) const {
+        return segment_ != nullptr && account >= 1 && account <= accounts_;
+    }
+
+    /**
+     * @brief 写入账户在时间0的初始余额（账户进程启动时调用，清空原有日志）
+     * @param account 账户ID
+     * @param initial_balance 初始余额
+     * @return 账户不在账本中返回false
+     */
+    bool open_account(account_id_t account, balance_t initial_balance);
+
+    /**
+     * @brief 原子地完成一笔转账
+     *
+     * @param src 源账户ID
+     * @param dst 目标账户ID
+     * @param amount 转账金额
+     * @param time 调用方的Lamport时间
+     * @param commit_time 输出：实际使用的时间戳（调用方应把时钟推进到该时间）
+     * @return 账户不在账本中、未初始化或日志已满时返回false（余额不变）
+     */
+    bool transfer(account_id_t src, account_id_t dst, balance_t amount,
+                  lamport_time_t time, lamport_time_t* commit_time);
+
+    /**
+     * @brief 账户的当前状态（日志最后一项，无锁）
+     * @return 账户不在账本中或未初始化时返回全零状态
+     */
+    WideBalanceState state(account_id_t account) const;
+
+    /**
+     * @brief 账户日志中已发布的变化点数
+     */
+    size_t log_size(account_id_t account) const;
+
+    /**
+     * @brief 把账户日志导出为余额历史（覆盖 history 原有内容）
+     * @param account 账户ID
+     * @param history 输出历史
+     * @return 账户不在账本中或未初始化时返回false
+     */
+    bool export_history(account_id_t account, ScalableBalanceHistory* history) const;
+
+private:
+    SharedLedger() = default;
+    ~SharedLedger();
+
+    // 禁止拷贝和赋值
+    SharedLedger(const SharedLedger&) = delete;
+    SharedLedger& operator=(const SharedLedger&) = delete;
+
+    struct SegmentHeader;
+    struct Slot;
+
+    void* segment_ = nullptr;               ///< 共享段基址
+    size_t segment_size_ = 0;               ///< 共享段大小
+    account_id_t accounts_ = 0;             ///< 账户总数
+    size_t log_capacity_ = 0;               ///< 每个账户日志的容量
+    Slot* slots_ = nullptr;                 ///< 槽位数组（下标即账户ID，0号不用）
+    WideBalanceState* logs_ = nullptr;      ///< 日志区起始地址
+
+    /**
+     * @brief 账户日志的起始地址
+     */
+    WideBalanceState* log_of(account_id_t account) const {
+        return logs_ + static_cast<size_t>(account) * log_capacity_;
+    }
+
+    /**
+     * @brief 获取槽位写锁（自旋，持有时间只有几次内存写入）
+     */
+    static void lock(Slot* slot);
+
+    /**
+     * @brief 释放槽位写锁
+     */
+    static void unlock(Slot* slot);
+};
+
+#endif // BANKING_SYSTEM_IPC_SHARED_LEDGER_H
@@ -0,0 +1,252 @@
+#ifndef BANKING_SYSTEM_IPC_SHM_TRANSPORT_H
+#define BANKING_SYSTEM_IPC_SHM_TRANSPORT_H
+
+#include "labs_headers/message.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// ==================== 共享内存传输层 ====================
+
+/**
+ * @brief 基于共享内存的进程间消息传输
+ *
+ * 实现 message.h 中声明的 send / send_multicast / receive / receive_any。
+ *
+ * 设计要点：
+ * - 父进程在fork之前创建一个mmap共享段，所有子进程继承
+ * - 每个有序进程对 (sender, receiver) 拥有一个无锁SPSC环形缓冲区
+ * - 帧只携带 MessageHeader + s_payload_len 字节，不拷贝整个4KB缓冲区
+ * - 每个进程有一个futex门铃，空闲的读者睡眠而不是自旋
+ * - 门铃附带“就绪位图”，receive_any 只检查有数据的通道并轮询服务
+ *
+ * 进程内多个线程（例如父进程的分片线程）共享同一通道时，
+ * 由进程内的每通道互斥锁保证单生产者/单消费者语义。
+ */
+class ShmTransport {
+public:
+    /**
+     * @brief 每个环形缓冲区的默认容量（字节，必须为2的幂）
+     */
+    static constexpr size_t kDefaultRingCapacity = 64 * 1024;
+
+    /**
+     * @brief 获取单例实例
+     */
+    static ShmTransport& instance();
+
+    /**
+     * @brief 创建共享内存段（父进程在fork之前调用）
+     * @param count_nodes 节点总数（包括父进程）
+     * @param ring_capacity 每个通道的环形缓冲区容量
+     * @return 成功返回true
+     */
+    bool create(int count_nodes, size_t ring_capacity = kDefaultRingCapacity);
+
+    /**
+     * @brief 绑定当前进程的ID（每个进程fork之后调用）
+     * @param self_id 当前进程ID
+     */
+    void attach(local_id self_id);
+
+    /**
+     * @brief 并行预缺页整个共享段（create 之后、fork 之前调用）
+     *
+     * n² 个通道的环形缓冲区由多个线程同时写入一遍，
+     * 各进程第一次向某个通道写消息时不再触发分配物理页的缺页
+     *
+     * @param threads 线程数（<=0 时使用硬件并发数）
+     */
+    void prefault(int threads = 0);
+
+    /**
+     * @brief 解除映射共享内存段
+     */
+    void destroy();
+
+    /**
+     * @brief 发送消息给指定进程（环满时阻塞）
+     * @return 成功返回0，失败返回-1
+     */
+    int send(local_id dst, const Message* msg);
+
+    /**
+     * @brief 发送消息给除自身外的所有进程（包括父进程）
+     * @return 成功返回0，失败返回-1
+     */
+    int send_multicast(const Message* msg);
+
+    /**
+     * @brief 从指定进程接收一条消息（无消息时阻塞）
+     * @return 成功返回0，失败返回-1
+     */
+    int receive(local_id from, Message* msg);
+
+    /**
+     * @brief 从指定进程接收一条消息（不阻塞）
+     * @return 收到返回0，通道为空返回1，失败返回-1
+     */
+    int try_receive(local_id from, Message* msg);
+
+    /**
+     * @brief 从任意进程接收一条消息（无消息时阻塞）
+     * @return 发送方进程ID，失败返回-1
+     */
+    int receive_any(Message* msg);
+
+    /**
+     * @brief 批量接收：阻塞直到至少有一条消息，然后不阻塞地取尽可用消息
+     *
+     * 按发送者轮询，每轮每个通道最多取一帧，保证公平。
+     *
+     * @param msgs 调用方分配的消息数组
+     * @param max_count 数组容量
+     * @param senders 可选，输出每条消息的发送方ID
+     * @return 接收到的消息数量，失败返回-1
+     */
+    int receive_many(Message* msgs, int max_count, local_id* senders = nullptr);
+
+    /**
+     * @brief 带超时的批量接收
+     *
+     * 超时或被 interrupt() 唤醒时返回0
+     *
+     * @param timeout_ms 超时时间（毫秒）
+     * @return 接收到的消息数量，超时返回0，失败返回-1
+     */
+    int receive_many_for(Message* msgs, int max_count, local_id* senders, int timeout_ms);
+
+    /**
+     * @brief 唤醒本进程中阻塞在 receive_many_for 上的线程
+     *
+     * 用于让接收线程（例如ACK分发线程）及时退出
+     */
+    void interrupt();
+
+    /**
+     * @brief 获取当前进程ID
+     */
+    local_id self_id() const { return self_id_; }
+
+    /**
+     * @brief 获取节点总数
+     */
+    int count_nodes() const { return count_nodes_; }
+
+private:
+    ShmTransport() = default;
+    ~ShmTransport();
+
+    // 禁止拷贝和赋值
+    ShmTransport(const ShmTransport&) = delete;
+    ShmTransport& operator=(const ShmTransport&) = delete;
+
+    struct SegmentHeader;
+    struct Doorbell;
+    struct RingControl;
+
+    void* segment_ = nullptr;                       ///< 共享段基址
+    size_t segment_size_ = 0;                       ///< 共享段大小
+    int count_nodes_ = 0;                           ///< 节点总数
+    size_t ring_capacity_ = 0;                      ///< 每个环的容量
+    local_id self_id_ = PARENT_ID;                  ///< 当前进程ID
+    std::atomic<int> rr_cursor_{0};                 ///< 轮询起点（上次服务通道的下一个）
+    std::atomic<bool> interrupted_{false};          ///< interrupt() 请求标志
+    std::atomic<int> recv_contenders_{0};           ///< 因通道被本进程其他线程占用而等待的接收者
+
+    Doorbell* data_bells_ = nullptr;                ///< 每个接收者的“有数据”门铃
+    Doorbell* space_bells_ = nullptr;               ///< 每个发送者的“有空间”门铃
+    RingControl* rings_ = nullptr;                  ///< 环控制块数组（count_nodes^2）
+    char* ring_data_ = nullptr;                     ///< 环数据区起始地址
+
+    std::unique_ptr<std::mutex[]> send_mutexes_;    ///< 进程内发送锁（每目标一个）
+    std::unique_ptr<std::mutex[]> recv_mutexes_;    ///< 进程内接收锁（每来源一个）
+
+    /**
+     * @brief 计算通道编号
+     */
+    size_t ring_index(int from, int to) const {
+        return static_cast<size_t>(from) * count_nodes_ + to;
+    }
+
+    /**
+     * @brief 尝试写入一帧（不阻塞）
+     * @return 空间足够并写入成功返回true
+     */
+    bool try_push(int from, int to, const Message* msg, size_t frame_len);
+
+    /**
+     * @brief 尝试读出一帧（不阻塞）
+     * @return 有数据并读取成功返回true
+     */
+    bool try_pop(int from, int to, Message* msg);
+
+    /**
+     * @brief 按就绪位图轮询取出可用消息（不阻塞）
+     * @param contended 输出：是否有通道被本进程其他线程占用
+     * @return 取出的消息数量
+     */
+    int drain_ready(Message* msgs, int max_count, local_id* senders, bool* contended);
+
+    /**
+     * @brief 批量接收的公共实现
+     * @param deadline 截止时间，nullptr表示无限等待
+     */
+    int receive_many_until(Message* msgs, int max_count, local_id* senders,
+                           const std::chrono::steady_clock::time_point* deadline);
+
+    /**
+     * @brief 释放接收通道的进程内锁
+     *
+     * 有接收者因该通道被占用而登记等待时敲响本进程的数据门铃，
+     * 让它们重新轮询，而不是忙等锁被释放
+     */
+    void release_channel(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * @brief 在门铃上等待，直到序号离开 seen
+     * @param deadline 截止时间，nullptr表示无限等待
+     * @return 门铃被敲响返回true，超时返回false
+     */
+    bool wait_bell(Doorbell* bell, uint32_t seen,
+                   const std::chrono::steady_clock::time_point* deadline = nullptr);
+
+    /**
+     * @brief 敲响门铃并唤醒等待者
+     */
+    void ring_bell(Doorbell* bell);
+};
+
+// ==================== message.h 扩展接口 ====================
+
+/**
+ * @brief 非阻塞接收（receive 的非阻塞版本）
+ * @param from 发送方进程ID
+ * @param msg 调用方分配的消息
+ * @return 收到返回0，通道为空返回1，失败返回-1
+ */
+int try_receive(local_id from, Message* msg);
+
+/**
+ * @brief 批量接收消息（receive_any 的批量版本）
+ *
+ * 一次唤醒取尽一批 TRANSFER/ACK/DONE 帧
+ *
+ * @param msgs 调用方分配的消息数组
+ * @param max_count 数组容量
+ * @param senders 可选，输出每条消息的发送方ID
+ * @return 接收到的消息数量，失败返回-1
+ */
+int receive_many(Message* msgs, int max_count, local_id* senders = nullptr);
+
+/**
+ * @brief 带超时的批量接收
+ * @param timeout_ms 超时时间（毫秒）
+ * @return 接收到的消息数量，超时或被中断返回0，失败返回-1
+ */
+int receive_many_for(Message* msgs, int max_count, local_id* senders, int timeout_ms);
+
+#endif // BANKING_SYSTEM_IPC_SHM_TRANSPORT_H
@@ -0,0 +1,70 @@
+#ifndef BANKING_SYSTEM_IPC_SPANNING_TREE_H
+#define BANKING_SYSTEM_IPC_SPANNING_TREE_H
+
+#include "banking_system/common/types.h"
+#include "labs_headers/message.h"
+
+// ==================== 进程生成树 ====================
+
+/**
+ * @brief 以父进程为根、覆盖全部进程的二叉生成树
+ *
+ * 节点i的子节点为 2i+1 和 2i+2，父节点为 (i-1)/2，根为 PARENT_ID。
+ * 树只由进程ID和进程数决定，各进程独立构造即可得到相同的拓扑；
+ * 沿树广播或汇合共 n-1 条消息，深度 floor(log2 n)。
+ * 启动屏障（TREE 算法）和停止时的终止检测使用同一棵树
+ */
+class SpanningTree {
+public:
+    /**
+     * @brief 每个节点最多的子节点数
+     */
+    static constexpr int kFanOut = 2;
+
+    /**
+     * @brief 构造函数
+     * @param self 当前进程ID
+     * @param count_nodes 进程总数（包括父进程）
+     */
+    SpanningTree(local_id self, int count_nodes)
+        : self_(self)
+        , count_nodes_(count_nodes)
+    {
+    }
+
+    /**
+     * @brief 当前进程是否为根（父进程）
+     */
+    bool is_root() const { return self_ == PARENT_ID; }
+
+    /**
+     * @brief 树上的父节点（根没有父节点，返回自身）
+     */
+    local_id parent() const {
+        return is_root() ? self_ : static_cast<local_id>((self_ - 1) / kFanOut);
+    }
+
+    /**
+     * @brief 子节点数（0..kFanOut）
+     */
+    int child_count() const {
+        int first = kFanOut * self_ + 1;
+        if (first >= count_nodes_) {
+            return 0;
+        }
+        return count_nodes_ - first < kFanOut ? count_nodes_ - first : kFanOut;
+    }
+
+    /**
+     * @brief 第k个子节点（0 <= k < child_count()）
+     */
+    local_id child(int k) const {
+        return static_cast<local_id>(kFanOut * self_ + 1 + k);
+    }
+
+private:
+    local_id self_;         ///< 当前进程ID
+    int count_nodes_;       ///< 进程总数
+};
+
+#endif // BANKING_SYSTEM_IPC_SPANNING_TREE_H
@@ -2,15 +2,21 @@
 #define BANKING_SYSTEM_PROCESS_CHILD_WORKER_H
 
 #include "banking_system/common/types.h"
+#include "banking_system/history/balance_history.h"
 #include "labs_headers/banking.h"
 #include "labs_headers/process.h"
+#include "banking_system/transfer/transfer_batch.h"
+#include <chrono>
+#include <string>
+#include <vector>
 
 // ==================== 子进程参数结构体 ====================
 
 /**
  * @brief 子进程参数结构体
  * 
- * 用于传递子进程初始化所需的参数
+ * 用于传递子进程初始化所需的参数（process.h 中的 child_arguments
+ * 由 child_work 转换为本结构体）
  */
 struct ChildArguments {
     local_id self_id;      ///< 自身进程ID
@@ -18,19 +24,19 @@ struct ChildArguments {
     uint8_t balance;       ///< 初始余额
 };
 
-// 类型别名，保持与原代码兼容
-using child_arguments = ChildArguments;
-
 // ==================== 子进程工作器类 ====================
 
 /**
  * @brief 子进程工作器类
  * 
  * 代表分布式系统中的一个账户进程，负责：
- * 1. 维护本地余额历史
+ * 1. 维护本地余额历史，运行期间增量发送给父进程
  * 2. 处理转账请求（作为源账户或目标账户）
  * 3. 响应系统控制消息（STOP等）
  * 4. 与其他账户进程同步
+ *
+ * 启用共享账本（SharedLedger）时余额由父进程在账本中直接结算，
+ * 本进程只写入初始余额，结束时从账本导出余额历史
  */
 class ChildWorker {
 public:
@@ -50,53 +56,150 @@ public:
      * 4. 发送余额历史
      */
     void run();
+    
+    /**
+     * @brief 查询账户在逻辑时刻 time 的余额（O(log n)）
+     * 
+     * 子进程只持有本账户的历史，其他账户返回0
+     * 
+     * @param account 账户ID
+     * @param time 逻辑时间
+     */
+    balance_t balance_at(local_id account, lamport_time_t time) const {
+        return account == self_id_ ? history_.state_at(time).s_balance : 0;
+    }
+    
+    /**
+     * @brief 查询本账户在逻辑时刻 time 的余额（O(log n)）
+     * 
+     * 只覆盖本进程的一个账户，不是全局总额；
+     * 跨账户的总额由父进程收齐历史后通过 HistoryIndex::total_at 查询
+     * 
+     * @param time 逻辑时间
+     */
+    balance_t own_balance_at(lamport_time_t time) const {
+        return balance_at(self_id_, time);
+    }
 
 private:
     local_id self_id_;          ///< 自身进程ID
     int count_nodes_;           ///< 节点总数
     uint8_t initial_balance_;   ///< 初始余额
-    BalanceHistory history_;    ///< 余额历史记录
+    bool ledger_mode_;          ///< 余额是否由共享账本结算
+    ScalableBalanceHistory history_; ///< 余额历史记录（64位时间戳，分块增长）
+    int done_count_;            ///< 已收到的DONE消息数量
+    std::string done_line_;     ///< 完成日志，随DONE发给树上的父节点
+    std::vector<Message> inbox_; ///< 批量接收缓冲区
+    std::vector<TaggedTransferOrder> outbox_[MAX_PROCESS_ID + 1]; ///< 按目标账户分组的待转发订单
+    std::vector<uint64_t> ack_ids_; ///< 待回传的关联ID
+    std::vector<TaggedAccountTransfer> rejected_; ///< 待回传NACK的无效订单
+    size_t shipped_;            ///< 已发送给父进程的变化点数
+    bool rewrite_;              ///< 已发送的变化点被迟到的入账修改，下一段需覆盖父进程的副本
+    std::chrono::steady_clock::time_point last_ship_; ///< 上次增量发送历史的时间
     
     /**
-     * @brief 初始化余额历史
+     * @brief 每次唤醒最多批量处理的消息数
+     */
+    static constexpr int kInboxBatch = 16;
+    
+    /**
+     * @brief 未满一条消息的增量历史最多积压多久
+     */
+    static constexpr std::chrono::milliseconds kShipInterval{10};
+    
+    /**
+     * @brief 余额历史在内存中最多保留的块数，更旧的变化点转入段文件
+     */
+    static constexpr size_t kHotHistoryChunks = 16;
+    
+    /**
+     * @brief 初始化余额历史，并启用冷存储段文件 balance_history_<id>.seg；
+     *        启用共享账本时同时在账本中写入初始余额
      */
     void init_history();
     
     /**
-     * @brief 发送启动消息并等待其他进程就绪
+     * @brief 当前余额（启用共享账本时以账本为准）
+     */
+    balance_t current_balance() const;
+    
+    /**
+     * @brief 记录启动日志并在启动屏障（ProcessBarrier）上等待所有进程就绪
      */
     void send_started_and_wait();
     
     /**
      * @brief 主消息处理循环
      * 
-     * 处理TRANSFER和STOP消息
+     * 每次唤醒批量取出一组消息，处理TRANSFER和STOP消息
      */
     void message_loop();
     
     /**
-     * @brief 等待所有DONE消息
+     * @brief 处理STOP消息：记录完成日志，并沿生成树把STOP转发给子节点
+     * @param msg STOP消息
+     */
+    void handle_stop(const Message& msg);
+    
+    /**
+     * @brief 终止检测：沿生成树汇合DONE，再等待父节点回发的DONE
+     *
+     * 子树内全部完成后向树上的父节点发送DONE（携带本进程的完成日志）；
+     * 根收齐后沿树回发DONE，收到即表示所有进程都已完成。
+     * 共 3(n-1) 条消息，深度 O(log n)，不再需要每个进程接收 n-2 条DONE
      */
     void wait_all_done();
     
     /**
-     * @brief 发送余额历史给父进程
+     * @brief 接收消息直到累计收到 target 条DONE
+     */
+    void receive_done(int target);
+    
+    /**
+     * @brief 增量发送已封存的余额历史
+     * 
+     * 积压的变化点够一整条消息，或距上次发送超过 kShipInterval 时，
+     * 以BALANCE_HISTORY_SEGMENT消息发送给父进程
+     */
+    void ship_history_delta();
+    
+    /**
+     * @brief 发送余额历史的最后一段给父进程
+     * 
+     * 只包含增量发送之后剩余的变化点，带 HISTORY_SEGMENT_LAST 标志和最终结束时间；
+     * 启用共享账本时先从账本导出完整历史，再从头发送
      */
     void send_history();
     
     /**
-     * @brief 处理作为源账户的转账请求
-     * @param order 转账订单
+     * @brief 处理作为源账户的一批转账请求
+     * 
+     * 一次性扣除总额并只更新一次余额历史，
+     * 然后按目标账户分组，每个目标只转发一条消息
+     * 
+     * @param orders 转账订单数组
+     * @param count 订单数量
+     */
+    void handle_transfer_as_source(const TaggedTransferOrder* orders, size_t count);
+    
+    /**
+     * @brief 把 rejected_ 中的无效订单作为 TRANSFER_REJECT 回传父进程
+     * @param current 当前Lamport时间
      */
-    void handle_transfer_as_source(const TransferOrder* order);
+    void send_rejects(lamport_time_t current);
     
     /**
-     * @brief 处理作为目标账户的转账请求
-     * @param order 转账订单
-     * @param received_time 接收时间
+     * @brief 处理作为目标账户的一批转账请求
+     * 
+     * 一次性入账总额并只更新一次余额历史，向父进程回复一个累计ACK，
+     * ACK中携带每笔订单的关联ID
+     * 
+     * @param orders 转账订单数组
+     * @param count 订单数量
+     * @param received_time 源账户发出订单的时间（已还原为64位）
      */
-    void handle_transfer_as_destination(const TransferOrder* order, 
-                                       timestamp_t received_time);
+    void handle_transfer_as_destination(const TaggedTransferOrder* orders, size_t count,
+                                       lamport_time_t received_time);
 };
 
 // ==================== 兼容性函数 ====================
@@ -0,0 +1,226 @@
+#ifndef BANKING_SYSTEM_PROCESS_MULTI_ACCOUNT_WORKER_H
+#define BANKING_SYSTEM_PROCESS_MULTI_ACCOUNT_WORKER_H
+
+#include "banking_system/common/types.h"
+#include "banking_system/history/balance_history.h"
+#include "banking_system/transfer/account_directory.h"
+#include "banking_system/transfer/transfer_batch.h"
+#include "labs_headers/banking.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==================== 多账户工作进程参数结构体 ====================
+
+/**
+ * @brief 多账户工作进程参数结构体
+ */
+struct MultiAccountArguments {
+    local_id self_id;              ///< 自身进程ID
+    int count_nodes;               ///< 节点总数（工作进程数 + 父进程）
+    AccountDirectory directory;    ///< 账户目录（与父进程使用相同参数构造）
+    balance_t balance;             ///< 每个账户的初始余额
+};
+
+// ==================== 多账户工作进程类 ====================
+
+/**
+ * @brief 多账户工作进程
+ *
+ * 一个进程托管目录分配给它的一段连续账户（可达数千个），与 ChildWorker
+ * 的区别：
+ * 1. 账户按槽位稠密存放，每个账户一份 ScalableBalanceHistory；
+ *    首块从很小的容量开始增长，大量几乎不变的账户不会各占一整块
+ * 2. 订单使用32位账户ID（ACCOUNT_TRANSFER_BATCH），父进程的批次按源账户
+ *    所在进程发送，一条消息可涉及本进程的多个源账户
+ * 3. 两端都在本进程的转账直接在进程内结算并回复ACK，不经过IPC；
+ *    其余订单按目标进程分组，每个目标进程只转发一条消息
+ * 4. 只对本轮有变化的账户（脏账户列表）增量发送余额历史
+ *
+ * 账户历史不启用段文件冷存储：数千个账户各开一个映射文件代价过高。
+ * 启用共享账本（SharedLedger）时与 ChildWorker 相同：只写入初始余额，
+ * 结束时从账本导出每个账户的历史
+ */
+class MultiAccountWorker {
+public:
+    /**
+     * @brief 构造函数
+     * @param args 工作进程参数
+     */
+    explicit MultiAccountWorker(const MultiAccountArguments& args);
+
+    /**
+     * @brief 执行工作进程主循环
+     *
+     * 工作流程与 ChildWorker::run 相同：STARTED同步、处理转账直到STOP、
+     * DONE同步、发送每个托管账户的最后一段余额历史
+     */
+    void run();
+
+    /**
+     * @brief 查询托管账户在逻辑时刻 time 的余额（O(log n)）
+     *
+     * 不由本进程托管的账户返回0
+     *
+     * @param account 账户ID
+     * @param time 逻辑时间
+     */
+    balance_t balance_at(account_id_t account, lamport_time_t time) const {
+        return hosts(account) ? history_of(account).state_at(time).s_balance : 0;
+    }
+
+    /**
+     * @brief 查询逻辑时刻 time 本进程托管账户的总余额（O(账户数 · log n)）
+     * @param time 逻辑时间
+     */
+    int64_t total_at(lamport_time_t time) const;
+
+private:
+    local_id self_id_;              ///< 自身进程ID
+    int count_nodes_;               ///< 节点总数
+    AccountDirectory directory_;    ///< 账户目录
+    account_id_t first_account_;    ///< 托管的第一个账户ID
+    balance_t initial_balance_;     ///< 每个账户的初始余额
+    bool ledger_mode_;              ///< 余额是否由共享账本结算
+    std::vector<ScalableBalanceHistory> histories_; ///< 按槽位存放的账户余额历史
+    std::vector<size_t> shipped_;   ///< 每个账户已发送给父进程的变化点数
+    std::vector<char> rewrite_;     ///< 账户已发送的变化点是否被迟到的入账修改
+    std::vector<uint32_t> dirty_;   ///< 上次增量发送后有变化的槽位
+    std::vector<char> is_dirty_;    ///< 槽位是否已在脏列表中
+    std::vector<int32_t> credit_;   ///< 当前入账批次中每个槽位的入账合计
+    std::vector<uint32_t> credited_; ///< 当前入账批次中有入账的槽位
+    int done_count_;                ///< 已收到的DONE消息数量
+    std::string done_line_;         ///< 完成日志，随DONE发给树上的父节点
+    std::vector<Message> inbox_;    ///< 批量接收缓冲区
+    std::vector<local_id> senders_; ///< 每条消息的发送方ID
+    std::vector<TaggedAccountTransfer> outbox_[MAX_PROCESS_ID + 1]; ///< 按目标进程分组的待转发订单
+    std::vector<uint64_t> ack_ids_; ///< 待回传的关联ID
+    std::vector<TaggedAccountTransfer> rejected_; ///< 待回传NACK的无效订单
+    std::chrono::steady_clock::time_point last_ship_; ///< 上次增量发送历史的时间
+
+    /**
+     * @brief 每次唤醒最多批量处理的消息数
+     */
+    static constexpr int kInboxBatch = 16;
+
+    /**
+     * @brief 脏账户的增量历史最多积压多久
+     */
+    static constexpr std::chrono::milliseconds kShipInterval{10};
+
+    /**
+     * @brief 账户是否由本进程托管
+     */
+    bool hosts(account_id_t account) const {
+        return directory_.contains(account) && directory_.worker_of(account) == self_id_;
+    }
+
+    /**
+     * @brief 托管账户的余额历史
+     */
+    ScalableBalanceHistory& history_of(account_id_t account) {
+        return histories_[account - first_account_];
+    }
+
+    const ScalableBalanceHistory& history_of(account_id_t account) const {
+        return histories_[account - first_account_];
+    }
+
+    /**
+     * @brief 托管账户当前的总余额（启用共享账本时以账本为准）
+     */
+    int64_t hosted_balance() const;
+
+    /**
+     * @brief 把账户加入脏列表
+     */
+    void mark_dirty(account_id_t account);
+
+    /**
+     * @brief 记录启动日志并在启动屏障（ProcessBarrier）上等待所有进程就绪
+     */
+    void send_started_and_wait();
+
+    /**
+     * @brief 主消息处理循环
+     *
+     * 来自父进程的批次由本进程作为源账户处理，来自其他工作进程的批次
+     * 作为目标账户处理
+     */
+    void message_loop();
+
+    /**
+     * @brief 处理STOP消息：记录完成日志，并沿生成树把STOP转发给子节点
+     * @param msg STOP消息
+     */
+    void handle_stop(const Message& msg);
+
+    /**
+     * @brief 终止检测：与 ChildWorker::wait_all_done 相同的生成树汇合/释放协议
+     */
+    void wait_all_done();
+
+    /**
+     * @brief 接收消息直到累计收到 target 条DONE
+     */
+    void receive_done(int target);
+
+    /**
+     * @brief 增量发送脏账户已封存的余额历史
+     *
+     * 距上次发送超过 kShipInterval 时，每个脏账户以
+     * BALANCE_HISTORY_SEGMENT 消息发送新封存的变化点
+     */
+    void ship_history_delta();
+
+    /**
+     * @brief 发送每个托管账户余额历史的最后一段
+     */
+    void send_history();
+
+    /**
+     * @brief 处理作为源账户的一批转账请求
+     *
+     * 逐笔扣款；目标账户也在本进程时直接入账，关联ID并入本批次的ACK；
+     * 其余订单按目标进程分组转发
+     *
+     * @param msg 父进程发来的 ACCOUNT_TRANSFER_BATCH 消息
+     */
+    void handle_transfer_as_source(const Message& msg);
+
+    /**
+     * @brief 处理作为目标账户的一批转账请求
+     *
+     * 按目标账户合并入账金额，每个账户只更新一次历史（在途区间从源进程
+     * 发出订单到本进程入账），向父进程回复一个累计ACK
+     *
+     * @param msg 其他工作进程转发的 ACCOUNT_TRANSFER_BATCH 消息
+     * @param received_time 源进程发出订单的时间（已还原为64位）
+     */
+    void handle_transfer_as_destination(const Message& msg, lamport_time_t received_time);
+
+    /**
+     * @brief 把 ack_ids_ 中的关联ID作为累计ACK发送给父进程
+     * @param time 时间戳
+     */
+    void send_acks(lamport_time_t time);
+
+    /**
+     * @brief 把 rejected_ 中的无效订单作为 TRANSFER_REJECT 发送给父进程
+     *
+     * 父进程据此把这些转账按失败完成，而不是一直等待ACK
+     * @param time 时间戳
+     */
+    void send_rejects(lamport_time_t time);
+};
+
+// ==================== 兼容性函数 ====================
+
+/**
+ * @brief 多账户工作进程流程（函数版本）
+ * @param args 工作进程参数
+ */
+void multi_account_work(const MultiAccountArguments& args);
+
+#endif // BANKING_SYSTEM_PROCESS_MULTI_ACCOUNT_WORKER_H
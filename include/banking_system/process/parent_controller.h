@@ -1,7 +1,20 @@
 #ifndef BANKING_SYSTEM_PROCESS_PARENT_CONTROLLER_H
 #define BANKING_SYSTEM_PROCESS_PARENT_CONTROLLER_H
 
+#include "banking_system/common/clock.h"
 #include "banking_system/common/types.h"
+#include "banking_system/history/history_collector.h"
+#include "banking_system/history/history_index.h"
+#include "banking_system/transfer/account_directory.h"
+#include "banking_system/transfer/transfer_batch.h"
+#include "labs_headers/message.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 // ==================== 父进程控制器 ====================
 
@@ -12,7 +25,12 @@
  * 1. 等待所有账户进程启动
  * 2. 使用分片管理器并发执行转账
  * 3. 通知所有账户停止
- * 4. 收集并打印历史记录
+ * 4. 收集历史（转账期间已增量收集，这里只等最后一段），汇总打印并写出JSON报告
+ *
+ * 阶段3/4按到达顺序从任意账户批量接收，历史分段交给 HistoryCollector 并行解码。
+ * 指定账户数时为多账户模式：账户由 AccountDirectory 分给各工作进程
+ * （MultiAccountWorker），订单使用32位账户ID。
+ * 启动方在fork之前创建了 SharedLedger 时，转账在账本中直接结算
  */
 class ParentController {
 public:
@@ -20,8 +38,27 @@ public:
      * @brief 构造函数
      * @param count_nodes 节点总数（包括父进程）
      * @param num_shards 分片数量（默认8）
+     * @param accounts 账户总数（0表示一个进程一个账户）
+     * @param clock_mode 分片管理器的时钟域模式（时间来源由启动方在fork之前选择）
      */
-    explicit ParentController(int count_nodes, int num_shards = 8);
+    explicit ParentController(int count_nodes, int num_shards = 8, account_id_t accounts = 0,
+                              ClockMode clock_mode = ClockMode::GLOBAL);
+    
+    /**
+     * @brief 指定阶段2提交的转账（run() 之前调用）
+     * 
+     * 账户ID必须在 1..账户总数 之内；不指定时使用默认的账户环
+     * （i -> i+1，最后一个账户转回账户1）
+     * 
+     * @param transfers 按提交顺序排列的转账
+     */
+    void set_workload(std::vector<AccountTransfer> transfers) { workload_ = std::move(transfers); }
+    
+    /**
+     * @brief 把余额历史报告写到指定目录（run() 之前调用；默认写在当前目录）
+     * @param directory 报告目录（为空时使用当前目录）
+     */
+    void set_report_directory(const std::string& directory);
     
     /**
      * @brief 执行父进程主控流程
@@ -33,13 +70,58 @@ public:
      * - 阶段4: 收集历史
      */
     void run();
+    
+    /**
+     * @brief 查询账户在逻辑时刻 time 的余额（run() 结束后调用，O(log n)）
+     * @param account 账户ID
+     * @param time 逻辑时间
+     */
+    balance_t balance_at(account_id_t account, lamport_time_t time) const;
+    
+    /**
+     * @brief 查询逻辑时刻 time 所有账户的总余额（run() 结束后调用，O(log n)）
+     * @param time 逻辑时间
+     */
+    int64_t total_at(lamport_time_t time) const;
+    
+    /**
+     * @brief 第一笔转账完成的时刻（run() 结束后调用）
+     * 
+     * 启动方据此统计从启动到第一笔转账完成的时间；没有提交任何转账时为默认值
+     */
+    std::chrono::steady_clock::time_point first_transfer_time() const { return first_transfer_; }
 
 private:
+    /**
+     * @brief 阶段3/4每次批量接收的最大消息数
+     */
+    static constexpr int kCollectBatch = 64;
+    
+    /**
+     * @brief 余额历史表格最多打印的时刻数（与原 print_history 的上限一致）
+     */
+    static constexpr size_t kTableTicks = UINT8_MAX;
+    
+    /**
+     * @brief 机器可读的余额历史报告路径
+     */
+    static constexpr const char* kHistoryReportPath = "history_report.json";
+    
     int count_nodes_;     ///< 节点总数
     int num_shards_;      ///< 分片数量
+    ClockMode clock_mode_; ///< 分片管理器的时钟域模式
+    bool multi_account_;  ///< 是否为多账户模式
+    AccountDirectory directory_; ///< 账户目录（一个进程一个账户时账户ID即进程ID）
+    HistoryCollector history_; ///< 增量收集的余额历史
+    std::vector<Message> inbox_;    ///< 批量接收缓冲区
+    std::vector<local_id> senders_; ///< 每条消息的发送方ID
+    std::unique_ptr<HistoryIndex> index_; ///< 阶段4收齐后建立的时间点查询索引
+    std::vector<AccountTransfer> workload_; ///< 阶段2提交的转账（为空时使用默认账户环）
+    std::chrono::steady_clock::time_point first_transfer_; ///< 第一笔转账完成的时刻
+    std::string report_path_;       ///< 余额历史报告的写出路径
     
     /**
-     * @brief 阶段1：等待所有账户启动
+     * @brief 阶段1：在启动屏障（ProcessBarrier）上等待所有账户启动
      */
     void phase1_wait_startup();
     
@@ -49,14 +131,25 @@ private:
     void phase2_execute_transfers();
     
     /**
-     * @brief 阶段3：通知所有账户停止
+     * @brief 默认转账：账户环 i -> i+1，最后一个账户转回账户1
+     */
+    std::vector<AccountTransfer> default_workload() const;
+    
+    /**
+     * @brief 阶段3：沿生成树通知所有账户停止，并等待终止检测完成
      */
     void phase3_stop_all();
     
     /**
-     * @brief 阶段4：收集余额历史记录
+     * @brief 阶段4：等待每个账户的最后一段余额历史（水位线），汇总、检查守恒并输出
      */
     void phase4_collect_history();
+    
+    /**
+     * @brief 从任意账户批量接收一批消息，推进逻辑时钟并并行解码其中的历史分段
+     * @return 接收到的消息数量，失败返回-1
+     */
+    int collect_batch();
 };
 
 // ==================== 兼容性函数 ====================
@@ -66,7 +159,10 @@ private:
  * 
  * @param count_nodes 节点总数（包括父进程）
  * @param num_shards 分片数量（默认8）
+ * @param accounts 账户总数（0表示一个进程一个账户）
+ * @param clock_mode 分片管理器的时钟域模式
  */
-void parent_work(int count_nodes, int num_shards = 8);
+void parent_work(int count_nodes, int num_shards = 8, account_id_t accounts = 0,
+                 ClockMode clock_mode = ClockMode::GLOBAL);
 
 #endif // BANKING_SYSTEM_PROCESS_PARENT_CONTROLLER_H
\ No newline at end of file
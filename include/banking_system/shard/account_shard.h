@@ -2,15 +2,38 @@
 #define BANKING_SYSTEM_SHARD_ACCOUNT_SHARD_H
 
 #include "banking_system/transfer/transfer_task.h"
-#include <queue>
+#include "banking_system/common/mpsc_ring.h"
+#include "banking_system/common/spsc_ring.h"
+#include "banking_system/common/flat_id_map.h"
+#include "banking_system/common/clock.h"
+#include "banking_system/common/pending_counter.h"
+#include "labs_headers/message.h"
+#include <vector>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
+#include <chrono>
 
 // 前向声明
 class ShardManager;
 
+// ==================== ACK完成事件 ====================
+
+/**
+ * @brief ACK完成事件
+ * 
+ * 由ShardManager的ACK分发线程解析ACK后投递到分片的完成队列
+ */
+struct AckEvent {
+    uint64_t correlation_id;    ///< 关联ID（旧格式ACK为0）
+    local_id from;              ///< ACK发送方（目标账户）
+    lamport_time_t commit_time; ///< ACK的Lamport时间戳（入账提交时间，已还原为64位）
+    bool rejected;              ///< 子进程拒绝了该订单（TRANSFER_REJECT），按失败完成
+};
+
 // ==================== 账户分片类 ====================
 
 /**
@@ -21,17 +44,46 @@ class ShardManager;
  * 
  * 设计要点：
  * - 每个分片一个工作线程，避免分片内竞争
- * - 使用任务队列解耦任务提交和执行
- * - 支持分片内转账和跨分片转账协调
+ * - 使用有界无锁MPSC队列解耦任务提交和执行，提交方之间不争用互斥锁
+ * - 工作线程批量取出任务，空闲时先自适应自旋，再在条件变量上睡眠
+ * - 每次从队列取出一批任务，发往同一源账户的订单合并为一条TRANSFER_BATCH
+ * - 流水线化：转账发出后不等待ACK，最多保持 max_in_flight 笔在途，
+ *   ACK携带关联ID，可乱序完成
+ * - 工作线程从不调用receive，ACK由ShardManager的分发线程投递到完成队列
+ * - 支持分片内转账和跨分片转账协调：Step1完成后，源分片直接把Step2
+ *   放入目标分片的专用SPSC入站通道（每个有序分片对一个），不经过管理器
  */
 class AccountShard {
 public:
+    /**
+     * @brief 默认在途窗口深度
+     */
+    static constexpr size_t kDefaultMaxInFlight = 64;
+    
+    /**
+     * @brief 默认任务队列容量
+     */
+    static constexpr size_t kDefaultQueueCapacity = 4096;
+    
+    /**
+     * @brief 每个分片间Step2通道的容量
+     */
+    static constexpr size_t kStep2ChannelCapacity = 1024;
+    
     /**
      * @brief 构造函数
      * @param shard_id 分片ID
+     * @param num_shards 分片总数（每个源分片一个入站Step2通道）
      * @param manager 指向ShardManager的指针（用于回调）
+     * @param max_in_flight 在途窗口深度（等待ACK的最大转账数）
+     * @param queue_capacity 任务队列容量（向上取整为2的幂）
+     * @param clock_mode 时钟域模式（PER_SHARD时分片使用独立时钟，
+     *                   时间来源与进程级时钟相同）
      */
-    AccountShard(int shard_id, ShardManager* manager);
+    AccountShard(int shard_id, int num_shards, ShardManager* manager, 
+                 size_t max_in_flight = kDefaultMaxInFlight,
+                 size_t queue_capacity = kDefaultQueueCapacity,
+                 ClockMode clock_mode = ClockMode::GLOBAL);
     
     /**
      * @brief 析构函数 - 优雅关闭线程
@@ -45,19 +97,80 @@ public:
     /**
      * @brief 提交任务到分片队列
      * 
-     * 线程安全的任务提交接口
+     * 线程安全的任务提交接口，队列满时阻塞直到工作线程腾出空间。
+     * 不能在分片工作线程中调用（应使用 try_submit_task）
      * 
      * @param task 转账任务
      */
     void submit_task(const TransferTask& task);
     
+    /**
+     * @brief 批量提交任务到分片队列
+     * 
+     * 每次CAS抢占一段连续槽位，整批只唤醒工作线程一次；
+     * 队列满时阻塞。不能在分片工作线程中调用
+     * 
+     * @param tasks 任务数组
+     * @param count 任务数量
+     */
+    void submit_tasks(const TransferTask* tasks, size_t count);
+    
+    /**
+     * @brief 尝试提交任务到分片队列（不阻塞）
+     * 
+     * @param task 转账任务
+     * @return 队列已满返回false
+     */
+    bool try_submit_task(const TransferTask& task);
+    
+    /**
+     * @brief 连接所有分片（管理器创建完全部分片后、提交任务前调用一次）
+     * @param peers 按分片ID索引的分片指针
+     */
+    void connect_peers(const std::vector<AccountShard*>& peers);
+    
+    /**
+     * @brief 接收源分片移交的Step2（仅由源分片的工作线程调用）
+     * 
+     * @param from_shard 源分片ID
+     * @param step2_task Step2任务
+     * @return 通道已满返回false
+     */
+    bool offer_step2(int from_shard, const TransferTask& step2_task);
+    
+    /**
+     * @brief 投递ACK完成事件（由ACK分发线程调用）
+     * 
+     * @param events 完成事件数组
+     * @param count 事件数量
+     */
+    void deliver_acks(const AckEvent* events, size_t count);
+    
     /**
      * @brief 等待分片处理完所有任务
      * 
-     * 轮询检查队列是否为空，适用于同步等待场景
+     * 阻塞直到排队、执行中和等待ACK的任务全部结束，
+     * 最后一笔完成时立即唤醒
      */
     void wait_completion();
     
+    /**
+     * @brief 带截止时间的 wait_completion
+     * @param deadline 截止时间
+     * @return 全部完成返回true，超时返回false
+     */
+    bool wait_for(std::chrono::steady_clock::time_point deadline);
+    
+    /**
+     * @brief 获取分片使用的时钟（GLOBAL模式下为进程级时钟）
+     */
+    const LamportClock& clock() const { return *clock_; }
+    
+    /**
+     * @brief 获取未完成任务数量（排队 + 执行中 + 等待ACK）
+     */
+    size_t pending_count() const { return pending_tasks_.pending(); }
+    
     /**
      * @brief 获取并打印统计信息
      * 
@@ -71,10 +184,64 @@ private:
     int shard_id_;                              ///< 分片ID
     ShardManager* manager_;                     ///< 指向管理器的指针
     
+    // 时钟域
+    LamportClock own_clock_;                    ///< 分片独立时钟（PER_SHARD模式，沿用进程级时间来源）
+    LamportClock* clock_;                       ///< 当前使用的时钟
+    
     // 任务队列相关
-    std::queue<TransferTask> task_queue_;       ///< 任务队列
-    std::mutex queue_mutex_;                    ///< 队列互斥锁
-    std::condition_variable queue_cv_;          ///< 条件变量（用于线程同步）
+    MpscRing<TransferTask> task_ring_;          ///< 无锁任务队列
+    std::mutex queue_mutex_;                    ///< 保护完成队列和工作线程睡眠
+    std::condition_variable queue_cv_;          ///< 条件变量（唤醒工作线程）
+    std::vector<AckEvent> completions_;         ///< 完成队列（受queue_mutex_保护）
+    std::atomic<bool> completions_ready_;       ///< 完成队列非空标志
+    std::atomic<bool> worker_sleeping_;         ///< 工作线程是否准备睡眠
+    std::mutex space_mutex_;                    ///< 队列满时提交方等待用的锁
+    std::condition_variable space_cv_;          ///< 队列腾出空间的通知
+    std::atomic<int> submit_waiters_;           ///< 因队列满而等待的提交方数量
+    int spin_budget_;                           ///< 当前空闲自旋次数（仅工作线程访问）
+    std::vector<std::vector<const TransferTask*>> src_groups_; ///< 按源账户分组的批次任务
+    
+    /**
+     * @brief 每次从队列取出的最大任务数
+     */
+    static constexpr size_t kMaxBatchTasks = 256;
+    
+    /**
+     * @brief 空闲自旋次数的上下限
+     */
+    static constexpr int kMinSpin = 64;
+    static constexpr int kMaxSpin = 4096;
+    
+    // 跨分片Step2移交
+    std::vector<std::unique_ptr<SpscRing<TransferTask>>> step2_inbound_; ///< 入站Step2通道（按源分片索引）
+    std::vector<AccountShard*> peers_;          ///< 所有分片（按分片ID索引）
+    std::vector<TransferTask> deferred_step2_;  ///< 目标通道满时暂缓的Step2（仅工作线程访问）
+    std::vector<size_t> deferred_per_target_;   ///< 按目标分片统计的暂缓Step2数量（仅工作线程访问）
+    std::atomic<bool> step2_deferred_;          ///< 有暂缓的Step2：目标分片腾出通道空间时唤醒本分片
+    
+    /**
+     * @brief 未完成任务计数
+     * 
+     * 任务入队前加1，任务彻底结束时减1：本地转账和Step2在ACK到达
+     * （或失败）时结束，Step1在成功移交Step2（或失败）时结束
+     */
+    PendingCounter pending_tasks_;
+    
+    // 在途转账（仅工作线程访问）
+    size_t max_in_flight_;                      ///< 在途窗口深度
+    FlatIdMap<TransferTask> in_flight_;         ///< 已发出、等待ACK的转账（按窗口深度预留）
+    FlatIdMap<lamport_time_t> early_acks_;      ///< 先于登记到达的ACK（关联ID → 提交时间，拒绝为kRejectedCommit）
+    std::vector<std::deque<uint64_t>> in_flight_order_; ///< 按目标进程、按登记顺序排列的在途关联ID（惰性清理）
+    
+    /**
+     * @brief 登记顺序队列中已完成ID的容忍量，超过后整体清理一次
+     */
+    static constexpr size_t kOrderSlack = 64;
+    
+    /**
+     * @brief early_acks_ 中表示“订单被拒绝”的提交时间（合法时间戳非负）
+     */
+    static constexpr lamport_time_t kRejectedCommit = -1;
     
     // 线程管理
     std::thread worker_thread_;                 ///< 工作线程
@@ -91,10 +258,95 @@ private:
     /**
      * @brief 工作线程主循环
      * 
-     * 不断从队列取出任务并执行，支持优雅退出
+     * 先处理完成事件，再在窗口允许的范围内批量取出任务发送；
+     * 没有进展时进入 wait_for_work，支持优雅退出（等待在途转账全部完成）
      */
     void worker_loop();
     
+    /**
+     * @brief 工作线程是否有事可做（仅工作线程调用）
+     */
+    bool has_work() const;
+    
+    /**
+     * @brief 所有入站Step2通道是否都为空
+     */
+    bool step2_inbound_empty() const;
+    
+    /**
+     * @brief 空闲等待：自适应自旋后在条件变量上睡眠
+     * 
+     * 自旋期间等到任务则下次自旋加倍，否则减半
+     */
+    void wait_for_work();
+    
+    /**
+     * @brief 入队后唤醒可能正在睡眠的工作线程
+     */
+    void wake_worker();
+    
+    /**
+     * @brief 队列满时提交方的等待：先自旋，超过上限后睡眠到工作线程出队
+     * @param spins 已自旋次数（调用方在每次入队成功后清零）
+     */
+    void wait_for_space(int& spins);
+    
+    /**
+     * @brief 出队后通知因队列满而等待的提交方（每次腾出空间都调用）
+     */
+    void notify_submitters();
+    
+    /**
+     * @brief 把跨分片Step2直接移交给目标分片（目标通道满时暂缓重试）
+     * @param step1_task 已完成的Step1任务
+     */
+    void hand_off_step2(const TransferTask& step1_task);
+    
+    /**
+     * @brief 取出各入站通道中的Step2并登记为在途转账
+     * @return 处理的Step2数量
+     */
+    size_t drain_step2_inbound();
+    
+    /**
+     * @brief 重试暂缓的跨分片Step2
+     */
+    void retry_deferred_step2();
+    
+    /**
+     * @brief 合并其他时钟域的时间（GLOBAL模式下无需合并）
+     * @param other_time 任务或ACK携带的Lamport时间
+     */
+    void observe_time(lamport_time_t other_time) {
+        if (clock_ == &own_clock_) {
+            clock_->merge(other_time);
+        }
+    }
+    
+    /**
+     * @brief 处理一批任务
+     * 
+     * 本地转账和跨分片Step1按源账户分组，每组合并为一条TRANSFER_BATCH；
+     * 跨分片Step2逐个处理；两端都在共享账本中的本地转账直接结算
+     * 
+     * @param batch 从队列取出的任务
+     * @param count 任务数量
+     */
+    void process_batch(const TransferTask* batch, size_t count);
+    
+    /**
+     * @brief 在共享账本中直接结算一笔本地转账并立即完成
+     * @param task 两端都在账本中的本地转账
+     */
+    void settle_in_ledger(const TransferTask& task);
+    
+    /**
+     * @brief 向同一源账户发送一组订单（不等待ACK）
+     * @param src 源账户ID
+     * @param tasks 该源账户的任务（本地转账或跨分片Step1）
+     */
+    void ship_source_batch(local_id src, const std::vector<const TransferTask*>& tasks);
+    
     /**
      * @brief 处理单个任务（根据类型分发）
      * @param task 要处理的任务
@@ -105,9 +357,8 @@ private:
      * @brief 处理分片内转账
      * 
      * 流程：
-     * 1. 发送TRANSFER消息给源账户
-     * 2. 等待目标账户的ACK
-     * 3. 更新统计信息
+     * 1. 发送带关联ID的TRANSFER消息给源账户
+     * 2. 登记为在途转账，收到目标账户的ACK时更新统计信息
      * 
      * @param task 转账任务
      */
@@ -119,23 +370,75 @@ private:
      * 流程：
      * 1. 发送TRANSFER消息给源账户
      * 2. 源账户扣款成功
-     * 3. 回调manager执行第二步
+     * 3. 把Step2直接放入目标分片的入站通道
      * 
      * @param task 转账任务
      */
     void handle_cross_shard_step1(const TransferTask& task);
     
+    /**
+     * @brief 把一笔订单作为单条 TRANSFER 消息发给源账户
+     * @return 发送成功返回true
+     */
+    bool send_single_order(const TransferTask& task);
+    
+    /**
+     * @brief 订单发送失败：逐笔按失败完成
+     * @param tasks 未发出的任务
+     * @param count 任务数量
+     * @param src 发送目标（源账户所在进程，用于日志）
+     */
+    void fail_unsent(const TransferTask* const* tasks, size_t count, local_id src);
+    
     /**
      * @brief 处理跨分片转账第二步（目标账户入账）
      * 
-     * 流程：
-     * 1. 转发TRANSFER消息给目标账户
-     * 2. 等待ACK确认
-     * 3. 更新统计信息
+     * 源账户已直接把订单转发给目标账户，这里只登记为在途转账，
+     * 收到目标账户带关联ID的ACK时更新统计信息
      * 
      * @param task 转账任务
      */
     void handle_cross_shard_step2(const TransferTask& task);
+    
+    /**
+     * @brief 登记在途转账（若ACK已提前到达则直接完成）
+     * @param task 转账任务
+     */
+    void track_in_flight(const TransferTask& task);
+    
+    /**
+     * @brief 按关联ID完成ACK确认的转账
+     * @param ack ACK完成事件
+     */
+    void handle_ack(const AckEvent& ack);
+    
+    /**
+     * @brief 完成一笔在途转账并更新统计信息
+     * @param task 转账任务
+     * @param success 是否成功
+     * @param commit_time 目标账户ACK的Lamport时间戳
+     */
+    void complete_transfer(const TransferTask& task, bool success, lamport_time_t commit_time);
+    
+    /**
+     * @brief 向异步提交方报告转账结果（同步提交的任务直接忽略）
+     * @param task 转账任务
+     * @param success 是否成功
+     * @param commit_time 提交时间（失败时为0）
+     */
+    void resolve_transfer(const TransferTask& task, bool success, lamport_time_t commit_time);
+    
+    /**
+     * @brief 结束一个任务，更新分片和管理器的未完成计数
+     * @param transfer_finished 整笔转账是否随之结束（Step1成功移交时为false）
+     */
+    void retire_task(bool transfer_finished);
+    
+    /**
+     * @brief 查找最早登记的、发往指定进程的在途转账（均摊O(1)）
+     * @return 关联ID，没有时返回0
+     */
+    uint64_t oldest_in_flight_to(local_id dst);
 };
 
 #endif // BANKING_SYSTEM_SHARD_ACCOUNT_SHARD_H
\ No newline at end of file
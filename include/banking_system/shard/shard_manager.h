@@ -2,13 +2,22 @@
 #define BANKING_SYSTEM_SHARD_SHARD_MANAGER_H
 
 #include "account_shard.h"
-#include "banking_system/transfer/cross_shard_context.h"
+#include "banking_system/transfer/cross_shard_table.h"
+#include "banking_system/transfer/transfer_handle.h"
+#include "banking_system/transfer/account_directory.h"
+#include "banking_system/transfer/transfer_batch.h"
 #include "banking_system/common/types.h"
+#include "banking_system/common/pending_counter.h"
+#include "banking_system/history/history_collector.h"
+#include "banking_system/ipc/shared_ledger.h"
+#include "labs_headers/banking.h"
 #include <vector>
 #include <memory>
-#include <unordered_map>
-#include <mutex>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
 
 // ==================== 分片管理器类 ====================
 
@@ -18,30 +27,50 @@
  * 负责：
  * 1. 管理所有分片的生命周期（创建、销毁）
  * 2. 路由转账请求到正确的分片
- * 3. 协调跨分片转账的两步操作（2PC简化版）
+ * 3. 为跨分片转账分配上下文（两步操作由分片之间直接衔接）
+ * 4. 运行唯一的ACK分发线程，把子进程的ACK投递到对应分片的完成队列，
+ *    子进程增量发送的余额历史交给 HistoryCollector
  * 
  * 架构特点：
- * - 采用哈希分片策略（account_id % num_shards）
+ * - 采用哈希分片策略（托管进程ID % num_shards；一个进程一个账户时即 account_id % num_shards）
+ * - 多账户模式下（提供 AccountDirectory）订单发往托管源账户的工作进程，
+ *   使用32位账户ID的 ACCOUNT_TRANSFER_BATCH；同一进程的账户总在同一分片
+ * - 提供共享账本时，两端都在账本中的转账不再拆成跨分片两步，
+ *   由源分片直接在账本中原子结算，不发送任何消息
  * - 每个分片独立工作线程，实现并行处理
- * - 跨分片转账使用correlation_id追踪状态
+ * - 每笔转账分配correlation_id，ACK据此乱序完成
  */
 class ShardManager {
 public:
     /**
      * @brief 构造函数
      * 
-     * 创建指定数量的分片，每个分片启动独立的工作线程
+     * 创建指定数量的分片，每个分片启动独立的工作线程。
+     * 共享内存传输层必须已创建：单账户模式的账户数取自其节点数
      * 
      * @param num_shards 分片数量（建议4, 8, 16等2的幂次）
+     * @param max_in_flight 每个分片的在途窗口深度
+     * @param clock_mode 时钟域模式（PER_SHARD时各分片使用独立时钟，
+     *                   在等待完成时合并回进程级时钟）
+     * @param history 余额历史收集器（可为空；非空时分发线程把收到的
+     *                余额历史消息交给它，管理器销毁前调用方不能再使用它）
+     * @param directory 账户目录（可为空；为空时账户ID即进程ID，
+     *                  非空时为多账户模式，生命周期由调用方保证）
+     * @param ledger 共享账本（可为空；非空时账本中的账户之间的转账走快速路径）
      */
-    explicit ShardManager(int num_shards);
+    explicit ShardManager(int num_shards, 
+                          size_t max_in_flight = AccountShard::kDefaultMaxInFlight,
+                          ClockMode clock_mode = ClockMode::GLOBAL,
+                          HistoryCollector* history = nullptr,
+                          const AccountDirectory* directory = nullptr,
+                          SharedLedger* ledger = nullptr);
     
     /**
      * @brief 析构函数
      * 
-     * 智能指针会自动清理分片资源，确保所有线程正常退出
+     * 等待所有转账结束，再关闭所有分片，最后停止ACK分发线程
      */
-    ~ShardManager() = default;
+    ~ShardManager();
     
     // 禁止拷贝和赋值
     ShardManager(const ShardManager&) = delete;
@@ -50,12 +79,50 @@ public:
     /**
      * @brief 计算账户所属的分片ID
      * 
-     * 使用取模哈希分片策略
+     * 按托管进程取模：同一进程的账户落在同一分片，
+     * 该进程发回的ACK因此总能投递到等待它的分片
      * 
      * @param account_id 账户ID
      * @return 分片ID (0 到 num_shards-1)
      */
-    int get_shard_id(local_id account_id) const;
+    int get_shard_id(account_id_t account_id) const {
+        return process_of(account_id) % num_shards_;
+    }
+    
+    /**
+     * @brief 托管账户的进程ID
+     */
+    local_id process_of(account_id_t account_id) const {
+        return directory_ ? directory_->worker_of(account_id) 
+                          : static_cast<local_id>(account_id);
+    }
+    
+    /**
+     * @brief 账户是否存在（多账户模式查目录，否则为 1..count_nodes-1 的子进程）
+     *
+     * 分片ID和在途队列都按账户下标，提交前必须先检查
+     */
+    bool hosts_account(account_id_t account_id) const {
+        return directory_ ? directory_->contains(account_id)
+                          : account_id > PARENT_ID && account_id <= accounts_;
+    }
+    
+    /**
+     * @brief 是否为多账户模式（订单使用32位账户ID）
+     */
+    bool multi_account() const { return directory_ != nullptr; }
+    
+    /**
+     * @brief 转账能否直接在共享账本中结算（两端都在账本中）
+     */
+    bool settles_in_ledger(account_id_t src, account_id_t dst) const {
+        return ledger_ && ledger_->contains(src) && ledger_->contains(dst);
+    }
+    
+    /**
+     * @brief 共享账本（未启用时为空）
+     */
+    SharedLedger* ledger() const { return ledger_; }
     
     /**
      * @brief 提交转账请求（统一入口）
@@ -68,16 +135,59 @@ public:
      * @param dst 目标账户ID
      * @param amount 转账金额
      */
-    void submit_transfer(local_id src, local_id dst, balance_t amount);
+    void submit_transfer(account_id_t src, account_id_t dst, balance_t amount);
     
     /**
-     * @brief 提交跨分片转账第二步（由AccountShard回调）
+     * @brief 批量提交转账请求
      * 
-     * 当源账户扣款成功后，AccountShard调用此方法触发目标账户入账
+     * 一次遍历按源分片分桶并就地构造任务：本地转账的关联ID整批只预留一次，
+     * 跨分片转账逐笔从无锁上下文表申请槽位（表满时先提交已分桶的任务，
+     * 再等待槽位释放），每个分片一次批量无锁入队。
+     * 引用不存在账户的订单直接按失败计数，不会提交
      * 
-     * @param correlation_id 关联ID
+     * @param transfers 转账订单数组
+     * @param count 订单数量
+     */
+    void submit_transfers(const TransferOrder* transfers, size_t count);
+    
+    /**
+     * @brief 批量提交转账请求（vector版本）
+     * @param transfers 转账订单
+     */
+    void submit_transfers(const std::vector<TransferOrder>& transfers) {
+        submit_transfers(transfers.data(), transfers.size());
+    }
+    
+    /**
+     * @brief 批量提交32位账户ID的转账请求（多账户模式）
+     * @param transfers 转账订单数组
+     * @param count 订单数量
      */
-    void submit_cross_shard_step2(uint64_t correlation_id);
+    void submit_transfers(const AccountTransfer* transfers, size_t count);
+    
+    /**
+     * @brief 批量提交32位账户ID的转账请求（vector版本）
+     * @param transfers 转账订单
+     */
+    void submit_transfers(const std::vector<AccountTransfer>& transfers) {
+        submit_transfers(transfers.data(), transfers.size());
+    }
+    
+    /**
+     * @brief 异步提交转账请求
+     * 
+     * 路由方式与 submit_transfer 相同，但返回一个完成句柄：
+     * 可以轮询 ready()、阻塞 get()，或在完成时由分片工作线程调用回调。
+     * 结果包含是否成功、入账提交的Lamport时间戳和端到端延迟
+     * 
+     * @param src 源账户ID
+     * @param dst 目标账户ID
+     * @param amount 转账金额
+     * @param callback 可选的完成回调（在分片工作线程中执行）
+     * @return 转账完成句柄
+     */
+    TransferHandle submit_transfer_async(account_id_t src, account_id_t dst, balance_t amount,
+                                         TransferCallback callback = nullptr);
     
     /**
      * @brief 清理跨分片上下文
@@ -89,12 +199,29 @@ public:
     void cleanup_cross_shard_context(uint64_t correlation_id);
     
     /**
-     * @brief 等待所有分片完成
+     * @brief 转账彻底结束（成功或失败）时由AccountShard回调
+     */
+    void on_transfer_finished();
+    
+    /**
+     * @brief 等待所有已提交的转账完成
      * 
-     * 轮询所有分片直到任务队列全部为空
+     * 阻塞在管理器级未完成计数上，最后一笔转账结束时立即唤醒
      */
     void wait_all_complete();
     
+    /**
+     * @brief 带截止时间的 wait_all_complete
+     * @param deadline 截止时间
+     * @return 全部完成返回true，超时返回false
+     */
+    bool wait_for(std::chrono::steady_clock::time_point deadline);
+    
+    /**
+     * @brief 获取未完成的转账数量
+     */
+    size_t pending_count() const { return pending_transfers_.pending(); }
+    
     /**
      * @brief 打印所有分片的统计信息
      * 
@@ -106,31 +233,112 @@ private:
     // ==================== 成员变量 ====================
     
     int num_shards_;                                                  ///< 分片数量
+    ClockMode clock_mode_;                                            ///< 时钟域模式
     std::vector<std::unique_ptr<AccountShard>> shards_;              ///< 分片数组
     
     // 跨分片转账协调
-    std::unordered_map<uint64_t, CrossShardContext> cross_shard_contexts_;  ///< 跨分片上下文映射
-    std::mutex context_mutex_;                                        ///< 保护contexts的互斥锁
+    CrossShardContextTable contexts_;                                 ///< 跨分片上下文表（无锁，预分配）
+    std::mutex context_mutex_;                                        ///< 表满时提交方等待用的锁
+    std::condition_variable context_cv_;                              ///< 槽位释放的通知
+    std::atomic<int> context_waiters_;                                ///< 因表满而等待的提交方数量
     std::atomic<uint64_t> next_correlation_id_;                      ///< 下一个关联ID（原子递增）
+    PendingCounter pending_transfers_;                                ///< 已提交未结束的转账数量
+    
+    // ACK分发
+    std::thread reactor_thread_;                                      ///< ACK分发线程
+    std::atomic<bool> reactor_stop_;                                  ///< 分发线程停止标志
+    HistoryCollector* history_;                                       ///< 余额历史收集器（可为空）
+    const AccountDirectory* directory_;                               ///< 账户目录（为空时账户ID即进程ID）
+    SharedLedger* ledger_;                                            ///< 共享账本（为空时全部走消息）
+    account_id_t accounts_;                                           ///< 单账户模式下的账户数（子进程数）
+    std::atomic<uint64_t> rejected_transfers_;                        ///< 因账户不存在而未提交的转账数量
+    
+    /**
+     * @brief 上下文表槽位数与全部分片在途窗口之比
+     *
+     * 每个槽位按缓存行对齐并带一份 TransferTask（128字节），按窗口而不是固定的
+     * 65536 个槽位分配（默认8个分片为128KB而不是8MB）；窗口之外再留
+     * 同样多的余量给已出队、尚未收到ACK的Step2，表满时提交方阻塞等待
+     */
+    static constexpr size_t kContextsPerWindowSlot = 2;
+    
+    /**
+     * @brief 分发线程每次最多取出的消息数
+     */
+    static constexpr int kReactorBatch = 32;
+    
+    /**
+     * @brief 分发线程的等待超时（毫秒），用于检查停止标志
+     */
+    static constexpr int kReactorPollMs = 100;
     
     // ==================== 私有方法 ====================
     
+    /**
+     * @brief ACK分发线程主循环
+     * 
+     * 父进程中唯一从子进程接收消息的线程：批量取出ACK，
+     * 按关联ID投递到等待它的分片的完成队列；余额历史增量交给收集器
+     */
+    void reactor_loop();
+    
+    /**
+     * @brief 解析一条入站消息并按分片归类完成事件
+     * @param from 发送方进程ID
+     * @param msg 入站消息
+     * @param routed 每个分片待投递的完成事件
+     */
+    void route_inbound(local_id from, const Message& msg,
+                       std::vector<std::vector<AckEvent>>& routed);
+    
+    /**
+     * @brief 路由转账请求（同步和异步提交的公共实现）
+     * @param completion 完成状态（同步提交时为空）
+     */
+    void dispatch_transfer(account_id_t src, account_id_t dst, balance_t amount,
+                           std::shared_ptr<TransferCompletion> completion);
+    
+    /**
+     * @brief 拒绝引用不存在账户的转账：不发送任何消息，立即按失败完成
+     * @param completion 完成状态（可为空）
+     */
+    void reject_transfer(account_id_t src, account_id_t dst,
+                         const std::shared_ptr<TransferCompletion>& completion);
+    
+    /**
+     * @brief 批量提交的公共实现（TransferOrder 和 AccountTransfer 共用）
+     */
+    template <typename Order>
+    void submit_orders(const Order* transfers, size_t count);
+    
+    /**
+     * @brief 把各分片的时钟域合并回进程级时钟（仅PER_SHARD模式）
+     */
+    void sync_clocks();
+    
+    /**
+     * @brief 为跨分片Step1申请上下文槽位（表满时阻塞到槽位释放）
+     * @param step1_task Step1任务，成功后写入分配的correlation_id
+     */
+    void acquire_context(TransferTask& step1_task);
+    
     /**
      * @brief 处理跨分片转账
      * 
      * 协调流程：
-     * 1. 生成唯一的correlation_id
-     * 2. 创建并保存跨分片上下文
-     * 3. 提交第一步任务到源分片
+     * 1. 在上下文表中申请槽位，槽位下标和代数编码为correlation_id
+     * 2. 提交第一步任务到源分片
      * 
      * @param src 源账户ID
      * @param dst 目标账户ID
      * @param amount 转账金额
      * @param src_shard 源分片ID
      * @param dst_shard 目标分片ID
+     * @param completion 完成状态（同步提交时为空）
      */
-    void handle_cross_shard_transfer(local_id src, local_id dst, balance_t amount,
-                                     int src_shard, int dst_shard);
+    void handle_cross_shard_transfer(account_id_t src, account_id_t dst, balance_t amount,
+                                     int src_shard, int dst_shard,
+                                     std::shared_ptr<TransferCompletion> completion);
 };
 
 #endif // BANKING_SYSTEM_SHARD_SHARD_MANAGER_H
\ No newline at end of file
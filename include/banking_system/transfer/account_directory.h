@@ -0,0 +1,92 @@
+#ifndef BANKING_SYSTEM_TRANSFER_ACCOUNT_DIRECTORY_H
+#define BANKING_SYSTEM_TRANSFER_ACCOUNT_DIRECTORY_H
+
+#include "banking_system/common/types.h"
+#include "labs_headers/message.h"
+#include <cstdint>
+
+// ==================== 账户目录 ====================
+
+/**
+ * @brief 账户ID到托管进程的目录
+ *
+ * 多账户模式下每个工作进程托管一段连续的账户：账户 1..accounts 按块均分给
+ * 工作进程 1..workers，进程内按槽位（账户在块内的下标）稠密存放。
+ * 目录只由两个整数决定，父进程和所有工作进程各自构造即可得到相同结果，
+ * 查询为O(1)，不需要在进程之间同步表格。
+ * accounts == workers 时退化为一个进程一个账户（账户ID即进程ID）
+ */
+class AccountDirectory {
+public:
+    /**
+     * @brief 构造函数
+     * @param accounts 账户总数
+     * @param workers 工作进程数（1..MAX_PROCESS_ID）
+     */
+    AccountDirectory(account_id_t accounts, int workers)
+        : accounts_(accounts)
+        , workers_(workers > 0 ? workers : 1)
+        , per_worker_((accounts + workers_ - 1) / workers_)
+    {
+        if (per_worker_ == 0) {
+            per_worker_ = 1;
+        }
+    }
+
+    /**
+     * @brief 账户总数
+     */
+    account_id_t accounts() const { return accounts_; }
+
+    /**
+     * @brief 工作进程数
+     */
+    int workers() const { return workers_; }
+
+    /**
+     * @brief 账户ID是否有效
+     */
+    bool contains(account_id_t account) const {
+        return account >= 1 && account <= accounts_;
+    }
+
+    /**
+     * @brief 托管账户的工作进程ID
+     */
+    local_id worker_of(account_id_t account) const {
+        return static_cast<local_id>((account - 1) / per_worker_ + 1);
+    }
+
+    /**
+     * @brief 账户在托管进程中的槽位
+     */
+    uint32_t slot_of(account_id_t account) const {
+        return (account - 1) % per_worker_;
+    }
+
+    /**
+     * @brief 工作进程托管的第一个账户ID
+     */
+    account_id_t first_account(local_id worker) const {
+        return static_cast<account_id_t>(worker - 1) * per_worker_ + 1;
+    }
+
+    /**
+     * @brief 工作进程托管的账户数量
+     */
+    account_id_t account_count(local_id worker) const {
+        account_id_t first = first_account(worker);
+        if (first > accounts_) {
+            return 0;
+        }
+        account_id_t rest = accounts_ - first + 1;
+        return rest < per_worker_ ? rest : per_worker_;
+    }
+
+private:
+    account_id_t accounts_;     ///< 账户总数
+    int workers_;               ///< 工作进程数
+    account_id_t per_worker_;   ///< 每个进程托管的账户数（最后一个进程可能更少）
+};
+
+#endif // BANKING_SYSTEM_TRANSFER_ACCOUNT_DIRECTORY_H
@@ -17,6 +17,11 @@ struct CrossShardContext {
     bool step1_completed;                                  ///< 第一步是否完成
     std::chrono::steady_clock::time_point timestamp;       ///< 创建时间（用于超时检测）
     
+    /**
+     * @brief 默认构造函数（用于预分配的上下文表槽位）
+     */
+    CrossShardContext() : CrossShardContext(TransferTask()) {}
+    
     /**
      * @brief 构造函数
      * @param t 转账任务
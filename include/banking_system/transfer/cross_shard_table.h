@@ -0,0 +1,214 @@
+#ifndef BANKING_SYSTEM_TRANSFER_CROSS_SHARD_TABLE_H
+#define BANKING_SYSTEM_TRANSFER_CROSS_SHARD_TABLE_H
+
+#include "cross_shard_context.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// ==================== 跨分片上下文表 ====================
+
+/**
+ * @brief 预分配的跨分片上下文表
+ * 
+ * 取代 unordered_map + 全局互斥锁：
+ * - 构造时一次性分配所有槽位，热路径上不分配内存
+ * - correlation_id 编码槽位下标和代数：最高位为表标志，
+ *   bit 32-62 为代数，低32位为槽位下标，查找是一次数组访问
+ * - 空闲槽位组成带标签的无锁栈（Treiber栈），申请和释放都是无锁的
+ * - 释放时代数加1，过期的correlation_id查找失败而不会读到新上下文
+ * 
+ * 槽位内容由 acquire 写入，之后只读，直到 release；
+ * correlation_id 经由分片任务队列传递，队列的发布语义保证读者看到完整内容。
+ */
+class CrossShardContextTable {
+public:
+    /**
+     * @brief 默认槽位数量（ShardManager 按分片数和在途窗口确定实际大小）
+     */
+    static constexpr size_t kDefaultCapacity = 1 << 10;
+    
+    /**
+     * @brief 表分配的correlation_id的标志位（与管理器递增分配的本地转账ID区分）
+     */
+    static constexpr uint64_t kTableIdFlag = uint64_t(1) << 63;
+    
+    /**
+     * @brief 代数掩码（31位，bit 32-62），超过后回绕到0
+     */
+    static constexpr uint32_t kGenerationMask = 0x7FFFFFFFu;
+    
+    /**
+     * @brief 构造函数
+     * @param capacity 槽位数量
+     * @param initial_generation 所有槽位的初始代数（测试代数回绕时使用）
+     */
+    explicit CrossShardContextTable(size_t capacity = kDefaultCapacity,
+                                    uint32_t initial_generation = 0)
+        : capacity_(capacity > 0 ? capacity : 1)
+        , slots_(new Slot[capacity_])
+        , free_head_(0)
+        , in_use_(0)
+    {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].generation.store(initial_generation & kGenerationMask,
+                                       std::memory_order_relaxed);
+            uint32_t next = (i + 1 < capacity_) ? static_cast<uint32_t>(i + 1) : kNil;
+            slots_[i].next_free.store(next, std::memory_order_relaxed);
+        }
+        free_head_.store(pack(0, 0), std::memory_order_release);
+    }
+    
+    // 禁止拷贝和赋值
+    CrossShardContextTable(const CrossShardContextTable&) = delete;
+    CrossShardContextTable& operator=(const CrossShardContextTable&) = delete;
+    
+    /**
+     * @brief 申请一个槽位并登记Step1任务
+     * 
+     * 成功时把分配的correlation_id写入 step1_task.correlation_id
+     * 
+     * @param step1_task 跨分片Step1任务
+     * @return 分配的correlation_id，表已满返回0
+     */
+    uint64_t acquire(TransferTask& step1_task) {
+        uint32_t index;
+        if (!pop_free(&index)) {
+            return 0;
+        }
+        Slot& slot = slots_[index];
+        uint32_t generation = slot.generation.load(std::memory_order_relaxed);
+        uint64_t correlation_id = make_id(index, generation);
+        
+        step1_task.correlation_id = correlation_id;
+        slot.context.task = step1_task;
+        slot.context.step1_completed = false;
+        slot.context.timestamp = std::chrono::steady_clock::now();
+        in_use_.fetch_add(1, std::memory_order_relaxed);
+        return correlation_id;
+    }
+    
+    /**
+     * @brief 按correlation_id查找上下文
+     * @return 槽位已释放或ID过期返回nullptr
+     */
+    const CrossShardContext* find(uint64_t correlation_id) const {
+        const Slot* slot = lookup(correlation_id);
+        return slot != nullptr ? &slot->context : nullptr;
+    }
+    
+    /**
+     * @brief 释放correlation_id对应的槽位
+     * @return ID过期（重复释放）返回false
+     */
+    bool release(uint64_t correlation_id) {
+        Slot* slot = const_cast<Slot*>(lookup(correlation_id));
+        if (slot == nullptr) {
+            return false;
+        }
+        uint32_t generation = generation_of(correlation_id);
+        if (!slot->generation.compare_exchange_strong(generation, 
+                                                      (generation + 1) & kGenerationMask,
+                                                      std::memory_order_acq_rel)) {
+            return false;
+        }
+        // 释放完成回调等共享状态，槽位本身留待复用
+        slot->context.task.completion.reset();
+        in_use_.fetch_sub(1, std::memory_order_relaxed);
+        push_free(index_of(correlation_id));
+        return true;
+    }
+    
+    /**
+     * @brief correlation_id 是否由上下文表分配
+     */
+    static bool owns(uint64_t correlation_id) {
+        return (correlation_id & kTableIdFlag) != 0;
+    }
+    
+    /**
+     * @brief 获取槽位数量
+     */
+    size_t capacity() const { return capacity_; }
+    
+    /**
+     * @brief 获取正在使用的槽位数量（近似）
+     */
+    size_t in_use() const { return in_use_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t kNil = 0xFFFFFFFFu;
+    
+    /**
+     * @brief 槽位（独占缓存行，避免相邻槽位伪共享）
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> generation;   ///< 当前代数
+        std::atomic<uint32_t> next_free;    ///< 空闲栈中的下一个槽位
+        CrossShardContext context;          ///< 跨分片上下文
+    };
+    
+    static uint64_t make_id(uint32_t index, uint32_t generation) {
+        return kTableIdFlag | (uint64_t(generation & kGenerationMask) << 32) | index;
+    }
+    
+    static uint32_t index_of(uint64_t correlation_id) {
+        return static_cast<uint32_t>(correlation_id);
+    }
+    
+    static uint32_t generation_of(uint64_t correlation_id) {
+        return static_cast<uint32_t>(correlation_id >> 32) & kGenerationMask;
+    }
+    
+    static uint64_t pack(uint32_t tag, uint32_t index) {
+        return (uint64_t(tag) << 32) | index;
+    }
+    
+    const Slot* lookup(uint64_t correlation_id) const {
+        if (!owns(correlation_id) || index_of(correlation_id) >= capacity_) {
+            return nullptr;
+        }
+        const Slot& slot = slots_[index_of(correlation_id)];
+        if (slot.generation.load(std::memory_order_acquire) != generation_of(correlation_id)) {
+            return nullptr;
+        }
+        return &slot;
+    }
+    
+    bool pop_free(uint32_t* index) {
+        uint64_t head = free_head_.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t top = static_cast<uint32_t>(head);
+            if (top == kNil) {
+                return false;
+            }
+            uint32_t next = slots_[top].next_free.load(std::memory_order_relaxed);
+            // 标签随每次修改递增，防止ABA
+            uint64_t desired = pack(static_cast<uint32_t>(head >> 32) + 1, next);
+            if (free_head_.compare_exchange_weak(head, desired, std::memory_order_acq_rel)) {
+                *index = top;
+                return true;
+            }
+        }
+    }
+    
+    void push_free(uint32_t index) {
+        uint64_t head = free_head_.load(std::memory_order_relaxed);
+        while (true) {
+            slots_[index].next_free.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            uint64_t desired = pack(static_cast<uint32_t>(head >> 32) + 1, index);
+            if (free_head_.compare_exchange_weak(head, desired, std::memory_order_acq_rel)) {
+                return;
+            }
+        }
+    }
+    
+    const size_t capacity_;                         ///< 槽位数量
+    std::unique_ptr<Slot[]> slots_;                 ///< 槽位数组
+    alignas(64) std::atomic<uint64_t> free_head_;   ///< 空闲栈栈顶（标签 | 下标）
+    std::atomic<size_t> in_use_;                    ///< 正在使用的槽位数量
+};
+
+#endif // BANKING_SYSTEM_TRANSFER_CROSS_SHARD_TABLE_H
@@ -0,0 +1,258 @@
+#ifndef BANKING_SYSTEM_TRANSFER_TRANSFER_BATCH_H
+#define BANKING_SYSTEM_TRANSFER_TRANSFER_BATCH_H
+
+#include "banking_system/common/types.h"
+#include "labs_headers/banking.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ==================== 批量转账消息 ====================
+
+/**
+ * @brief 扩展消息类型（接在 message.h 的 MessageType 之后）
+ */
+enum ExtendedMessageType : int16_t {
+    TRANSFER_BATCH = CS_RELEASE + 1,  ///< 消息携带 TransferBatchHeader + TaggedTransferOrder数组
+    // TRANSFER_BATCH + 1 为 BALANCE_HISTORY_SEGMENT（history_wire.h）
+    ACCOUNT_TRANSFER_BATCH = TRANSFER_BATCH + 2, ///< 消息携带 TransferBatchHeader + TaggedAccountTransfer数组
+    TRANSFER_REJECT = TRANSFER_BATCH + 3         ///< 子进程拒绝的订单，负载布局同 ACCOUNT_TRANSFER_BATCH
+};
+
+/**
+ * @brief 带关联ID的转账订单
+ *
+ * TRANSFER 消息的负载既可以是旧的 TransferOrder（关联ID视为0），
+ * 也可以是 TaggedTransferOrder；目标账户在ACK中回传关联ID。
+ */
+typedef struct {
+    TransferOrder s_order;          ///< 原始订单
+    uint64_t      s_correlation_id; ///< 父进程分配的关联ID
+} __attribute__((packed)) TaggedTransferOrder;
+
+/**
+ * @brief 32位账户ID的转账订单
+ *
+ * 多账户模式下账户ID不再是进程ID，TransferOrder 的 local_id 放不下
+ */
+typedef struct {
+    account_id_t s_src;             ///< 源账户ID
+    account_id_t s_dst;             ///< 目标账户ID
+    balance_t    s_amount;          ///< 金额
+} __attribute__((packed)) AccountTransfer;
+
+/**
+ * @brief 带关联ID的32位账户转账订单
+ */
+typedef struct {
+    AccountTransfer s_order;        ///< 原始订单
+    uint64_t        s_correlation_id; ///< 父进程分配的关联ID
+} __attribute__((packed)) TaggedAccountTransfer;
+
+/**
+ * @brief 批量转账负载头部
+ *
+ * 负载布局：TransferBatchHeader 后紧跟 s_count 个 TaggedTransferOrder
+ */
+typedef struct {
+    uint16_t s_count;               ///< 订单数量
+} __attribute__((packed)) TransferBatchHeader;
+
+/**
+ * @brief 累计ACK负载头部
+ *
+ * 目标账户处理完一个批次后只回复一个ACK，负载布局为
+ * BatchAck 后紧跟 s_count 个 uint64_t 关联ID。
+ * 空负载的ACK表示一笔未打标签的转账（兼容旧格式）。
+ */
+typedef struct {
+    uint16_t s_count;               ///< 本ACK确认的订单数量
+} __attribute__((packed)) BatchAck;
+
+/**
+ * @brief 单条消息最多容纳的订单数量
+ */
+constexpr size_t MAX_BATCH_ORDERS =
+    (MAX_PAYLOAD_LEN - sizeof(TransferBatchHeader)) / sizeof(TaggedTransferOrder);
+
+/**
+ * @brief 单条 ACCOUNT_TRANSFER_BATCH 消息最多容纳的订单数量
+ */
+constexpr size_t MAX_ACCOUNT_BATCH_ORDERS =
+    (MAX_PAYLOAD_LEN - sizeof(TransferBatchHeader)) / sizeof(TaggedAccountTransfer);
+
+static_assert(sizeof(BatchAck) + MAX_BATCH_ORDERS * sizeof(uint64_t) <= MAX_PAYLOAD_LEN,
+              "一个批次的累计ACK必须能放入单条消息");
+static_assert(sizeof(BatchAck) + MAX_ACCOUNT_BATCH_ORDERS * sizeof(uint64_t) <= MAX_PAYLOAD_LEN,
+              "一个32位账户批次的累计ACK必须能放入单条消息");
+
+/**
+ * @brief 填充批量转账消息
+ * @param msg 调用方分配的消息
+ * @param time 时间戳
+ * @param orders 订单数组
+ * @param count 订单数量（不超过MAX_BATCH_ORDERS）
+ */
+inline void fill_transfer_batch(Message* msg, timestamp_t time,
+                                const TaggedTransferOrder* orders, size_t count) {
+    TransferBatchHeader header = {static_cast<uint16_t>(count)};
+    size_t orders_len = count * sizeof(TaggedTransferOrder);
+    fill_message(msg, static_cast<MessageType>(TRANSFER_BATCH), time, nullptr, 0);
+    std::memcpy(msg->s_payload, &header, sizeof(header));
+    std::memcpy(msg->s_payload + sizeof(header), orders, orders_len);
+    msg->s_header.s_payload_len = static_cast<uint16_t>(sizeof(header) + orders_len);
+}
+
+/**
+ * @brief 获取批量消息中的订单数量
+ * @return 负载格式非法时返回0
+ */
+inline size_t transfer_batch_count(const Message* msg) {
+    if (msg->s_header.s_payload_len < sizeof(TransferBatchHeader)) {
+        return 0;
+    }
+    TransferBatchHeader header;
+    std::memcpy(&header, msg->s_payload, sizeof(header));
+    if (sizeof(header) + header.s_count * sizeof(TaggedTransferOrder) >
+        msg->s_header.s_payload_len) {
+        return 0;
+    }
+    return header.s_count;
+}
+
+/**
+ * @brief 获取批量消息中的订单数组
+ */
+inline const TaggedTransferOrder* transfer_batch_orders(const Message* msg) {
+    return reinterpret_cast<const TaggedTransferOrder*>(
+        msg->s_payload + sizeof(TransferBatchHeader));
+}
+
+/**
+ * @brief 填充32位账户的批量转账消息
+ * @param msg 调用方分配的消息
+ * @param time 时间戳
+ * @param orders 订单数组
+ * @param count 订单数量（不超过MAX_ACCOUNT_BATCH_ORDERS）
+ */
+inline void fill_account_transfer_batch(Message* msg, timestamp_t time,
+                                        const TaggedAccountTransfer* orders, size_t count) {
+    TransferBatchHeader header = {static_cast<uint16_t>(count)};
+    size_t orders_len = count * sizeof(TaggedAccountTransfer);
+    fill_message(msg, static_cast<MessageType>(ACCOUNT_TRANSFER_BATCH), time, nullptr, 0);
+    std::memcpy(msg->s_payload, &header, sizeof(header));
+    std::memcpy(msg->s_payload + sizeof(header), orders, orders_len);
+    msg->s_header.s_payload_len = static_cast<uint16_t>(sizeof(header) + orders_len);
+}
+
+/**
+ * @brief 填充拒绝订单消息（NACK）
+ *
+ * 子进程无法执行的订单不能直接丢弃：父进程还在等它们的ACK。
+ * 两种订单格式都按32位账户回传，父进程据此把对应转账按失败完成
+ * @param msg 调用方分配的消息
+ * @param time 时间戳
+ * @param orders 被拒绝的订单
+ * @param count 订单数量（不超过MAX_ACCOUNT_BATCH_ORDERS）
+ */
+inline void fill_transfer_reject(Message* msg, timestamp_t time,
+                                 const TaggedAccountTransfer* orders, size_t count) {
+    fill_account_transfer_batch(msg, time, orders, count);
+    msg->s_header.s_type = TRANSFER_REJECT;
+}
+
+/**
+ * @brief 获取32位账户批量消息（或拒绝订单消息）中的订单数量
+ * @return 负载格式非法时返回0
+ */
+inline size_t account_transfer_batch_count(const Message* msg) {
+    if (msg->s_header.s_payload_len < sizeof(TransferBatchHeader) ||
+        msg->s_header.s_payload_len > MAX_PAYLOAD_LEN) {
+        return 0;
+    }
+    TransferBatchHeader header;
+    std::memcpy(&header, msg->s_payload, sizeof(header));
+    if (sizeof(header) + header.s_count * sizeof(TaggedAccountTransfer) >
+        msg->s_header.s_payload_len) {
+        return 0;
+    }
+    return header.s_count;
+}
+
+/**
+ * @brief 读取32位账户批量消息中的第index个订单
+ */
+inline TaggedAccountTransfer account_transfer_batch_order(const Message* msg, size_t index) {
+    TaggedAccountTransfer order;
+    std::memcpy(&order, msg->s_payload + sizeof(TransferBatchHeader) +
+                            index * sizeof(TaggedAccountTransfer), sizeof(order));
+    return order;
+}
+
+/**
+ * @brief 从TRANSFER消息中解析订单（兼容未打标签的旧格式）
+ * @param msg TRANSFER消息
+ * @param order 输出订单
+ * @return 负载格式合法返回true
+ */
+inline bool read_tagged_order(const Message* msg, TaggedTransferOrder* order) {
+    if (msg->s_header.s_payload_len >= sizeof(TaggedTransferOrder)) {
+        std::memcpy(order, msg->s_payload, sizeof(TaggedTransferOrder));
+        return true;
+    }
+    if (msg->s_header.s_payload_len >= sizeof(TransferOrder)) {
+        std::memcpy(&order->s_order, msg->s_payload, sizeof(TransferOrder));
+        order->s_correlation_id = 0;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 填充累计ACK消息
+ * @param msg 调用方分配的消息
+ * @param time 时间戳
+ * @param correlation_ids 已入账订单的关联ID
+ * @param count 数量（不超过MAX_BATCH_ORDERS）
+ */
+inline void fill_batch_ack(Message* msg, timestamp_t time,
+                           const uint64_t* correlation_ids, size_t count) {
+    BatchAck header = {static_cast<uint16_t>(count)};
+    size_t ids_len = count * sizeof(uint64_t);
+    fill_message(msg, ACK, time, nullptr, 0);
+    std::memcpy(msg->s_payload, &header, sizeof(header));
+    std::memcpy(msg->s_payload + sizeof(header), correlation_ids, ids_len);
+    msg->s_header.s_payload_len = static_cast<uint16_t>(sizeof(header) + ids_len);
+}
+
+/**
+ * @brief 获取ACK确认的订单数量
+ *
+ * 空负载的旧格式ACK计为1笔（关联ID未知）
+ */
+inline size_t ack_count(const Message* msg) {
+    if (msg->s_header.s_payload_len < sizeof(BatchAck)) {
+        return 1;
+    }
+    BatchAck ack;
+    std::memcpy(&ack, msg->s_payload, sizeof(ack));
+    if (sizeof(ack) + ack.s_count * sizeof(uint64_t) > msg->s_header.s_payload_len) {
+        return 0;
+    }
+    return ack.s_count;
+}
+
+/**
+ * @brief 获取ACK中第index个关联ID
+ * @return 旧格式ACK返回0
+ */
+inline uint64_t ack_correlation_id(const Message* msg, size_t index) {
+    if (msg->s_header.s_payload_len < sizeof(BatchAck)) {
+        return 0;
+    }
+    uint64_t id;
+    std::memcpy(&id, msg->s_payload + sizeof(BatchAck) + index * sizeof(uint64_t), sizeof(id));
+    return id;
+}
+
+#endif // BANKING_SYSTEM_TRANSFER_TRANSFER_BATCH_H
@@ -0,0 +1,153 @@
+#ifndef BANKING_SYSTEM_TRANSFER_TRANSFER_HANDLE_H
+#define BANKING_SYSTEM_TRANSFER_TRANSFER_HANDLE_H
+
+#include "banking_system/common/types.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// ==================== 异步转账结果 ====================
+
+/**
+ * @brief 单笔转账的完成结果
+ */
+struct TransferResult {
+    bool success;                       ///< 是否成功入账
+    lamport_time_t commit_time;         ///< 提交时间（目标账户ACK的Lamport时间戳，失败时为0）
+    std::chrono::nanoseconds latency;   ///< 端到端延迟（提交到完成）
+    uint64_t correlation_id;            ///< 关联ID
+};
+
+/**
+ * @brief 转账完成回调
+ * 
+ * 在分片工作线程中调用，应尽快返回，且不能调用阻塞的 submit_transfer
+ */
+using TransferCallback = std::function<void(const TransferResult&)>;
+
+/**
+ * @brief 转账完成状态（TransferHandle 与分片共享）
+ */
+class TransferCompletion {
+public:
+    /**
+     * @brief 构造函数
+     * @param callback 可选的完成回调
+     */
+    explicit TransferCompletion(TransferCallback callback = nullptr)
+        : ready_(false)
+        , result_{false, 0, std::chrono::nanoseconds(0), 0}
+        , callback_(std::move(callback))
+    {}
+    
+    /**
+     * @brief 设置结果并唤醒等待者、调用回调（只生效一次）
+     * @param result 完成结果
+     */
+    void complete(const TransferResult& result) {
+        TransferCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (ready_) return;
+            result_ = result;
+            ready_ = true;
+            callback.swap(callback_);
+        }
+        ready_cv_.notify_all();
+        if (callback) {
+            callback(result);
+        }
+    }
+    
+    /**
+     * @brief 是否已完成
+     */
+    bool ready() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ready_;
+    }
+    
+    /**
+     * @brief 阻塞直到完成
+     */
+    TransferResult wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_cv_.wait(lock, [this] { return ready_; });
+        return result_;
+    }
+    
+    /**
+     * @brief 阻塞直到完成或到达截止时间
+     * @param deadline 截止时间
+     * @param result 输出完成结果
+     * @return 已完成返回true，超时返回false
+     */
+    bool wait_until(std::chrono::steady_clock::time_point deadline, TransferResult* result) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!ready_cv_.wait_until(lock, deadline, [this] { return ready_; })) {
+            return false;
+        }
+        *result = result_;
+        return true;
+    }
+
+private:
+    mutable std::mutex mutex_;              ///< 保护结果的互斥锁
+    std::condition_variable ready_cv_;      ///< 完成通知
+    bool ready_;                            ///< 是否已完成
+    TransferResult result_;                 ///< 完成结果
+    TransferCallback callback_;             ///< 完成回调
+};
+
+/**
+ * @brief 异步转账句柄（类似 std::future，可拷贝）
+ * 
+ * 由 ShardManager::submit_transfer_async 返回
+ */
+class TransferHandle {
+public:
+    TransferHandle() = default;
+    
+    /**
+     * @brief 构造函数
+     * @param state 共享的完成状态
+     */
+    explicit TransferHandle(std::shared_ptr<TransferCompletion> state)
+        : state_(std::move(state))
+    {}
+    
+    /**
+     * @brief 句柄是否关联了一笔转账
+     */
+    bool valid() const { return state_ != nullptr; }
+    
+    /**
+     * @brief 转账是否已完成（不阻塞）
+     */
+    bool ready() const { return state_ != nullptr && state_->ready(); }
+    
+    /**
+     * @brief 阻塞直到转账完成并返回结果
+     */
+    TransferResult get() const { return state_->wait(); }
+    
+    /**
+     * @brief 阻塞直到转账完成或到达截止时间
+     * @param deadline 截止时间
+     * @param result 输出完成结果
+     * @return 已完成返回true，超时返回false
+     */
+    bool wait_until(std::chrono::steady_clock::time_point deadline, 
+                    TransferResult* result) const {
+        return state_->wait_until(deadline, result);
+    }
+
+private:
+    std::shared_ptr<TransferCompletion> state_;     ///< 共享的完成状态
+};
+
+#endif // BANKING_SYSTEM_TRANSFER_TRANSFER_HANDLE_H
@@ -2,7 +2,10 @@
 #define BANKING_SYSTEM_TRANSFER_TRANSFER_TASK_H
 
 #include "banking_system/common/types.h"
+#include "banking_system/transfer/transfer_handle.h"
+#include <chrono>
 #include <cstdint>
+#include <memory>
 
 // ==================== 转账任务定义 ====================
 
@@ -22,14 +25,24 @@ enum class TaskType {
  */
 struct TransferTask {
     TaskType task_type;           ///< 任务类型
-    local_id src_account;         ///< 源账户ID
-    local_id dst_account;         ///< 目标账户ID
+    account_id_t src_account;     ///< 源账户ID
+    account_id_t dst_account;     ///< 目标账户ID
     balance_t amount;             ///< 转账金额
     
     // 跨分片转账协调信息
     uint64_t correlation_id;      ///< 关联ID，用于匹配跨分片的两步操作
     int src_shard_id;             ///< 源分片ID
     int dst_shard_id;             ///< 目标分片ID
+    lamport_time_t causal_time;      ///< 产生该任务时提交方的Lamport时间（分片时钟域据此合并）
+    
+    // 异步完成通知
+    std::chrono::steady_clock::time_point submit_time;  ///< 提交时间（用于计算延迟）
+    std::shared_ptr<TransferCompletion> completion;     ///< 完成状态（同步提交时为空）
+    
+    /**
+     * @brief 默认构造函数（用于预分配的队列槽位）
+     */
+    TransferTask() : TransferTask(0, 0, 0) {}
     
     /**
      * @brief 构造函数：分片内转账
@@ -37,7 +50,7 @@ struct TransferTask {
      * @param dst 目标账户ID
      * @param amt 转账金额
      */
-    TransferTask(local_id src, local_id dst, balance_t amt)
+    TransferTask(account_id_t src, account_id_t dst, balance_t amt)
         : task_type(TaskType::LOCAL_TRANSFER)
         , src_account(src)
         , dst_account(dst)
@@ -45,6 +58,7 @@ struct TransferTask {
         , correlation_id(0)
         , src_shard_id(-1)
         , dst_shard_id(-1)
+        , causal_time(0)
     {}
     
     /**
@@ -57,7 +71,7 @@ struct TransferTask {
      * @param src_shard 源分片ID
      * @param dst_shard 目标分片ID
      */
-    TransferTask(TaskType type, local_id src, local_id dst, balance_t amt,
+    TransferTask(TaskType type, account_id_t src, account_id_t dst, balance_t amt,
                  uint64_t corr_id, int src_shard, int dst_shard)
         : task_type(type)
         , src_account(src)
@@ -66,6 +80,7 @@ struct TransferTask {
         , correlation_id(corr_id)
         , src_shard_id(src_shard)
         , dst_shard_id(dst_shard)
+        , causal_time(0)
     {}
 };
 
@@ -1,18 +1,63 @@
 #include "banking_system/common/clock.h"
 #include <algorithm>
+#include <chrono>
+
+namespace {
+
+// 静态初始化时确定，早于任何fork，子进程共享同一起点
+const std::chrono::steady_clock::time_point kPhysicalEpoch = std::chrono::steady_clock::now();
+
+} // namespace
+
+lamport_time_t steady_physical_time() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - kPhysicalEpoch).count();
+}
 
 LamportClock& LamportClock::instance() {
     static LamportClock instance;
     return instance;
 }
 
-timestamp_t LamportClock::update(timestamp_t received_time) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    time_ = std::max(time_, received_time) + 1;
-    return time_;
+lamport_time_t LamportClock::update(lamport_time_t received_time) {
+    lamport_time_t current = time_.load(std::memory_order_relaxed);
+    lamport_time_t next;
+    if (source_ != TimeSource::HYBRID) {
+        do {
+            next = std::max(current, received_time) + 1;
+        } while (!time_.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed));
+        return next;
+    }
+
+    // 物理时间在CAS循环外读取一次：重试只会让逻辑计数前进，不影响单调性
+    lamport_time_t physical = physical_();
+    lamport_time_t received_l = hlc_physical(received_time);
+    lamport_time_t received_c = hlc_logical(received_time);
+    do {
+        lamport_time_t l = hlc_physical(current);
+        lamport_time_t c = hlc_logical(current);
+        lamport_time_t next_l = std::max({l, received_l, physical});
+        lamport_time_t next_c;
+        if (next_l == l && next_l == received_l) {
+            next_c = std::max(c, received_c) + 1;
+        } else if (next_l == l) {
+            next_c = c + 1;
+        } else if (next_l == received_l) {
+            next_c = received_c + 1;
+        } else {
+            next_c = 0;
+        }
+        next = hlc_pack(next_l, next_c);
+    } while (!time_.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                          std::memory_order_relaxed));
+    return next;
 }
 
-timestamp_t LamportClock::get_time() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return time_;
-}
\ No newline at end of file
+void LamportClock::merge(lamport_time_t other_time) {
+    lamport_time_t current = time_.load(std::memory_order_relaxed);
+    while (current < other_time &&
+           !time_.compare_exchange_weak(current, other_time, std::memory_order_acq_rel,
+                                        std::memory_order_relaxed)) {
+    }
+}
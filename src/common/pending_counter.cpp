@@ -0,0 +1,21 @@
+#include "banking_system/common/pending_counter.h"
+
+void PendingCounter::done(size_t n) {
+    if (count_.fetch_sub(n, std::memory_order_acq_rel) != n) {
+        return;
+    }
+    // 获取一次锁：等待者在持锁检查计数之后才会释放锁进入睡眠，
+    // 因此这里的通知不会丢失
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    zero_cv_.notify_all();
+}
+
+void PendingCounter::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    zero_cv_.wait(lock, [this] { return pending() == 0; });
+}
+
+bool PendingCounter::wait_until(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return zero_cv_.wait_until(lock, deadline, [this] { return pending() == 0; });
+}
@@ -0,0 +1,89 @@
+#include "banking_system/common/prefault.h"
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief 每个线程至少处理的页数，区间太小时不值得启动线程
+ */
+constexpr size_t kMinPagesPerThread = 256;
+
+size_t page_size() {
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? static_cast<size_t>(size) : 4096;
+}
+
+void touch_range(char* begin, char* end, size_t page) {
+    // 从区间所在页的页首开始逐页写入原值，保证每一页都触发写缺页
+    uintptr_t first = reinterpret_cast<uintptr_t>(begin) & ~(page - 1);
+    for (char* p = reinterpret_cast<char*>(first); p < end; p += page) {
+        char* q = std::max(p, begin);
+        *static_cast<volatile char*>(q) = *static_cast<volatile char*>(q);
+    }
+}
+
+/**
+ * @brief 把 [0, items) 均分给若干线程执行 fn(first, last)
+ */
+template <typename Fn>
+void run_parallel(size_t items, size_t pages_per_item, int threads, Fn fn) {
+    if (items == 0) {
+        return;
+    }
+    size_t workers = threads > 0 ? static_cast<size_t>(threads)
+                                 : std::max(1u, std::thread::hardware_concurrency());
+    size_t total_pages = items * std::max<size_t>(pages_per_item, 1);
+    workers = std::min(workers, std::max<size_t>(total_pages / kMinPagesPerThread, 1));
+    workers = std::min(workers, items);
+
+    if (workers <= 1) {
+        fn(0, items);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    size_t per_worker = (items + workers - 1) / workers;
+    for (size_t w = 1; w < workers; ++w) {
+        size_t first = w * per_worker;
+        size_t last = std::min(items, first + per_worker);
+        if (first < last) {
+            pool.emplace_back(fn, first, last);
+        }
+    }
+    fn(0, std::min(items, per_worker));
+    for (std::thread& t : pool) {
+        t.join();
+    }
+}
+
+} // namespace
+
+void prefault_pages(void* base, size_t length, int threads) {
+    size_t page = page_size();
+    char* bytes = static_cast<char*>(base);
+    size_t pages = (length + page - 1) / page;
+
+    // 按页切分，每个线程负责一段连续的页
+    run_parallel(pages, 1, threads, [=](size_t first, size_t last) {
+        char* begin = bytes + first * page;
+        char* end = bytes + std::min(length, last * page);
+        touch_range(begin, end, page);
+    });
+}
+
+void prefault_strided(void* base, size_t count, size_t stride, size_t length, int threads) {
+    size_t page = page_size();
+    char* bytes = static_cast<char*>(base);
+
+    run_parallel(count, (length + page - 1) / page, threads, [=](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            char* begin = bytes + i * stride;
+            touch_range(begin, begin + length, page);
+        }
+    });
+}
@@ -6,23 +6,29 @@ void update_history(BalanceHistory* history,
                    balance_t amount, 
                    balance_t pending_money)
 {
+    // s_history_len 为uint8_t，固定结构最多记录 MAX_T 个状态；
+    // 超出部分丢弃而不是越界写（需要更长历史时使用 ScalableBalanceHistory）
+    const int capacity = MAX_T;
     int last_time = history->s_history[history->s_history_len - 1].s_time;
     int last_balance = history->s_history[history->s_history_len - 1].s_balance;
     
-    for (int i = last_time + 1; i < pending_start_time; i++) {
+    for (int i = last_time + 1; i < pending_start_time && history->s_history_len < capacity; i++) {
         history->s_history[history->s_history_len].s_time = i;
         history->s_history[history->s_history_len].s_balance = last_balance;
         history->s_history[history->s_history_len].s_balance_pending_in = 0;
         history->s_history_len++;
     }
     
-    for (int i = pending_start_time; i < pending_end_time; i++) {
+    for (int i = pending_start_time; i < pending_end_time && history->s_history_len < capacity; i++) {
         history->s_history[history->s_history_len].s_time = i;
         history->s_history[history->s_history_len].s_balance = last_balance;
         history->s_history[history->s_history_len].s_balance_pending_in = pending_money;
         history->s_history_len++;
     }
     
+    if (history->s_history_len >= capacity) {
+        return;
+    }
     history->s_history[history->s_history_len].s_balance = amount;
     history->s_history[history->s_history_len].s_time = pending_end_time;
     history->s_history[history->s_history_len].s_balance_pending_in = 0;
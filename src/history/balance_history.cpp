@@ -0,0 +1,262 @@
+#include "banking_system/history/balance_history.h"
+#include "banking_system/history/history_archive.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+ScalableBalanceHistory::ScalableBalanceHistory(account_id_t id)
+    : id_(id)
+    , size_(0)
+    , end_time_(0)
+    , base_(0)
+    , hot_chunks_(0)
+{
+}
+
+ScalableBalanceHistory::~ScalableBalanceHistory() = default;
+ScalableBalanceHistory::ScalableBalanceHistory(ScalableBalanceHistory&&) = default;
+ScalableBalanceHistory& ScalableBalanceHistory::operator=(ScalableBalanceHistory&&) = default;
+
+bool ScalableBalanceHistory::enable_archive(const std::string& path, size_t hot_chunks) {
+    // 已转储的变化点只在旧段文件中，不能更换
+    if (base_ != 0) {
+        return false;
+    }
+    // 已有的变化点仍在内存中，之后按块转储；段文件推迟到第一次转储时创建
+    archive_.reset();
+    archive_path_ = path;
+    hot_chunks_ = std::max<size_t>(hot_chunks, 2);
+    return true;
+}
+
+WideBalanceState& ScalableBalanceHistory::archived(size_t index) const {
+    return (*archive_)[index];
+}
+
+bool ScalableBalanceHistory::archive_oldest_chunk() {
+    if (!archive_) {
+        std::unique_ptr<HistoryArchive> archive(new HistoryArchive());
+        if (!archive->open(archive_path_, id_, true)) {
+            hot_chunks_ = 0;
+            return false;
+        }
+        archive_ = std::move(archive);
+    }
+    if (!archive_->append(chunks_[0].states.get(), kChunkStates)) {
+        hot_chunks_ = 0;
+        return false;
+    }
+    // 把腾出的块移到末尾复用
+    std::rotate(chunks_.begin(), chunks_.begin() + 1, chunks_.end());
+    base_ += kChunkStates;
+    return true;
+}
+
+void ScalableBalanceHistory::reset(account_id_t id, balance_t initial_balance) {
+    clear(id);
+    push_back({0, initial_balance, 0});
+}
+
+void ScalableBalanceHistory::clear(account_id_t id) {
+    id_ = id;
+    size_ = 0;
+    end_time_ = 0;
+    base_ = 0;
+    if (archive_) {
+        archive_->reset(id);
+    }
+}
+
+void ScalableBalanceHistory::record(lamport_time_t time, balance_t balance,
+                                    balance_t pending_in) {
+    if (empty()) {
+        push_back({time, balance, pending_in});
+        return;
+    }
+    time = std::max(time, end_time_);
+
+    WideBalanceState& last = back();
+    if (last.s_balance == balance && last.s_balance_pending_in == pending_in) {
+        end_time_ = time;
+        return;
+    }
+    if (last.s_time == time) {
+        last.s_balance = balance;
+        last.s_balance_pending_in = pending_in;
+        // 覆盖后可能与前一个变化点相同，此时它不再是变化点
+        if (size_ > 1) {
+            const WideBalanceState& prev = (*this)[size_ - 2];
+            if (prev.s_balance == balance && prev.s_balance_pending_in == pending_in) {
+                --size_;
+            }
+        }
+        return;
+    }
+    push_back({time, balance, pending_in});
+}
+
+void ScalableBalanceHistory::push_back(const WideBalanceState& state) {
+    size_t chunk = (size_ - base_) / kChunkStates;
+    size_t offset = (size_ - base_) % kChunkStates;
+    if (hot_chunks_ != 0 && chunk == hot_chunks_ && archive_oldest_chunk()) {
+        --chunk;
+    }
+    if (chunk == chunks_.size()) {
+        size_t capacity = chunks_.empty() ? kInitialChunkStates : kChunkStates;
+        chunks_.push_back({std::unique_ptr<WideBalanceState[]>(new WideBalanceState[capacity]),
+                           capacity});
+    } else if (offset == chunks_[chunk].capacity) {
+        // 未满一整块的块按倍数扩容，只有这一块需要拷贝
+        Chunk& grow = chunks_[chunk];
+        size_t capacity = std::min(grow.capacity * 2, kChunkStates);
+        std::unique_ptr<WideBalanceState[]> states(new WideBalanceState[capacity]);
+        std::copy(grow.states.get(), grow.states.get() + offset, states.get());
+        grow.states = std::move(states);
+        grow.capacity = capacity;
+    }
+    chunks_[chunk].states[offset] = state;
+    ++size_;
+    end_time_ = std::max(end_time_, state.s_time);
+}
+
+size_t ScalableBalanceHistory::raise_pending(lamport_time_t from, balance_t amount) {
+    if (empty() || amount == 0 || from > end_time_) {
+        return size_;
+    }
+    size_t first = upper_bound(from);
+    if (first != 0 && (*this)[first - 1].s_time == from) {
+        --first;
+    } else {
+        // from 落在两个变化点之间：复制前一个状态作为 from 处的新变化点，
+        // 后面的变化点整体后移一位
+        WideBalanceState split = first == 0 ? WideBalanceState{from, 0, 0} : (*this)[first - 1];
+        split.s_time = from;
+        WideBalanceState last = back();
+        push_back(last);
+        for (size_t i = size_ - 2; i > first; --i) {
+            (*this)[i] = (*this)[i - 1];
+        }
+        (*this)[first] = split;
+    }
+    for (size_t i = first; i < size_; ++i) {
+        (*this)[i].s_balance_pending_in += amount;
+    }
+    return first;
+}
+
+bool ScalableBalanceHistory::truncate(size_t count) {
+    if (count >= size_) {
+        return true;
+    }
+    if (count < base_) {
+        return false;
+    }
+    size_ = count;
+    end_time_ = empty() ? 0 : back().s_time;
+    return true;
+}
+
+size_t ScalableBalanceHistory::upper_bound(lamport_time_t time) const {
+    size_t low = 0;
+    size_t high = size_;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if ((*this)[mid].s_time <= time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+WideBalanceState ScalableBalanceHistory::state_at(lamport_time_t time) const {
+    size_t next = upper_bound(time);
+    if (next == 0) {
+        return {time, 0, 0};
+    }
+    WideBalanceState state = (*this)[next - 1];
+    state.s_time = time;
+    return state;
+}
+
+void ScalableBalanceHistory::expand(lamport_time_t first, size_t count,
+                                    WideBalanceState* out) const {
+    size_t next = upper_bound(first);
+    WideBalanceState current = next == 0 ? WideBalanceState{first, 0, 0} : (*this)[next - 1];
+    for (size_t i = 0; i < count; ++i) {
+        lamport_time_t time = first + static_cast<lamport_time_t>(i);
+        while (next < size_ && (*this)[next].s_time <= time) {
+            current = (*this)[next++];
+        }
+        out[i] = current;
+        out[i].s_time = time;
+    }
+}
+
+void ScalableBalanceHistory::expand_soa(lamport_time_t first, size_t count,
+                                        balance_t* balances, balance_t* pending_in) const {
+    size_t next = upper_bound(first);
+    balance_t balance = next == 0 ? 0 : (*this)[next - 1].s_balance;
+    balance_t pending = next == 0 ? 0 : (*this)[next - 1].s_balance_pending_in;
+    size_t i = 0;
+    // 按变化点分段填充：两个变化点之间是同一个值
+    while (i < count) {
+        size_t run_end = count;
+        if (next < size_) {
+            lamport_time_t change = (*this)[next].s_time;
+            run_end = static_cast<size_t>(std::min<lamport_time_t>(
+                std::max<lamport_time_t>(change - first, static_cast<lamport_time_t>(i)),
+                static_cast<lamport_time_t>(count)));
+        }
+        std::fill(balances + i, balances + run_end, balance);
+        std::fill(pending_in + i, pending_in + run_end, pending);
+        i = run_end;
+        if (i < count && next < size_) {
+            balance = (*this)[next].s_balance;
+            pending = (*this)[next].s_balance_pending_in;
+            ++next;
+        }
+    }
+}
+
+void ScalableBalanceHistory::to_legacy(BalanceHistory* out) const {
+    size_t count = std::min<size_t>(dense_size(), UINT8_MAX);
+    std::memset(out, 0, sizeof(*out));
+    out->s_id = static_cast<local_id>(id_);
+    out->s_history_len = static_cast<uint8_t>(count);
+
+    WideBalanceState dense[UINT8_MAX];
+    expand(0, count, dense);
+    for (size_t i = 0; i < count; ++i) {
+        out->s_history[i].s_time = static_cast<timestamp_t>(dense[i].s_time);
+        out->s_history[i].s_balance = dense[i].s_balance;
+        out->s_history[i].s_balance_pending_in = dense[i].s_balance_pending_in;
+    }
+}
+
+size_t update_history(ScalableBalanceHistory* history,
+                      lamport_time_t pending_start_time,
+                      lamport_time_t pending_end_time,
+                      balance_t amount,
+                      balance_t pending_money)
+{
+    lamport_time_t last_time = history->end_time();
+    balance_t last_balance = now_balance(history);
+    size_t modified = history->size() - 1;
+
+    // 发送时间早于上次记录的时刻：钱在 [pending_start_time, last_time] 内已离开源账户，
+    // 这段时间里已记录的变化点都要计入在途金额，否则这些时刻的总额会少算
+    if (pending_money != 0 && pending_start_time <= last_time) {
+        modified = std::min(modified, history->raise_pending(pending_start_time, pending_money));
+    }
+
+    lamport_time_t start = std::max(pending_start_time, last_time + 1);
+    if (start < pending_end_time) {
+        history->record(start, last_balance, pending_money);
+    }
+
+    // 与上次记录同一时刻（或更早）的事件只修正该时刻的最终余额
+    history->record(std::max(pending_end_time, last_time), amount, 0);
+    return std::min(modified, history->size() - 1);
+}
@@ -0,0 +1,241 @@
+#include "banking_system/history/history_aggregator.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BANKING_HISTORY_HAVE_AVX2 1
+#endif
+
+namespace {
+
+// ==================== 标量内核 ====================
+
+void accumulate_scalar(const balance_t* src, int32_t* acc, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        acc[i] += src[i];
+    }
+}
+
+size_t check_scalar(const int32_t* balance, const int32_t* pending, size_t count,
+                    int32_t expected, uint32_t* bad) {
+    size_t found = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (balance[i] + pending[i] != expected) {
+            bad[found++] = static_cast<uint32_t>(i);
+        }
+    }
+    return found;
+}
+
+// ==================== AVX2内核 ====================
+
+#ifdef BANKING_HISTORY_HAVE_AVX2
+
+__attribute__((target("avx2")))
+void accumulate_avx2(const balance_t* src, int32_t* acc, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        __m256i hi = _mm256_cvtepi16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)));
+        __m256i* out_lo = reinterpret_cast<__m256i*>(acc + i);
+        __m256i* out_hi = reinterpret_cast<__m256i*>(acc + i + 8);
+        _mm256_storeu_si256(out_lo, _mm256_add_epi32(_mm256_loadu_si256(out_lo), lo));
+        _mm256_storeu_si256(out_hi, _mm256_add_epi32(_mm256_loadu_si256(out_hi), hi));
+    }
+    accumulate_scalar(src + i, acc + i, count - i);
+}
+
+__attribute__((target("avx2")))
+size_t check_avx2(const int32_t* balance, const int32_t* pending, size_t count,
+                  int32_t expected, uint32_t* bad) {
+    const __m256i want = _mm256_set1_epi32(expected);
+    size_t found = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i sum = _mm256_add_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(balance + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pending + i)));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(sum, want)));
+        if (mask != 0xFF) {
+            // 只有出现违例的8个时刻才逐个检查
+            for (size_t j = 0; j < 8; ++j) {
+                if (!(mask & (1 << j))) {
+                    bad[found++] = static_cast<uint32_t>(i + j);
+                }
+            }
+        }
+    }
+    size_t tail = check_scalar(balance + i, pending + i, count - i, expected, bad + found);
+    for (size_t j = 0; j < tail; ++j) {
+        bad[found + j] += static_cast<uint32_t>(i);
+    }
+    return found + tail;
+}
+
+#endif
+
+bool detect_avx2() {
+#ifdef BANKING_HISTORY_HAVE_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+HistoryAggregator::HistoryAggregator(std::vector<const ScalableBalanceHistory*> histories)
+    : histories_(std::move(histories))
+    , end_time_(0)
+    , expected_total_(0)
+    , violation_count_(0)
+{
+}
+
+bool HistoryAggregator::simd_enabled() {
+    static const bool enabled = detect_avx2();
+    return enabled;
+}
+
+void HistoryAggregator::run() {
+    auto accumulate = accumulate_scalar;
+    auto check = check_scalar;
+#ifdef BANKING_HISTORY_HAVE_AVX2
+    if (simd_enabled()) {
+        accumulate = accumulate_avx2;
+        check = check_avx2;
+    }
+#endif
+
+    bool any = false;
+    end_time_ = 0;
+    expected_total_ = 0;
+    for (const ScalableBalanceHistory* history : histories_) {
+        if (!history->empty()) {
+            any = true;
+            end_time_ = std::max(end_time_, history->end_time());
+            expected_total_ += history->state_at(0).s_balance;
+        }
+    }
+
+    size_t ticks = any ? static_cast<size_t>(end_time_) + 1 : 0;
+    total_balance_.assign(ticks, 0);
+    total_pending_.assign(ticks, 0);
+    violation_count_ = 0;
+    violations_.clear();
+
+    std::vector<balance_t> balances(kTileTicks);
+    std::vector<balance_t> pending(kTileTicks);
+    std::vector<uint32_t> bad(kTileTicks);
+    for (size_t first = 0; first < ticks; first += kTileTicks) {
+        size_t count = std::min(kTileTicks, ticks - first);
+        int32_t* tile_balance = total_balance_.data() + first;
+        int32_t* tile_pending = total_pending_.data() + first;
+        for (const ScalableBalanceHistory* history : histories_) {
+            history->expand_soa(static_cast<lamport_time_t>(first), count,
+                                balances.data(), pending.data());
+            accumulate(balances.data(), tile_balance, count);
+            accumulate(pending.data(), tile_pending, count);
+        }
+
+        size_t found = check(tile_balance, tile_pending, count,
+                             static_cast<int32_t>(expected_total_), bad.data());
+        violation_count_ += found;
+        for (size_t i = 0; i < found && violations_.size() < kMaxReportedViolations; ++i) {
+            violations_.push_back(static_cast<lamport_time_t>(first + bad[i]));
+        }
+    }
+}
+
+void HistoryAggregator::print_table(std::ostream& out, size_t max_ticks) const {
+    size_t ticks = total_balance_.size();
+    size_t shown = std::min(ticks, max_ticks);
+    size_t listed = std::min(histories_.size(), kMaxTableAccounts);
+    char cell[32];
+
+    out << "Full balance history for time range [0;" << end_time_ << "]:\n";
+    out << "|   Time |";
+    for (size_t i = 0; i < listed; ++i) {
+        std::snprintf(cell, sizeof(cell), " %6d |", static_cast<int>(histories_[i]->id()));
+        out << cell;
+    }
+    out << "  Total | Pending |\n";
+
+    std::vector<WideBalanceState> column(shown);
+    std::vector<std::vector<WideBalanceState>> columns;
+    columns.reserve(listed);
+    for (size_t i = 0; i < listed; ++i) {
+        histories_[i]->expand(0, shown, column.data());
+        columns.push_back(column);
+    }
+    for (size_t t = 0; t < shown; ++t) {
+        std::snprintf(cell, sizeof(cell), "| %6zu |", t);
+        out << cell;
+        for (const auto& states : columns) {
+            std::snprintf(cell, sizeof(cell), " %6d |", static_cast<int>(states[t].s_balance));
+            out << cell;
+        }
+        std::snprintf(cell, sizeof(cell), " %6d | %7d |\n", total_balance_[t], total_pending_[t]);
+        out << cell;
+    }
+    if (shown < ticks) {
+        out << "... 其余 " << ticks - shown << " 个时刻见JSON报告\n";
+    }
+    if (listed < histories_.size()) {
+        out << "... 其余 " << histories_.size() - listed << " 个账户只计入合计列\n";
+    }
+    if (conserved()) {
+        out << "资金守恒: 每个时刻 总余额 + 总在途 = " << expected_total_ << "\n";
+    } else {
+        out << "✗ 资金不守恒: " << violation_count_ << " 个时刻 总余额 + 总在途 != "
+            << expected_total_ << "\n";
+    }
+    out.flush();
+}
+
+void HistoryAggregator::write_report(std::ostream& out) const {
+    out << "{\n";
+    out << "  \"accounts\": " << histories_.size() << ",\n";
+    out << "  \"end_time\": " << end_time_ << ",\n";
+    out << "  \"ticks\": " << total_balance_.size() << ",\n";
+    out << "  \"kernel\": \"" << (simd_enabled() ? "avx2" : "scalar") << "\",\n";
+    out << "  \"expected_total\": " << expected_total_ << ",\n";
+    out << "  \"conserved\": " << (conserved() ? "true" : "false") << ",\n";
+    out << "  \"violation_count\": " << violation_count_ << ",\n";
+    out << "  \"violations\": [";
+    for (size_t i = 0; i < violations_.size(); ++i) {
+        out << (i ? ", " : "") << violations_[i];
+    }
+    out << "],\n";
+
+    out << "  \"account_histories\": [";
+    for (size_t i = 0; i < histories_.size(); ++i) {
+        const ScalableBalanceHistory* history = histories_[i];
+        out << (i ? ",\n" : "\n") << "    {\"id\": " << static_cast<int>(history->id())
+            << ", \"change_points\": " << history->size()
+            << ", \"end_time\": " << history->end_time()
+            << ", \"final_balance\": " << (history->empty() ? 0 : now_balance(history)) << "}";
+    }
+    out << "\n  ],\n";
+
+    // 总额序列只输出变化点，与历史本身的表示一致
+    out << "  \"totals\": [";
+    bool first = true;
+    for (size_t t = 0; t < total_balance_.size(); ++t) {
+        if (t > 0 && total_balance_[t] == total_balance_[t - 1] &&
+            total_pending_[t] == total_pending_[t - 1]) {
+            continue;
+        }
+        out << (first ? "\n" : ",\n") << "    {\"time\": " << t
+            << ", \"balance\": " << total_balance_[t]
+            << ", \"pending_in\": " << total_pending_[t] << "}";
+        first = false;
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+    out.flush();
+}
@@ -0,0 +1,140 @@
+#include "banking_system/history/history_archive.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief 初始映射大小（之后按倍数扩展）
+ */
+constexpr size_t kInitialMapBytes = 1 << 20;
+
+std::string g_archive_directory;    ///< 临时段文件目录（为空时使用 $TMPDIR）
+
+} // namespace
+
+void HistoryArchive::set_directory(const std::string& directory) {
+    g_archive_directory = directory;
+}
+
+std::string HistoryArchive::temp_path(account_id_t id) {
+    std::string directory = g_archive_directory;
+    if (directory.empty()) {
+        const char* tmpdir = std::getenv("TMPDIR");
+        directory = tmpdir != nullptr && tmpdir[0] != '\0' ? tmpdir : "/tmp";
+    }
+    return directory + "/balance_history_" + std::to_string(getpid()) + "_" +
+           std::to_string(id) + ".seg";
+}
+
+HistoryArchive::HistoryArchive()
+    : fd_(-1)
+    , map_(nullptr)
+    , map_bytes_(0)
+    , count_(0)
+    , temporary_(false)
+{
+}
+
+HistoryArchive::~HistoryArchive() {
+    close();
+}
+
+bool HistoryArchive::open(const std::string& path, account_id_t id, bool temporary) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "错误: 无法创建历史段文件 " << path << " (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, kInitialMapBytes) != 0) {
+        std::cerr << "错误: 无法扩展历史段文件 " << path << " (" << std::strerror(errno) << ")" << std::endl;
+        ::close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, kInitialMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "错误: 历史段文件映射失败 (" << std::strerror(errno) << ")" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    map_ = static_cast<char*>(base);
+    map_bytes_ = kInitialMapBytes;
+    path_ = path;
+    temporary_ = temporary;
+    reset(id);
+    return true;
+}
+
+void HistoryArchive::close() {
+    if (map_ != nullptr) {
+        munmap(map_, map_bytes_);
+        if (temporary_) {
+            unlink(path_.c_str());
+        } else if (ftruncate(fd_, sizeof(HistoryArchiveHeader) +
+                                  count_ * sizeof(WideBalanceState)) != 0) {
+            // 截掉预留的空间，文件只保留头部和已写入的状态
+            std::cerr << "警告: 历史段文件截断失败 (" << std::strerror(errno) << ")" << std::endl;
+        }
+        ::close(fd_);
+    }
+    fd_ = -1;
+    map_ = nullptr;
+    map_bytes_ = 0;
+    count_ = 0;
+}
+
+void HistoryArchive::reset(account_id_t id) {
+    if (map_ == nullptr) {
+        return;
+    }
+    HistoryArchiveHeader* h = header();
+    h->s_magic = kArchiveMagic;
+    h->s_version = kArchiveVersion;
+    h->s_state_size = sizeof(WideBalanceState);
+    h->s_id = id;
+    h->s_reserved = 0;
+    h->s_count = 0;
+    count_ = 0;
+}
+
+bool HistoryArchive::reserve(size_t states) {
+    size_t needed = sizeof(HistoryArchiveHeader) + states * sizeof(WideBalanceState);
+    if (needed <= map_bytes_) {
+        return true;
+    }
+    size_t bytes = map_bytes_;
+    while (bytes < needed) {
+        bytes *= 2;
+    }
+    if (ftruncate(fd_, bytes) != 0) {
+        std::cerr << "错误: 无法扩展历史段文件 " << path_ << " (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+    void* base = mremap(map_, map_bytes_, bytes, MREMAP_MAYMOVE);
+    if (base == MAP_FAILED) {
+        std::cerr << "错误: 历史段文件重新映射失败 (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+    map_ = static_cast<char*>(base);
+    map_bytes_ = bytes;
+    return true;
+}
+
+bool HistoryArchive::append(const WideBalanceState* states, size_t count) {
+    if (map_ == nullptr || !reserve(count_ + count)) {
+        return false;
+    }
+    std::memcpy(this->states() + count_, states, count * sizeof(WideBalanceState));
+    count_ += count;
+    header()->s_count = count_;
+    return true;
+}
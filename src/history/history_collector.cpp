@@ -0,0 +1,185 @@
+#include "banking_system/history/history_collector.h"
+#include "banking_system/history/history_wire.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+HistoryCollector::HistoryCollector(int accounts, int decode_threads)
+    : HistoryCollector(AccountDirectory(static_cast<account_id_t>(accounts), accounts),
+                       decode_threads)
+{
+}
+
+HistoryCollector::HistoryCollector(const AccountDirectory& directory, int decode_threads)
+    : directory_(directory)
+    , complete_(directory.accounts(), 0)
+    , complete_count_(0)
+    , generation_(0)
+    , pool_stop_(false)
+    , groups_(MAX_PROCESS_ID + 1)
+    , rejected_(0)
+{
+    histories_.reserve(directory.accounts());
+    for (account_id_t i = 1; i <= directory.accounts(); ++i) {
+        histories_.emplace_back(i);
+    }
+
+    int threads = std::min(decode_threads, directory.workers());
+    if (threads > 1) {
+        for (int i = 0; i < threads; ++i) {
+            workers_.emplace_back(&HistoryCollector::decode_worker, this, static_cast<size_t>(i));
+        }
+    }
+}
+
+HistoryCollector::~HistoryCollector() {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        pool_stop_ = true;
+    }
+    pool_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+bool HistoryCollector::is_history_message(const Message& msg) {
+    return msg.s_header.s_magic == MESSAGE_MAGIC &&
+           (msg.s_header.s_type == BALANCE_HISTORY ||
+            msg.s_header.s_type == BALANCE_HISTORY_SEGMENT);
+}
+
+bool HistoryCollector::complete(account_id_t account) const {
+    return directory_.contains(account) && complete_[account - 1];
+}
+
+void HistoryCollector::mark_complete(size_t index) {
+    complete_[index] = 1;
+    complete_count_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+bool HistoryCollector::apply(local_id from, const Message& msg) {
+    if (from < 1 || from > MAX_PROCESS_ID || !is_history_message(msg) ||
+        msg.s_header.s_payload_len > MAX_PAYLOAD_LEN) {
+        return false;
+    }
+
+    if (msg.s_header.s_type == BALANCE_HISTORY) {
+        // 旧格式：一次性发送整段固定结构，账户即发送方，负载至少要覆盖它声明的状态数
+        account_id_t account = static_cast<account_id_t>(from);
+        const size_t header_len = offsetof(BalanceHistory, s_history);
+        if (!directory_.contains(account) || directory_.worker_of(account) != from ||
+            complete_[account - 1] || msg.s_header.s_payload_len < header_len) {
+            return false;
+        }
+        BalanceHistory legacy;
+        std::memcpy(&legacy, msg.s_payload, header_len);
+        size_t states_len = legacy.s_history_len * sizeof(BalanceState);
+        if (header_len + states_len > msg.s_header.s_payload_len) {
+            return false;
+        }
+        std::memcpy(legacy.s_history, msg.s_payload + header_len, states_len);
+        // 逐时刻状态压缩为变化点，之后与分段格式统一处理
+        ScalableBalanceHistory& history = histories_[account - 1];
+        history.clear(account);
+        for (size_t i = 0; i < legacy.s_history_len; ++i) {
+            const BalanceState& state = legacy.s_history[i];
+            history.record(state.s_time, state.s_balance, state.s_balance_pending_in);
+        }
+        mark_complete(account - 1);
+        return true;
+    }
+
+    // 分段格式：账户ID取自头部，必须由发送方托管
+    if (msg.s_header.s_payload_len < sizeof(HistorySegmentHeader)) {
+        return false;
+    }
+    HistorySegmentHeader header;
+    std::memcpy(&header, msg.s_payload, sizeof(header));
+    account_id_t account = header.s_id;
+    if (!directory_.contains(account) || directory_.worker_of(account) != from ||
+        complete_[account - 1]) {
+        return false;
+    }
+    bool last = false;
+    if (!read_history_segment(&msg, &histories_[account - 1], &last)) {
+        return false;
+    }
+    if (last) {
+        mark_complete(account - 1);
+    }
+    return true;
+}
+
+size_t HistoryCollector::apply_batch(const local_id* senders, const Message* msgs, size_t count) {
+    size_t groups = 0;
+    size_t rejected = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!is_history_message(msgs[i])) {
+            continue;
+        }
+        local_id from = senders[i];
+        if (from < 1 || from > MAX_PROCESS_ID) {
+            ++rejected;
+            continue;
+        }
+        std::vector<const Message*>& group = groups_[from];
+        if (group.empty()) {
+            ++groups;
+        }
+        group.push_back(&msgs[i]);
+    }
+
+    rejected_.store(0, std::memory_order_relaxed);
+    if (workers_.empty() || groups <= 1) {
+        for (size_t index = 0; index < groups_.size(); ++index) {
+            decode_group(index);
+        }
+    } else {
+        batch_pending_.add(workers_.size());
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            ++generation_;
+        }
+        pool_cv_.notify_all();
+        batch_pending_.wait();
+    }
+    return rejected + rejected_.load(std::memory_order_relaxed);
+}
+
+void HistoryCollector::decode_worker(size_t worker) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex_);
+            pool_cv_.wait(lock, [&] { return pool_stop_ || generation_ != seen; });
+            if (pool_stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+        for (size_t index = worker; index < groups_.size(); index += workers_.size()) {
+            decode_group(index);
+        }
+        batch_pending_.done();
+    }
+}
+
+void HistoryCollector::decode_group(size_t sender) {
+    std::vector<const Message*>& group = groups_[sender];
+    local_id from = static_cast<local_id>(sender);
+    for (const Message* msg : group) {
+        if (!apply(from, *msg)) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    group.clear();
+}
+
+void HistoryCollector::to_all_history(AllHistory* out) const {
+    size_t count = std::min<size_t>(histories_.size(), MAX_PROCESS_ID + 1);
+    out->s_history_len = static_cast<uint8_t>(count);
+    for (size_t i = 0; i < count; ++i) {
+        histories_[i].to_legacy(&out->s_history[i]);
+    }
+}
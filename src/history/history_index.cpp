@@ -0,0 +1,101 @@
+#include "banking_system/history/history_index.h"
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief k路归并中某个账户的读取位置
+ */
+struct MergeCursor {
+    lamport_time_t time;    ///< 下一个变化点的时刻
+    size_t history;         ///< 账户在输入数组中的下标
+    size_t next;            ///< 下一个变化点的下标
+};
+
+/**
+ * @brief 小顶堆比较：时刻早的先出堆
+ */
+struct LaterCursor {
+    bool operator()(const MergeCursor& a, const MergeCursor& b) const {
+        return a.time > b.time;
+    }
+};
+
+} // namespace
+
+HistoryIndex::HistoryIndex(const std::vector<const ScalableBalanceHistory*>& histories) {
+    size_t points = 0;
+    for (const ScalableBalanceHistory* history : histories) {
+        size_t id = static_cast<size_t>(history->id());
+        if (id >= by_id_.size()) {
+            by_id_.resize(id + 1, nullptr);
+        }
+        by_id_[id] = history;
+        points += history->size();
+    }
+    times_.reserve(points);
+    total_balance_.reserve(points);
+    total_pending_.reserve(points);
+
+    // 各账户的变化点已按时间排序：用小顶堆做k路归并，O(n log k)，不需要整体排序
+    std::vector<MergeCursor> heap;
+    heap.reserve(histories.size());
+    for (size_t i = 0; i < histories.size(); ++i) {
+        if (!histories[i]->empty()) {
+            heap.push_back({(*histories[i])[0].s_time, i, 0});
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), LaterCursor());
+
+    // 每个变化点换算成相对本账户前一个变化点的增量，累加为前缀和，同一时刻合并为一项
+    std::vector<balance_t> last_balance(histories.size(), 0);
+    std::vector<balance_t> last_pending(histories.size(), 0);
+    int64_t balance = 0;
+    int64_t pending = 0;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), LaterCursor());
+        MergeCursor& cursor = heap.back();
+        const ScalableBalanceHistory& history = *histories[cursor.history];
+        const WideBalanceState& state = history[cursor.next];
+
+        balance += state.s_balance - last_balance[cursor.history];
+        pending += state.s_balance_pending_in - last_pending[cursor.history];
+        last_balance[cursor.history] = state.s_balance;
+        last_pending[cursor.history] = state.s_balance_pending_in;
+        if (!times_.empty() && times_.back() == state.s_time) {
+            total_balance_.back() = balance;
+            total_pending_.back() = pending;
+        } else {
+            times_.push_back(state.s_time);
+            total_balance_.push_back(balance);
+            total_pending_.push_back(pending);
+        }
+
+        if (++cursor.next < history.size()) {
+            cursor.time = history[cursor.next].s_time;
+            std::push_heap(heap.begin(), heap.end(), LaterCursor());
+        } else {
+            heap.pop_back();
+        }
+    }
+}
+WideBalanceState HistoryIndex::state_at(account_id_t account, lamport_time_t time) const {
+    if (account >= by_id_.size() || !by_id_[account]) {
+        return {time, 0, 0};
+    }
+    return by_id_[account]->state_at(time);
+}
+
+size_t HistoryIndex::upper_bound(lamport_time_t time) const {
+    return static_cast<size_t>(std::upper_bound(times_.begin(), times_.end(), time) - times_.begin());
+}
+
+int64_t HistoryIndex::total_at(lamport_time_t time) const {
+    size_t next = upper_bound(time);
+    return next == 0 ? 0 : total_balance_[next - 1];
+}
+
+int64_t HistoryIndex::pending_in_at(lamport_time_t time) const {
+    size_t next = upper_bound(time);
+    return next == 0 ? 0 : total_pending_[next - 1];
+}
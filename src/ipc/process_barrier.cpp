@@ -0,0 +1,204 @@
+#include "banking_system/ipc/process_barrier.h"
+#include "banking_system/ipc/futex.h"
+#include "banking_system/ipc/spanning_tree.h"
+#include "banking_system/common/clock.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kCacheLine = 64;
+
+} // namespace
+
+// ==================== 共享段内部布局 ====================
+
+struct ProcessBarrier::SharedState {
+    alignas(kCacheLine) std::atomic<uint32_t> arrived;  ///< 本轮已到达的进程数
+    alignas(kCacheLine) std::atomic<uint32_t> sense;    ///< 全局感应位（futex字）
+    uint32_t count_nodes;                               ///< 参与进程数
+};
+
+// ==================== 生命周期 ====================
+
+ProcessBarrier& ProcessBarrier::instance() {
+    static ProcessBarrier instance;
+    return instance;
+}
+
+ProcessBarrier::~ProcessBarrier() {
+    destroy();
+}
+
+bool ProcessBarrier::create_shared(int count_nodes) {
+    if (count_nodes < 1) {
+        std::cerr << "错误: 无效的屏障进程数 " << count_nodes << std::endl;
+        return false;
+    }
+
+    destroy();
+
+    void* base = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "错误: 共享屏障映射失败 (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    shared_ = new (base) SharedState();
+    shared_->arrived.store(0, std::memory_order_relaxed);
+    shared_->sense.store(0, std::memory_order_relaxed);
+    shared_->count_nodes = static_cast<uint32_t>(count_nodes);
+    local_sense_ = 0;
+    return true;
+}
+
+void ProcessBarrier::destroy() {
+    if (shared_ != nullptr) {
+        munmap(shared_, sizeof(SharedState));
+    }
+    shared_ = nullptr;
+}
+
+const char* ProcessBarrier::name(BarrierAlgorithm algorithm) {
+    switch (algorithm) {
+        case BarrierAlgorithm::ALL_TO_ALL:    return "all-to-all";
+        case BarrierAlgorithm::DISSEMINATION: return "dissemination";
+        case BarrierAlgorithm::TREE:          return "tree";
+        case BarrierAlgorithm::SHARED_MEMORY: return "shm";
+    }
+    return "unknown";
+}
+
+// ==================== 屏障 ====================
+
+bool ProcessBarrier::wait(local_id self, int count_nodes, MessageType type,
+                          const char* payload, size_t payload_len) {
+    if (count_nodes <= 1) {
+        return true;
+    }
+
+    if (algorithm_ == BarrierAlgorithm::SHARED_MEMORY) {
+        if (shared_ != nullptr && shared_->count_nodes == static_cast<uint32_t>(count_nodes)) {
+            return wait_shared(count_nodes);
+        }
+        std::cerr << "警告: 共享屏障未创建，改用传播屏障" << std::endl;
+    }
+
+    Message msg;
+    fill_message(&msg, type, 0, const_cast<char*>(payload), payload_len);
+
+    switch (algorithm_) {
+        case BarrierAlgorithm::ALL_TO_ALL:
+            return wait_all_to_all(self, count_nodes, msg);
+        case BarrierAlgorithm::TREE:
+            return wait_tree(self, count_nodes, msg);
+        default:
+            return wait_dissemination(self, count_nodes, msg);
+    }
+}
+
+bool ProcessBarrier::wait_all_to_all(local_id self, int count_nodes, const Message& msg) {
+    MessageType type = static_cast<MessageType>(msg.s_header.s_type);
+    bool ok = true;
+
+    if (self != PARENT_ID) {
+        Message stamped = msg;
+        stamped.s_header.s_local_time = wire_timestamp(update_lamport_time());
+        ok = send_multicast(&stamped) == 0;
+    }
+    for (int i = 1; i < count_nodes; ++i) {
+        if (i == self) continue;
+        ok = receive_expected(static_cast<local_id>(i), type) && ok;
+    }
+    return ok;
+}
+
+bool ProcessBarrier::wait_dissemination(local_id self, int count_nodes, const Message& msg) {
+    MessageType type = static_cast<MessageType>(msg.s_header.s_type);
+
+    // 第k轮之后，每个节点都间接得知了 2^(k+1) 个节点已经到达
+    for (int distance = 1; distance < count_nodes; distance *= 2) {
+        local_id to = static_cast<local_id>((self + distance) % count_nodes);
+        local_id from = static_cast<local_id>((self - distance + count_nodes) % count_nodes);
+        if (!send_stamped(to, msg) || !receive_expected(from, type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProcessBarrier::wait_tree(local_id self, int count_nodes, const Message& msg) {
+    MessageType type = static_cast<MessageType>(msg.s_header.s_type);
+    SpanningTree tree(self, count_nodes);
+
+    // 汇合：等子树全部到达后向上报告
+    for (int k = 0; k < tree.child_count(); ++k) {
+        if (!receive_expected(tree.child(k), type)) {
+            return false;
+        }
+    }
+    if (!tree.is_root()) {
+        if (!send_stamped(tree.parent(), msg) || !receive_expected(tree.parent(), type)) {
+            return false;
+        }
+    }
+
+    // 释放：根收齐即全部到达，沿树向下转发
+    for (int k = 0; k < tree.child_count(); ++k) {
+        if (!send_stamped(tree.child(k), msg)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProcessBarrier::wait_shared(int count_nodes) {
+    local_sense_ ^= 1;
+    uint32_t my_sense = local_sense_;
+
+    // 最后一个到达者重置计数并翻转全局感应位，其余进程等待感应位变化
+    if (shared_->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+        static_cast<uint32_t>(count_nodes)) {
+        shared_->arrived.store(0, std::memory_order_relaxed);
+        shared_->sense.store(my_sense, std::memory_order_release);
+        futex_wake(&shared_->sense);
+    } else {
+        int spins = 0;
+        while (shared_->sense.load(std::memory_order_acquire) != my_sense) {
+            if (spins < kSpinIterations) {
+                ++spins;
+                cpu_relax();
+            } else {
+                futex_wait(&shared_->sense, my_sense ^ 1);
+            }
+        }
+    }
+
+    // 屏障本身不传递消息，用一次本地事件表示“所有进程已到达”
+    update_lamport_time();
+    return true;
+}
+
+bool ProcessBarrier::send_stamped(local_id dst, Message msg) {
+    msg.s_header.s_local_time = wire_timestamp(update_lamport_time());
+    return send(dst, &msg) == 0;
+}
+
+bool ProcessBarrier::receive_expected(local_id from, MessageType type) {
+    Message msg;
+    if (receive(from, &msg) != 0) {
+        return false;
+    }
+    receive_lamport_time(msg.s_header.s_local_time);
+    if (msg.s_header.s_magic != MESSAGE_MAGIC || msg.s_header.s_type != type) {
+        std::cerr << "错误: 屏障期间从进程 " << static_cast<int>(from)
+                  << " 收到非屏障消息 (类型 " << msg.s_header.s_type << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,227 @@
+#include "banking_system/ipc/shared_ledger.h"
+#include "banking_system/ipc/futex.h"
+#include "banking_system/common/prefault.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+
+namespace {
+
+constexpr uint32_t kLedgerMagic = 0x4C44474C;  // "LDGL"
+constexpr size_t kCacheLine = 64;
+
+size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+} // namespace
+
+// ==================== 共享段内部布局 ====================
+
+struct SharedLedger::SegmentHeader {
+    uint32_t magic;             ///< 段签名
+    uint32_t accounts;          ///< 账户总数
+    uint64_t log_capacity;      ///< 每个账户日志的容量
+};
+
+struct alignas(kCacheLine) SharedLedger::Slot {
+    std::atomic<uint32_t> lock;     ///< 写锁（0空闲，1占用）
+    std::atomic<uint32_t> count;    ///< 已发布的日志项数
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+              std::atomic<uint32_t>::is_always_lock_free,
+              "跨进程共享的原子变量必须是无锁的");
+
+// ==================== 生命周期 ====================
+
+SharedLedger& SharedLedger::instance() {
+    static SharedLedger instance;
+    return instance;
+}
+
+SharedLedger::~SharedLedger() {
+    destroy();
+}
+
+bool SharedLedger::create(account_id_t accounts, size_t log_capacity) {
+    if (accounts == 0 || log_capacity < 2 || log_capacity > UINT32_MAX) {
+        std::cerr << "错误: 无效的账本参数 (账户数 " << accounts
+                  << ", 日志容量 " << log_capacity << ")" << std::endl;
+        return false;
+    }
+
+    destroy();
+
+    size_t slots = static_cast<size_t>(accounts) + 1;
+    size_t slots_offset = align_up(sizeof(SegmentHeader), kCacheLine);
+    size_t logs_offset = align_up(slots_offset + slots * sizeof(Slot), kCacheLine);
+    size_t total = logs_offset + slots * log_capacity * sizeof(WideBalanceState);
+
+    void* base = mmap(nullptr, total, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "错误: 共享账本映射失败 (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    char* bytes = static_cast<char*>(base);
+    SegmentHeader* header = reinterpret_cast<SegmentHeader*>(bytes);
+    header->magic = kLedgerMagic;
+    header->accounts = accounts;
+    header->log_capacity = log_capacity;
+
+    slots_ = reinterpret_cast<Slot*>(bytes + slots_offset);
+    for (size_t i = 0; i < slots; ++i) {
+        new (&slots_[i]) Slot();
+        slots_[i].lock.store(0, std::memory_order_relaxed);
+        slots_[i].count.store(0, std::memory_order_relaxed);
+    }
+
+    segment_ = base;
+    segment_size_ = total;
+    accounts_ = accounts;
+    log_capacity_ = log_capacity;
+    logs_ = reinterpret_cast<WideBalanceState*>(bytes + logs_offset);
+    return true;
+}
+
+void SharedLedger::prefault(size_t states, int threads) {
+    if (segment_ == nullptr) {
+        return;
+    }
+    char* base = static_cast<char*>(segment_);
+    prefault_pages(base, reinterpret_cast<char*>(logs_) - base, threads);
+    // 0号日志不用，从1号账户开始
+    prefault_strided(log_of(1), accounts_, log_capacity_ * sizeof(WideBalanceState),
+                     std::min(states, log_capacity_) * sizeof(WideBalanceState), threads);
+}
+
+void SharedLedger::destroy() {
+    if (segment_ != nullptr) {
+        munmap(segment_, segment_size_);
+    }
+    segment_ = nullptr;
+    segment_size_ = 0;
+    accounts_ = 0;
+    log_capacity_ = 0;
+    slots_ = nullptr;
+    logs_ = nullptr;
+}
+
+// ==================== 槽位锁 ====================
+
+void SharedLedger::lock(Slot* slot) {
+    for (;;) {
+        uint32_t expected = 0;
+        if (slot->lock.compare_exchange_weak(expected, 1, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+            return;
+        }
+        while (slot->lock.load(std::memory_order_relaxed) != 0) {
+            cpu_relax();
+        }
+    }
+}
+
+void SharedLedger::unlock(Slot* slot) {
+    slot->lock.store(0, std::memory_order_release);
+}
+
+// ==================== 账本操作 ====================
+
+bool SharedLedger::open_account(account_id_t account, balance_t initial_balance) {
+    if (!contains(account)) {
+        std::cerr << "错误: 账户 " << account << " 不在共享账本中" << std::endl;
+        return false;
+    }
+    Slot* slot = &slots_[account];
+    lock(slot);
+    log_of(account)[0] = {0, initial_balance, 0};
+    slot->count.store(1, std::memory_order_release);
+    unlock(slot);
+    return true;
+}
+
+bool SharedLedger::transfer(account_id_t src, account_id_t dst, balance_t amount,
+                            lamport_time_t time, lamport_time_t* commit_time) {
+    if (!contains(src) || !contains(dst)) {
+        return false;
+    }
+
+    // 按账户ID顺序加锁，两笔方向相反的转账不会互相等待
+    Slot* first = &slots_[std::min(src, dst)];
+    Slot* second = &slots_[std::max(src, dst)];
+    lock(first);
+    if (second != first) {
+        lock(second);
+    }
+
+    uint32_t src_count = slots_[src].count.load(std::memory_order_relaxed);
+    uint32_t dst_count = slots_[dst].count.load(std::memory_order_relaxed);
+    bool ok = src_count != 0 && dst_count != 0 &&
+              src_count < log_capacity_ && dst_count < log_capacity_;
+    if (ok) {
+        WideBalanceState* src_log = log_of(src);
+        WideBalanceState* dst_log = log_of(dst);
+        const WideBalanceState& src_last = src_log[src_count - 1];
+        const WideBalanceState& dst_last = dst_log[dst_count - 1];
+
+        // 两端使用同一时刻，且严格晚于各自的最后一项，已发布的项不会被改写
+        lamport_time_t stamp = std::max({time, src_last.s_time + 1, dst_last.s_time + 1});
+        if (src == dst) {
+            src_log[src_count] = {stamp, src_last.s_balance, src_last.s_balance_pending_in};
+        } else {
+            src_log[src_count] = {stamp, static_cast<balance_t>(src_last.s_balance - amount),
+                                  src_last.s_balance_pending_in};
+            dst_log[dst_count] = {stamp, static_cast<balance_t>(dst_last.s_balance + amount),
+                                  dst_last.s_balance_pending_in};
+            slots_[dst].count.store(dst_count + 1, std::memory_order_release);
+        }
+        slots_[src].count.store(src_count + 1, std::memory_order_release);
+        *commit_time = stamp;
+    }
+
+    if (second != first) {
+        unlock(second);
+    }
+    unlock(first);
+
+    if (!ok) {
+        std::cerr << "错误: 共享账本无法结算 " << src << " -> " << dst
+                  << "（账户未初始化或日志已满）" << std::endl;
+    }
+    return ok;
+}
+
+WideBalanceState SharedLedger::state(account_id_t account) const {
+    size_t count = log_size(account);
+    if (count == 0) {
+        return {0, 0, 0};
+    }
+    return log_of(account)[count - 1];
+}
+
+size_t SharedLedger::log_size(account_id_t account) const {
+    if (!contains(account)) {
+        return 0;
+    }
+    return slots_[account].count.load(std::memory_order_acquire);
+}
+
+bool SharedLedger::export_history(account_id_t account, ScalableBalanceHistory* history) const {
+    size_t count = log_size(account);
+    if (count == 0) {
+        return false;
+    }
+    const WideBalanceState* log = log_of(account);
+    history->clear(account);
+    for (size_t i = 0; i < count; ++i) {
+        history->push_back(log[i]);
+    }
+    history->set_end_time(log[count - 1].s_time);
+    return true;
+}
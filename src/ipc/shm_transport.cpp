@@ -0,0 +1,470 @@
+#include "banking_system/ipc/shm_transport.h"
+#include "banking_system/ipc/futex.h"
+#include "banking_system/common/prefault.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t kSegmentMagic = 0x53484D54;  // "SHMT"
+constexpr size_t kCacheLine = 64;
+constexpr size_t kFrameAlign = 8;
+
+size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+} // namespace
+
+// ==================== 共享段内部布局 ====================
+
+struct ShmTransport::SegmentHeader {
+    uint32_t magic;             ///< 段签名
+    uint32_t count_nodes;       ///< 节点总数
+    uint64_t ring_capacity;     ///< 每个环的容量
+};
+
+struct alignas(kCacheLine) ShmTransport::Doorbell {
+    std::atomic<uint32_t> seq;      ///< futex字，每次敲门铃递增
+    std::atomic<uint32_t> waiters;  ///< 正在睡眠的等待者数量
+    std::atomic<uint64_t> ready;    ///< 有待读数据的发送者位图（仅数据门铃使用）
+};
+
+static_assert(MAX_PROCESS_ID + 1 <= 64, "ready位图假定节点数不超过64");
+
+struct ShmTransport::RingControl {
+    alignas(kCacheLine) std::atomic<uint64_t> head;  ///< 生产者写入位置
+    alignas(kCacheLine) std::atomic<uint64_t> tail;  ///< 消费者读取位置
+};
+
+// ==================== 生命周期 ====================
+
+ShmTransport& ShmTransport::instance() {
+    static ShmTransport instance;
+    return instance;
+}
+
+ShmTransport::~ShmTransport() {
+    destroy();
+}
+
+bool ShmTransport::create(int count_nodes, size_t ring_capacity) {
+    if (count_nodes < 2 || count_nodes > MAX_PROCESS_ID + 1) {
+        std::cerr << "错误: 无效的节点数量 " << count_nodes << std::endl;
+        return false;
+    }
+    if (ring_capacity < MAX_MESSAGE_LEN || (ring_capacity & (ring_capacity - 1)) != 0) {
+        std::cerr << "错误: 环形缓冲区容量必须为2的幂且不小于 "
+                  << MAX_MESSAGE_LEN << std::endl;
+        return false;
+    }
+
+    destroy();
+
+    size_t channels = static_cast<size_t>(count_nodes) * count_nodes;
+    size_t bells_offset = align_up(sizeof(SegmentHeader), kCacheLine);
+    size_t rings_offset = bells_offset + 2 * count_nodes * sizeof(Doorbell);
+    size_t data_offset = align_up(rings_offset + channels * sizeof(RingControl), kCacheLine);
+    size_t total = data_offset + channels * ring_capacity;
+
+    void* base = mmap(nullptr, total, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "错误: 共享内存映射失败 (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    char* bytes = static_cast<char*>(base);
+    SegmentHeader* header = reinterpret_cast<SegmentHeader*>(bytes);
+    header->magic = kSegmentMagic;
+    header->count_nodes = static_cast<uint32_t>(count_nodes);
+    header->ring_capacity = ring_capacity;
+
+    data_bells_ = reinterpret_cast<Doorbell*>(bytes + bells_offset);
+    space_bells_ = data_bells_ + count_nodes;
+    for (int i = 0; i < 2 * count_nodes; ++i) {
+        new (&data_bells_[i]) Doorbell();
+        data_bells_[i].seq.store(0, std::memory_order_relaxed);
+        data_bells_[i].waiters.store(0, std::memory_order_relaxed);
+        data_bells_[i].ready.store(0, std::memory_order_relaxed);
+    }
+
+    rings_ = reinterpret_cast<RingControl*>(bytes + rings_offset);
+    for (size_t i = 0; i < channels; ++i) {
+        new (&rings_[i]) RingControl();
+        rings_[i].head.store(0, std::memory_order_relaxed);
+        rings_[i].tail.store(0, std::memory_order_relaxed);
+    }
+
+    segment_ = base;
+    segment_size_ = total;
+    count_nodes_ = count_nodes;
+    ring_capacity_ = ring_capacity;
+    ring_data_ = bytes + data_offset;
+
+    attach(PARENT_ID);
+    return true;
+}
+
+void ShmTransport::attach(local_id self_id) {
+    self_id_ = self_id;
+    rr_cursor_.store(0, std::memory_order_relaxed);
+    // fork之后重新创建进程内锁，避免继承父进程中的锁状态
+    send_mutexes_.reset(new std::mutex[count_nodes_ > 0 ? count_nodes_ : 1]);
+    recv_mutexes_.reset(new std::mutex[count_nodes_ > 0 ? count_nodes_ : 1]);
+}
+
+void ShmTransport::prefault(int threads) {
+    if (segment_ != nullptr) {
+        prefault_pages(segment_, segment_size_, threads);
+    }
+}
+
+void ShmTransport::destroy() {
+    if (segment_ != nullptr) {
+        munmap(segment_, segment_size_);
+    }
+    segment_ = nullptr;
+    segment_size_ = 0;
+    count_nodes_ = 0;
+    data_bells_ = nullptr;
+    space_bells_ = nullptr;
+    rings_ = nullptr;
+    ring_data_ = nullptr;
+}
+
+// ==================== 门铃 ====================
+
+bool ShmTransport::wait_bell(Doorbell* bell, uint32_t seen,
+                             const std::chrono::steady_clock::time_point* deadline) {
+    for (int i = 0; i < kSpinIterations; ++i) {
+        if (bell->seq.load(std::memory_order_acquire) != seen) {
+            return true;
+        }
+        cpu_relax();
+    }
+
+    bool rung = true;
+    bell->waiters.fetch_add(1, std::memory_order_seq_cst);
+    while (bell->seq.load(std::memory_order_seq_cst) == seen) {
+        if (deadline == nullptr) {
+            futex_wait(&bell->seq, seen);
+            continue;
+        }
+
+        auto remaining = *deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero()) {
+            rung = false;
+            break;
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+        struct timespec timeout;
+        timeout.tv_sec = static_cast<time_t>(ns / 1000000000);
+        timeout.tv_nsec = static_cast<long>(ns % 1000000000);
+        futex_wait(&bell->seq, seen, &timeout);
+    }
+    bell->waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return rung;
+}
+
+void ShmTransport::ring_bell(Doorbell* bell) {
+    bell->seq.fetch_add(1, std::memory_order_seq_cst);
+    if (bell->waiters.load(std::memory_order_seq_cst) > 0) {
+        futex_wake(&bell->seq);
+    }
+}
+
+// ==================== 环形缓冲区 ====================
+
+bool ShmTransport::try_push(int from, int to, const Message* msg, size_t frame_len) {
+    RingControl& ring = rings_[ring_index(from, to)];
+    char* data = ring_data_ + ring_index(from, to) * ring_capacity_;
+
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    size_t padded = align_up(frame_len, kFrameAlign);
+    if (ring_capacity_ - (head - tail) < padded) {
+        return false;
+    }
+
+    // 帧长度按8字节对齐，环容量为2的幂，因此帧头永远不会被截断；
+    // 只有负载部分可能跨越环尾，分两段拷贝
+    size_t offset = head & (ring_capacity_ - 1);
+    size_t first = std::min(frame_len, ring_capacity_ - offset);
+    const char* src = reinterpret_cast<const char*>(msg);
+    std::memcpy(data + offset, src, first);
+    if (first < frame_len) {
+        std::memcpy(data, src + first, frame_len - first);
+    }
+
+    ring.head.store(head + padded, std::memory_order_release);
+    return true;
+}
+
+bool ShmTransport::try_pop(int from, int to, Message* msg) {
+    RingControl& ring = rings_[ring_index(from, to)];
+    const char* data = ring_data_ + ring_index(from, to) * ring_capacity_;
+
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+
+    size_t offset = tail & (ring_capacity_ - 1);
+    std::memcpy(&msg->s_header, data + offset, sizeof(MessageHeader));
+
+    size_t payload_len = msg->s_header.s_payload_len;
+    size_t payload_offset = (offset + sizeof(MessageHeader)) & (ring_capacity_ - 1);
+    size_t first = std::min(payload_len, ring_capacity_ - payload_offset);
+    std::memcpy(msg->s_payload, data + payload_offset, first);
+    if (first < payload_len) {
+        std::memcpy(msg->s_payload + first, data, payload_len - first);
+    }
+
+    size_t padded = align_up(sizeof(MessageHeader) + payload_len, kFrameAlign);
+    ring.tail.store(tail + padded, std::memory_order_release);
+    ring_bell(&space_bells_[from]);
+    return true;
+}
+
+// ==================== 发送与接收 ====================
+
+int ShmTransport::send(local_id dst, const Message* msg) {
+    if (segment_ == nullptr || dst < 0 || dst >= count_nodes_ || dst == self_id_) {
+        std::cerr << "错误: 进程 " << static_cast<int>(self_id_)
+                  << " 无法发送到 " << static_cast<int>(dst) << std::endl;
+        return -1;
+    }
+    if (msg->s_header.s_payload_len > MAX_PAYLOAD_LEN) {
+        std::cerr << "错误: 消息负载过长 (" << msg->s_header.s_payload_len << ")" << std::endl;
+        return -1;
+    }
+
+    size_t frame_len = sizeof(MessageHeader) + msg->s_header.s_payload_len;
+    Doorbell* space_bell = &space_bells_[self_id_];
+
+    std::lock_guard<std::mutex> lock(send_mutexes_[dst]);
+    while (true) {
+        uint32_t seen = space_bell->seq.load(std::memory_order_seq_cst);
+        if (try_push(self_id_, dst, msg, frame_len)) {
+            break;
+        }
+        wait_bell(space_bell, seen);
+    }
+
+    Doorbell* data_bell = &data_bells_[dst];
+    data_bell->ready.fetch_or(uint64_t(1) << self_id_, std::memory_order_seq_cst);
+    ring_bell(data_bell);
+    return 0;
+}
+
+int ShmTransport::send_multicast(const Message* msg) {
+    for (int i = 0; i < count_nodes_; ++i) {
+        if (i == self_id_) continue;
+        if (send(static_cast<local_id>(i), msg) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int ShmTransport::receive(local_id from, Message* msg) {
+    if (segment_ == nullptr || from < 0 || from >= count_nodes_ || from == self_id_) {
+        std::cerr << "错误: 进程 " << static_cast<int>(self_id_)
+                  << " 无法从 " << static_cast<int>(from) << " 接收" << std::endl;
+        return -1;
+    }
+
+    Doorbell* data_bell = &data_bells_[self_id_];
+
+    std::unique_lock<std::mutex> lock(recv_mutexes_[from]);
+    while (true) {
+        uint32_t seen = data_bell->seq.load(std::memory_order_seq_cst);
+        if (try_pop(from, self_id_, msg)) {
+            release_channel(lock);
+            return 0;
+        }
+        wait_bell(data_bell, seen);
+    }
+}
+
+int ShmTransport::try_receive(local_id from, Message* msg) {
+    if (segment_ == nullptr || from < 0 || from >= count_nodes_ || from == self_id_) {
+        return -1;
+    }
+
+    std::unique_lock<std::mutex> lock(recv_mutexes_[from]);
+    bool popped = try_pop(from, self_id_, msg);
+    release_channel(lock);
+    return popped ? 0 : 1;
+}
+
+int ShmTransport::receive_any(Message* msg) {
+    local_id from = PARENT_ID;
+    if (receive_many(msg, 1, &from) <= 0) {
+        return -1;
+    }
+    return from;
+}
+
+int ShmTransport::receive_many(Message* msgs, int max_count, local_id* senders) {
+    return receive_many_until(msgs, max_count, senders, nullptr);
+}
+
+int ShmTransport::receive_many_for(Message* msgs, int max_count, local_id* senders,
+                                   int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    return receive_many_until(msgs, max_count, senders, &deadline);
+}
+
+void ShmTransport::interrupt() {
+    if (segment_ == nullptr) {
+        return;
+    }
+    interrupted_.store(true, std::memory_order_seq_cst);
+    ring_bell(&data_bells_[self_id_]);
+}
+
+int ShmTransport::receive_many_until(Message* msgs, int max_count, local_id* senders,
+                                     const std::chrono::steady_clock::time_point* deadline) {
+    if (segment_ == nullptr || max_count <= 0) {
+        return -1;
+    }
+
+    Doorbell* data_bell = &data_bells_[self_id_];
+
+    while (true) {
+        uint32_t seen = data_bell->seq.load(std::memory_order_seq_cst);
+        bool contended = false;
+        int received = drain_ready(msgs, max_count, senders, &contended);
+        if (received > 0) {
+            return received;
+        }
+        // 只有带超时的调用者才会被 interrupt() 唤醒返回
+        if (deadline != nullptr && interrupted_.exchange(false, std::memory_order_seq_cst)) {
+            return 0;
+        }
+        if (!contended) {
+            if (!wait_bell(data_bell, seen, deadline)) {
+                return 0;
+            }
+            continue;
+        }
+        
+        // 有通道正被本进程其他线程读取：先登记，持有方释放通道时看到登记会敲门铃
+        // （见 release_channel）。登记之后重新读序号并再轮询一次，之后才睡眠，
+        // 持有方在登记前释放的通道由这次轮询取走，不会错过其留下的消息
+        recv_contenders_.fetch_add(1, std::memory_order_seq_cst);
+        seen = data_bell->seq.load(std::memory_order_seq_cst);
+        contended = false;
+        received = drain_ready(msgs, max_count, senders, &contended);
+        bool rung = received > 0 || wait_bell(data_bell, seen, deadline);
+        recv_contenders_.fetch_sub(1, std::memory_order_seq_cst);
+        if (received > 0) {
+            return received;
+        }
+        if (!rung) {
+            return 0;
+        }
+    }
+}
+
+void ShmTransport::release_channel(std::unique_lock<std::mutex>& lock) {
+    lock.unlock();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (recv_contenders_.load(std::memory_order_seq_cst) > 0) {
+        ring_bell(&data_bells_[self_id_]);
+    }
+}
+
+int ShmTransport::drain_ready(Message* msgs, int max_count, local_id* senders,
+                              bool* contended) {
+    Doorbell* data_bell = &data_bells_[self_id_];
+    int received = 0;
+    bool progress = true;
+
+    // 每轮每个通道最多取一帧，并从上次服务位置之后开始，
+    // 保证繁忙的发送者不会饿死其他发送者
+    while (received < max_count && progress) {
+        progress = false;
+        uint64_t ready = data_bell->ready.load(std::memory_order_seq_cst);
+        if (ready == 0) {
+            break;
+        }
+
+        int start = rr_cursor_.load(std::memory_order_relaxed);
+        for (int k = 0; k < count_nodes_ && received < max_count; ++k) {
+            int i = (start + k) % count_nodes_;
+            uint64_t bit = uint64_t(1) << i;
+            if (i == self_id_ || (ready & bit) == 0) continue;
+
+            std::unique_lock<std::mutex> lock(recv_mutexes_[i], std::try_to_lock);
+            if (!lock.owns_lock()) {
+                *contended = true;
+                continue;
+            }
+
+            bool popped = try_pop(i, self_id_, &msgs[received]);
+            if (!popped) {
+                // 通道已空：先清位再复查，避免与发送方的置位发生竞争而丢失通知
+                data_bell->ready.fetch_and(~bit, std::memory_order_seq_cst);
+                const RingControl& ring = rings_[ring_index(i, self_id_)];
+                if (ring.head.load(std::memory_order_seq_cst) !=
+                    ring.tail.load(std::memory_order_relaxed)) {
+                    data_bell->ready.fetch_or(bit, std::memory_order_seq_cst);
+                    progress = true;
+                }
+            }
+            release_channel(lock);
+
+            if (popped) {
+                if (senders != nullptr) {
+                    senders[received] = static_cast<local_id>(i);
+                }
+                ++received;
+                progress = true;
+                rr_cursor_.store((i + 1) % count_nodes_, std::memory_order_relaxed);
+            }
+        }
+    }
+    return received;
+}
+
+// ==================== message.h 接口实现 ====================
+
+int send(local_id dst, const Message* msg) {
+    return ShmTransport::instance().send(dst, msg);
+}
+
+int send_multicast(const Message* msg) {
+    return ShmTransport::instance().send_multicast(msg);
+}
+
+int receive(local_id from, Message* msg) {
+    return ShmTransport::instance().receive(from, msg);
+}
+
+int receive_any(Message* msg) {
+    return ShmTransport::instance().receive_any(msg);
+}
+
+int try_receive(local_id from, Message* msg) {
+    return ShmTransport::instance().try_receive(from, msg);
+}
+
+int receive_many_for(Message* msgs, int max_count, local_id* senders, int timeout_ms) {
+    return ShmTransport::instance().receive_many_for(msgs, max_count, senders, timeout_ms);
+}
+
+int receive_many(Message* msgs, int max_count, local_id* senders) {
+    return ShmTransport::instance().receive_many(msgs, max_count, senders);
+}
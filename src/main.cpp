@@ -1,23 +1,515 @@
 #include "banking_system.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ==================== 启动参数 ====================
+
+namespace {
+
+/**
+ * @brief 事件日志文件名（shared_logger 的默认实现写入该文件和标准输出）
+ */
+constexpr const char* kEventsLogPath = "events.log";
+
+/**
+ * @brief 转账传输方式
+ */
+enum class TransferTransport {
+    SHM,        ///< 共享内存SPSC通道上的消息（父进程→源账户→目标账户→父进程）
+    LEDGER      ///< 共享内存账本：同主机转账由父进程直接结算
+};
+
+/**
+ * @brief 命令行参数
+ */
+struct LaunchOptions {
+    int workers = 0;                            ///< 账户进程数（1..MAX_PROCESS_ID）
+    account_id_t accounts = 0;                  ///< 账户总数（0表示一个进程一个账户）
+    int shards = 8;                             ///< 父进程分片数
+    int balance = 10;                           ///< 默认初始余额
+    std::vector<int> balances;                  ///< 逐个账户进程的初始余额（位置参数）
+    TransferTransport transport = TransferTransport::SHM; ///< 转账传输方式
+    BarrierAlgorithm barrier = BarrierAlgorithm::DISSEMINATION; ///< 启动屏障算法
+    ClockMode clock_mode = ClockMode::GLOBAL;   ///< 父进程分片的时钟域
+    TimeSource time_source = TimeSource::LAMPORT; ///< 所有进程的时间来源（fork之前选定）
+    std::string workload_path;                  ///< 转账文件（为空时使用默认账户环）
+    bool prefault = true;                       ///< fork之前是否预缺页共享段
+    std::string history_dir;                    ///< 段文件、事件日志和历史报告的目录（为空时见 --history-dir）
+};
+
+int g_events_log = -1;  ///< 事件日志文件描述符（fork之前打开，所有进程共享）
+
+void print_usage(const char* program) {
+    std::cout
+        << "用法: " << program << " -p <进程数> [选项] [余额1 余额2 ...]\n"
+        << "\n"
+        << "  -p, --workers N         账户进程数 (1.." << MAX_PROCESS_ID << ")\n"
+        << "  -a, --accounts N        账户总数，按块分给各进程 (默认0: 一个进程一个账户)\n"
+        << "  -s, --shards N          父进程分片数 (默认8)\n"
+        << "  -b, --balance B         每个账户的初始余额 (默认10)\n"
+        << "  -t, --transport T       转账传输: shm | ledger (默认shm)\n"
+        << "      --barrier A         启动屏障: all-to-all | dissemination | tree | shm"
+           " (默认dissemination)\n"
+        << "      --clock C           时钟: global | per-shard | hlc (默认global)\n"
+        << "  -w, --workload FILE     转账文件，每行 \"源账户 目标账户 金额\"，# 开头为注释\n"
+        << "      --no-prefault       fork之前不预缺页共享段\n"
+        << "      --history-dir DIR   余额历史段文件、events.log 和 history_report.json 的目录\n"
+        << "                          (默认段文件在 $TMPDIR 或 /tmp，其余在当前目录)\n"
+        << "  -h, --help              显示本帮助\n"
+        << "\n"
+        << "一个进程一个账户时，可在选项之后逐个给出各账户进程的初始余额\n";
+}
+
+/**
+ * @brief --clock 选项的名称（用于日志）
+ */
+const char* clock_name(const LaunchOptions& options) {
+    if (options.time_source == TimeSource::HYBRID) {
+        return "hlc";
+    }
+    return options.clock_mode == ClockMode::PER_SHARD ? "per-shard" : "global";
+}
+
+bool parse_int(const char* text, long min, long max, long* value) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0' || parsed < min || parsed > max) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+bool parse_options(int argc, char* argv[], LaunchOptions* options) {
+    enum { OPT_BARRIER = 1000, OPT_CLOCK, OPT_NO_PREFAULT, OPT_HISTORY_DIR };
+    static const struct option long_options[] = {
+        {"workers",    required_argument, nullptr, 'p'},
+        {"accounts",   required_argument, nullptr, 'a'},
+        {"shards",     required_argument, nullptr, 's'},
+        {"balance",    required_argument, nullptr, 'b'},
+        {"transport",  required_argument, nullptr, 't'},
+        {"barrier",    required_argument, nullptr, OPT_BARRIER},
+        {"clock",      required_argument, nullptr, OPT_CLOCK},
+        {"workload",   required_argument, nullptr, 'w'},
+        {"no-prefault", no_argument,      nullptr, OPT_NO_PREFAULT},
+        {"history-dir", required_argument, nullptr, OPT_HISTORY_DIR},
+        {"help",       no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    long value;
+    while ((opt = getopt_long(argc, argv, "p:a:s:b:t:w:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'p':
+                if (!parse_int(optarg, 1, MAX_PROCESS_ID, &value)) {
+                    std::cerr << "错误: 进程数必须在 1.." << MAX_PROCESS_ID << " 之间" << std::endl;
+                    return false;
+                }
+                options->workers = static_cast<int>(value);
+                break;
+            case 'a':
+                if (!parse_int(optarg, 0, INT32_MAX, &value)) {
+                    std::cerr << "错误: 无效的账户总数 " << optarg << std::endl;
+                    return false;
+                }
+                options->accounts = static_cast<account_id_t>(value);
+                break;
+            case 's':
+                if (!parse_int(optarg, 1, 1024, &value)) {
+                    std::cerr << "错误: 无效的分片数 " << optarg << std::endl;
+                    return false;
+                }
+                options->shards = static_cast<int>(value);
+                break;
+            case 'b':
+                if (!parse_int(optarg, 0, INT16_MAX, &value)) {
+                    std::cerr << "错误: 无效的初始余额 " << optarg << std::endl;
+                    return false;
+                }
+                options->balance = static_cast<int>(value);
+                break;
+            case 't':
+                if (std::strcmp(optarg, "shm") == 0) {
+                    options->transport = TransferTransport::SHM;
+                } else if (std::strcmp(optarg, "ledger") == 0) {
+                    options->transport = TransferTransport::LEDGER;
+                } else {
+                    std::cerr << "错误: 未知的传输方式 " << optarg << std::endl;
+                    return false;
+                }
+                break;
+            case OPT_BARRIER: {
+                bool found = false;
+                for (BarrierAlgorithm algorithm : {BarrierAlgorithm::ALL_TO_ALL,
+                                                   BarrierAlgorithm::DISSEMINATION,
+                                                   BarrierAlgorithm::TREE,
+                                                   BarrierAlgorithm::SHARED_MEMORY}) {
+                    if (std::strcmp(optarg, ProcessBarrier::name(algorithm)) == 0) {
+                        options->barrier = algorithm;
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    std::cerr << "错误: 未知的屏障算法 " << optarg << std::endl;
+                    return false;
+                }
+                break;
+            }
+            case OPT_CLOCK:
+                // global / per-shard 为Lamport计数器的两种时钟域，hlc 为全局时钟域上的混合逻辑时钟
+                if (std::strcmp(optarg, "global") == 0) {
+                    options->clock_mode = ClockMode::GLOBAL;
+                    options->time_source = TimeSource::LAMPORT;
+                } else if (std::strcmp(optarg, "per-shard") == 0) {
+                    options->clock_mode = ClockMode::PER_SHARD;
+                    options->time_source = TimeSource::LAMPORT;
+                } else if (std::strcmp(optarg, "hlc") == 0) {
+                    options->clock_mode = ClockMode::GLOBAL;
+                    options->time_source = TimeSource::HYBRID;
+                } else {
+                    std::cerr << "错误: 未知的时钟 " << optarg << std::endl;
+                    return false;
+                }
+                break;
+            case 'w':
+                options->workload_path = optarg;
+                break;
+            case OPT_NO_PREFAULT:
+                options->prefault = false;
+                break;
+            case OPT_HISTORY_DIR:
+                options->history_dir = optarg;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                std::exit(0);
+            default:
+                print_usage(argv[0]);
+                return false;
+        }
+    }
+
+    if (options->workers == 0) {
+        std::cerr << "错误: 必须用 -p 指定账户进程数" << std::endl;
+        print_usage(argv[0]);
+        return false;
+    }
+
+    // 位置参数：逐个账户进程的初始余额（与实验框架 "-p N 余额..." 的约定一致）
+    for (int i = optind; i < argc; ++i) {
+        if (!parse_int(argv[i], 0, UINT8_MAX, &value)) {
+            std::cerr << "错误: 无效的初始余额 " << argv[i] << std::endl;
+            return false;
+        }
+        options->balances.push_back(static_cast<int>(value));
+    }
+
+    if (options->accounts != 0) {
+        if (options->accounts < static_cast<account_id_t>(options->workers)) {
+            std::cerr << "错误: 账户总数 " << options->accounts << " 少于进程数 "
+                      << options->workers << std::endl;
+            return false;
+        }
+        if (!options->balances.empty()) {
+            std::cerr << "错误: 多账户模式下只能用 -b 指定统一的初始余额" << std::endl;
+            return false;
+        }
+    } else {
+        if (!options->balances.empty() &&
+            options->balances.size() != static_cast<size_t>(options->workers)) {
+            std::cerr << "错误: 给出了 " << options->balances.size() << " 个初始余额，"
+                      << "但有 " << options->workers << " 个账户进程" << std::endl;
+            return false;
+        }
+        if (options->balances.empty() && options->balance > UINT8_MAX) {
+            std::cerr << "错误: 一个进程一个账户时初始余额不能超过 " << UINT8_MAX << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 读取转账文件
+ * @param path 文件路径
+ * @param accounts 账户总数（账户ID必须在 1..accounts 之内）
+ * @param transfers 输出转账
+ * @return 文件无法读取或有非法行时返回false
+ */
+bool load_workload(const std::string& path, account_id_t accounts,
+                   std::vector<AccountTransfer>* transfers) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "错误: 无法读取转账文件 " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        long long src, dst, amount;
+        std::string rest;
+        if (!(fields >> src >> dst >> amount) || (fields >> rest) ||
+            src < 1 || dst < 1 || src > accounts || dst > accounts || src == dst ||
+            amount < 1 || amount > INT16_MAX) {
+            std::cerr << "错误: " << path << ":" << line_no << " 不是合法的转账 \""
+                      << line << "\"（账户ID须在 1.." << accounts << " 之内且互不相同）"
+                      << std::endl;
+            return false;
+        }
+        transfers->push_back({static_cast<account_id_t>(src), static_cast<account_id_t>(dst),
+                              static_cast<balance_t>(amount)});
+    }
+    return true;
+}
+
+/**
+ * @brief 共享账本每个账户日志的容量
+ *
+ * 每笔转账在两端日志各追加一项，再加上初始余额一项；日志写满后账本无法
+ * 结算，因此按转账文件中涉及最多的账户确定容量，至少为默认容量
+ * （日志区按需分配物理页，容量只占虚拟地址空间）
+ *
+ * @param workload 转账文件中的转账（为空时使用默认账户环，每个账户只涉及两笔）
+ * @param accounts 账户总数
+ */
+size_t ledger_log_capacity(const std::vector<AccountTransfer>& workload, account_id_t accounts) {
+    std::vector<size_t> touches(static_cast<size_t>(accounts) + 1, 0);
+    size_t busiest = 0;
+    for (const AccountTransfer& transfer : workload) {
+        busiest = std::max(busiest, ++touches[transfer.s_src]);
+        busiest = std::max(busiest, ++touches[transfer.s_dst]);
+    }
+    return std::max(SharedLedger::kDefaultLogCapacity, busiest + 1);
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point from,
+                  std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+/**
+ * @brief fork出的账户进程的全部工作：接入传输层、运行账户进程后退出
+ *
+ * 共享段和所有通道都已由父进程在fork之前创建并预缺页，这里只重建进程内状态
+ *
+ * @param options 命令行参数
+ * @param id 账户进程ID
+ * @param count_nodes 节点总数
+ * @param directory 账户目录
+ */
+[[noreturn]] void run_account_process(const LaunchOptions& options, local_id id, int count_nodes,
+                                      const AccountDirectory& directory) {
+    ShmTransport::instance().attach(id);
+    if (options.accounts != 0) {
+        multi_account_work(MultiAccountArguments{id, count_nodes, directory,
+                                                 static_cast<balance_t>(options.balance)});
+    } else {
+        int balance = options.balances.empty() ? options.balance : options.balances[id - 1];
+        struct child_arguments args = {id, count_nodes, static_cast<uint8_t>(balance), false};
+        child_work(args);
+    }
+    std::cout.flush();
+    std::fflush(nullptr);
+    _exit(0);
+}
+
+/**
+ * @brief 终止已经fork出的账户进程（启动失败时使用）
+ */
+void kill_children(const std::vector<pid_t>& children) {
+    for (pid_t pid : children) {
+        kill(pid, SIGTERM);
+    }
+    for (pid_t pid : children) {
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+} // namespace
+
+// ==================== 实验框架函数的默认实现 ====================
+
+// 与外部实验库一起链接时以外部实现为准
+
+__attribute__((weak))
+void fill_message(Message* msg, MessageType type, timestamp_t time, void* payload, size_t psize) {
+    if (psize > MAX_PAYLOAD_LEN) {
+        psize = MAX_PAYLOAD_LEN;
+    }
+    msg->s_header.s_magic = MESSAGE_MAGIC;
+    msg->s_header.s_payload_len = static_cast<uint16_t>(psize);
+    msg->s_header.s_type = static_cast<int16_t>(type);
+    msg->s_header.s_local_time = time;
+    if (psize > 0 && payload != nullptr) {
+        std::memcpy(msg->s_payload, payload, psize);
+    }
+}
+
+__attribute__((weak))
+void shared_logger(const char* msg) {
+    // 直接写文件描述符：没有stdio缓冲，fork出的进程不会重复输出，
+    // O_APPEND 下每行一次 write，多个进程的日志行不会互相穿插
+    size_t len = std::strlen(msg);
+    if (write(STDOUT_FILENO, msg, len) < 0) {
+        return;
+    }
+    if (g_events_log >= 0 && write(g_events_log, msg, len) < 0) {
+        return;
+    }
+}
+
+// ==================== 启动器 ====================
 
 int main(int argc, char* argv[]) {
-    // 这里可以根据实际需求解析命令行参数
-    // 目前保持简单，直接使用默认值或预设值
-    
-    // 示例：假设从外部初始化进程通信
-    // init_ipc();
-    
-    // 根据进程角色调用相应的函数
-    // if (is_parent_process()) {
-    //     parent_work(count_nodes, num_shards);
-    // } else {
-    //     child_arguments args = {...};
-    //     child_work(args);
-    // }
-    
-    std::cout << "Banking System Initialized" << std::endl;
-    std::cout << "请在实际环境中配置进程通信后使用" << std::endl;
+    LaunchOptions options;
+    if (!parse_options(argc, argv, &options)) {
+        return 1;
+    }
+
+    int count_nodes = options.workers + 1;
+    account_id_t accounts = options.accounts != 0 ? options.accounts
+                                                  : static_cast<account_id_t>(options.workers);
+    AccountDirectory directory(accounts, options.workers);
+
+    std::vector<AccountTransfer> workload;
+    if (!options.workload_path.empty() &&
+        !load_workload(options.workload_path, accounts, &workload)) {
+        return 1;
+    }
+
+    auto launch_time = std::chrono::steady_clock::now();
+
+    // ---------- 共享段：fork之前创建，所有进程继承同一映射 ----------
+    std::string events_path = options.history_dir.empty()
+                                  ? std::string(kEventsLogPath)
+                                  : options.history_dir + "/" + kEventsLogPath;
+    g_events_log = open(events_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (g_events_log < 0) {
+        std::cerr << "警告: 无法打开事件日志 " << events_path
+                  << " (" << std::strerror(errno) << ")，只输出到标准输出" << std::endl;
+    }
+
+    HistoryArchive::set_directory(options.history_dir);
     
-    return 0;
-}
\ No newline at end of file
+    // 时间来源必须在fork之前选定：所有进程的时钟语义一致，子进程继承同一设置
+    if (options.time_source == TimeSource::HYBRID) {
+        use_hybrid_time();
+    }
+
+    ShmTransport& transport = ShmTransport::instance();
+    if (!transport.create(count_nodes)) {
+        return 1;
+    }
+
+    ProcessBarrier& barrier = ProcessBarrier::instance();
+    barrier.set_algorithm(options.barrier);
+    if (options.barrier == BarrierAlgorithm::SHARED_MEMORY && !barrier.create_shared(count_nodes)) {
+        return 1;
+    }
+
+    SharedLedger& ledger = SharedLedger::instance();
+    if (options.transport == TransferTransport::LEDGER &&
+        !ledger.create(accounts, ledger_log_capacity(workload, accounts))) {
+        return 1;
+    }
+
+    // 通道和账本的物理页在这里由多个线程并行分配，而不是在第一条消息、
+    // 第一笔转账时由各进程各自串行缺页
+    if (options.prefault) {
+        transport.prefault();
+        if (ledger.active()) {
+            ledger.prefault();
+        }
+    }
+    auto setup_done = std::chrono::steady_clock::now();
+
+    // ---------- 一次性fork全部账户进程 ----------
+    // 父进程在循环中只fork：通道已全部建好，各子进程自行接入并立即开始工作，
+    // 所有进程之间唯一的启动同步是阶段1的一次启动屏障。
+    // 未刷新的标准输出缓冲会被复制到每个子进程中
+    std::cout.flush();
+    std::fflush(stdout);
+
+    std::vector<pid_t> children;
+    children.reserve(options.workers);
+    for (int id = 1; id <= options.workers; ++id) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::cerr << "错误: fork账户进程 " << id << " 失败 (" << std::strerror(errno) << ")"
+                      << std::endl;
+            kill_children(children);
+            return 1;
+        }
+        if (pid == 0) {
+            run_account_process(options, static_cast<local_id>(id), count_nodes, directory);
+        }
+        children.push_back(pid);
+    }
+    auto fork_done = std::chrono::steady_clock::now();
+
+    // ---------- 父进程 ----------
+    std::cout << "启动 " << options.workers << " 个账户进程, " << accounts << " 个账户, "
+              << options.shards << " 个分片, 传输 "
+              << (options.transport == TransferTransport::LEDGER ? "ledger" : "shm")
+              << ", 启动屏障 " << ProcessBarrier::name(options.barrier)
+              << ", 时钟 " << clock_name(options) << "\n" << std::endl;
+
+    ParentController controller(count_nodes, options.shards, options.accounts, options.clock_mode);
+    if (!workload.empty()) {
+        controller.set_workload(std::move(workload));
+    }
+    controller.set_report_directory(options.history_dir);
+    controller.run();
+
+    int exit_code = 0;
+    for (size_t i = 0; i < children.size(); ++i) {
+        int status = 0;
+        if (waitpid(children[i], &status, 0) < 0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0) {
+            std::cerr << "✗ 账户进程 " << (i + 1) << " 异常退出" << std::endl;
+            exit_code = 1;
+        }
+    }
+
+    // ---------- 启动开销 ----------
+    std::cout << "=== 启动开销 ===" << std::endl;
+    std::cout << "共享段创建与预缺页: " << elapsed_ms(launch_time, setup_done) << " 毫秒" << std::endl;
+    std::cout << "fork账户进程:       " << elapsed_ms(setup_done, fork_done) << " 毫秒" << std::endl;
+    auto first_transfer = controller.first_transfer_time();
+    if (first_transfer.time_since_epoch().count() != 0) {
+        std::cout << "到第一笔转账完成:   " << elapsed_ms(launch_time, first_transfer)
+                  << " 毫秒" << std::endl;
+    } else {
+        std::cout << "到第一笔转账完成:   (没有转账)" << std::endl;
+    }
+
+    if (g_events_log >= 0) {
+        close(g_events_log);
+    }
+    return exit_code;
+}
@@ -1,17 +1,32 @@
 #include "banking_system/process/child_worker.h"
 #include "banking_system/common/clock.h"
-#include "banking_system/common/utils.h"
+#include "banking_system/history/history_archive.h"
+#include "banking_system/history/history_wire.h"
+#include "banking_system/ipc/shm_transport.h"
+#include "banking_system/ipc/shared_ledger.h"
+#include "banking_system/ipc/process_barrier.h"
+#include "banking_system/ipc/spanning_tree.h"
+#include "banking_system/transfer/transfer_batch.h"
 #include "labs_headers/message.h"
 #include "labs_headers/process.h"
 #include "labs_headers/log.h"
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
+#include <iostream>
+#include <string>
 #include <unistd.h>
 
 ChildWorker::ChildWorker(const ChildArguments& args)
     : self_id_(args.self_id)
     , count_nodes_(args.count_nodes)
     , initial_balance_(args.balance)
+    , ledger_mode_(SharedLedger::instance().covers(args.count_nodes - 1))
+    , done_count_(0)
+    , inbox_(kInboxBatch)
+    , shipped_(0)
+    , rewrite_(false)
+    , last_ship_(std::chrono::steady_clock::now())
 {
     init_history();
 }
@@ -24,14 +39,22 @@ void ChildWorker::run() {
 }
 
 void ChildWorker::init_history() {
-    history_.s_history_len = 1;
-    history_.s_id = self_id_;
-    std::memset(history_.s_history, 0, sizeof(history_.s_history));
-    history_.s_history[0].s_balance = initial_balance_;
+    history_.reset(self_id_, initial_balance_);
     
-    for (int i = 0; i < MAX_T; ++i) {
-        history_.s_history[i].s_time = i;
+    // 段文件在历史第一次溢出热层时才在临时目录中创建，进程退出时删除
+    history_.enable_archive(HistoryArchive::temp_path(self_id_), kHotHistoryChunks);
+    
+    // 父进程在收齐STARTED之后才提交转账，初始余额一定先于任何结算写入账本
+    if (ledger_mode_) {
+        SharedLedger::instance().open_account(self_id_, initial_balance_);
+    }
+}
+
+balance_t ChildWorker::current_balance() const {
+    if (ledger_mode_) {
+        return SharedLedger::instance().state(self_id_).s_balance;
     }
+    return now_balance(&history_);
 }
 
 void ChildWorker::send_started_and_wait() {
@@ -39,145 +62,273 @@ void ChildWorker::send_started_and_wait() {
     pid_t parent_pid = getppid();
 
     char buf[BUF_SIZE];
-    Message msg;
-    timestamp_t current = update_lamport_time();
+    lamport_time_t current = update_lamport_time();
     
-    std::snprintf(buf, BUF_SIZE, log_started_fmt, current, self_id_, 
+    std::snprintf(buf, BUF_SIZE, log_started_fmt, static_cast<int>(current), self_id_, 
                  self_pid, parent_pid, initial_balance_);
-    fill_message(&msg, STARTED, current, buf, std::strlen(buf));
-    send_multicast(&msg);
     shared_logger(buf);
 
-    Message recv_msg;
-    int count = 0;
-    
-    for (int i = 1; i < count_nodes_; i++) {
-        if (i == self_id_) continue;
-        
-        receive(i, &recv_msg);
-        update_lamport_time(recv_msg.s_header.s_local_time);
-        
-        if (recv_msg.s_header.s_magic == MESSAGE_MAGIC && 
-            recv_msg.s_header.s_type == STARTED) {
-            count++;
-        }
-    }
-    
-    if (count == count_nodes_ - 2) {
+    // 所有进程（包括父进程）参与同一个屏障，算法由启动方在fork之前选择
+    if (ProcessBarrier::instance().wait(self_id_, count_nodes_, STARTED, buf, std::strlen(buf))) {
         current = get_lamport_time();
-        std::snprintf(buf, BUF_SIZE, log_received_all_started_fmt, current, self_id_);
+        std::snprintf(buf, BUF_SIZE, log_received_all_started_fmt, 
+                     static_cast<int>(current), self_id_);
         shared_logger(buf);
     }
 }
 
 void ChildWorker::message_loop() {
-    int done_count = 0;
+    bool stopped = false;
     
-    while (true) {
-        Message req_msg;
-        receive_any(&req_msg);
-        update_lamport_time(req_msg.s_header.s_local_time);
+    while (!stopped) {
+        int count = receive_many(inbox_.data(), kInboxBatch);
         
-        if (req_msg.s_header.s_magic == MESSAGE_MAGIC && 
-            req_msg.s_header.s_type == TRANSFER) {
-            TransferOrder *order = reinterpret_cast<TransferOrder*>(req_msg.s_payload);
+        for (int i = 0; i < count; ++i) {
+            const Message& req_msg = inbox_[i];
+            lamport_time_t sent_time = widen_timestamp(req_msg.s_header.s_local_time, 
+                                                       get_lamport_time());
+            update_lamport_time(sent_time);
             
-            if (order->s_src == self_id_) {
-                handle_transfer_as_source(order);
+            if (req_msg.s_header.s_magic != MESSAGE_MAGIC) {
+                continue;
             }
-            else if (order->s_dst == self_id_) {
-                handle_transfer_as_destination(order, req_msg.s_header.s_local_time);
-            }
-        }
-        else if (req_msg.s_header.s_magic == MESSAGE_MAGIC && 
-                 req_msg.s_header.s_type == STOP) {
-            timestamp_t current = update_lamport_time(req_msg.s_header.s_local_time);
             
-            char buf[BUF_SIZE];
-            std::snprintf(buf, BUF_SIZE, log_done_fmt, 
-                        current, self_id_, now_balance(&history_));
-            shared_logger(buf);
-            
-            Message response_msg;
-            fill_message(&response_msg, DONE, current, buf, std::strlen(buf));
-            send_multicast(&response_msg);
-            break;
+            if (req_msg.s_header.s_type == TRANSFER ||
+                req_msg.s_header.s_type == TRANSFER_BATCH) {
+                TaggedTransferOrder single;
+                const TaggedTransferOrder *orders = nullptr;
+                size_t order_count = 0;
+                if (req_msg.s_header.s_type == TRANSFER) {
+                    if (read_tagged_order(&req_msg, &single)) {
+                        orders = &single;
+                        order_count = 1;
+                    }
+                } else {
+                    orders = transfer_batch_orders(&req_msg);
+                    order_count = transfer_batch_count(&req_msg);
+                }
+                if (order_count == 0) {
+                    continue;
+                }
+                
+                // 兄弟进程转来的入账批次；其余都是父进程下发的订单，
+                // 由源账户逐笔检查，不属于本进程的订单回传NACK
+                if (orders[0].s_order.s_src != self_id_ && orders[0].s_order.s_dst == self_id_) {
+                    handle_transfer_as_destination(orders, order_count, sent_time);
+                } else {
+                    handle_transfer_as_source(orders, order_count);
+                }
+            }
+            else if (req_msg.s_header.s_type == STOP) {
+                handle_stop(req_msg);
+                stopped = true;
+            }
         }
-        else if (req_msg.s_header.s_magic == MESSAGE_MAGIC && 
-                 req_msg.s_header.s_type == DONE) {
-            done_count++;
+        
+        if (!stopped) {
+            ship_history_delta();
         }
     }
 }
 
+void ChildWorker::handle_stop(const Message& msg) {
+    lamport_time_t current = receive_lamport_time(msg.s_header.s_local_time);
+    
+    char buf[BUF_SIZE];
+    std::snprintf(buf, BUF_SIZE, log_done_fmt, 
+                static_cast<int>(current), self_id_, current_balance());
+    shared_logger(buf);
+    done_line_ = buf;
+    
+    // STOP沿生成树向下转发：每个进程只从树上的父节点收到一次
+    SpanningTree tree(self_id_, count_nodes_);
+    Message stop_msg;
+    fill_message(&stop_msg, STOP, wire_timestamp(current), nullptr, 0);
+    for (int k = 0; k < tree.child_count(); ++k) {
+        send(tree.child(k), &stop_msg);
+    }
+}
+
 void ChildWorker::wait_all_done() {
-    int count = 0;
+    SpanningTree tree(self_id_, count_nodes_);
+    
+    // 汇合：子树内全部完成后向树上的父节点报告，DONE携带本进程的完成日志
+    receive_done(tree.child_count());
+    Message done_msg;
+    lamport_time_t current = update_lamport_time();
+    fill_message(&done_msg, DONE, wire_timestamp(current),
+                 const_cast<char*>(done_line_.data()), done_line_.size());
+    send(tree.parent(), &done_msg);
+    
+    // 释放：父节点只有在整棵树都完成后才会回发DONE，
+    // 因此第 child_count()+1 个DONE一定来自父节点，不需要区分发送方
+    receive_done(tree.child_count() + 1);
+    current = update_lamport_time();
+    fill_message(&done_msg, DONE, wire_timestamp(current), nullptr, 0);
+    for (int k = 0; k < tree.child_count(); ++k) {
+        send(tree.child(k), &done_msg);
+    }
+    
+    char buf[BUF_SIZE];
+    std::snprintf(buf, BUF_SIZE, log_received_all_done_fmt, static_cast<int>(current), self_id_);
+    shared_logger(buf);
+}
 
-    while (count != count_nodes_ - 2) {
-        Message msg;
-        receive_any(&msg);
-        update_lamport_time(msg.s_header.s_local_time);
+void ChildWorker::receive_done(int target) {
+    while (done_count_ < target) {
+        int count = receive_many(inbox_.data(), kInboxBatch);
         
-        if (msg.s_header.s_magic == MESSAGE_MAGIC && 
-            msg.s_header.s_type == DONE) {
-            count++;
+        for (int i = 0; i < count; ++i) {
+            const Message& msg = inbox_[i];
+            receive_lamport_time(msg.s_header.s_local_time);
+            
+            if (msg.s_header.s_magic == MESSAGE_MAGIC && 
+                msg.s_header.s_type == DONE) {
+                done_count_++;
+            }
         }
     }
+}
 
-    if (count == count_nodes_ - 2) {
-        timestamp_t current = get_lamport_time();
-        char buf[BUF_SIZE];
-        std::snprintf(buf, BUF_SIZE, log_received_all_done_fmt, current, self_id_);
-        shared_logger(buf);
+void ChildWorker::ship_history_delta() {
+    // 最后一个变化点可能还会被同一时刻的事件覆盖，只发送之前已封存的部分
+    size_t sealed = history_.size() - 1;
+    if (sealed <= shipped_) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (sealed - shipped_ < MAX_SEGMENT_STATES && now - last_ship_ < kShipInterval) {
+        return;
     }
+    
+    Message delta_msg;
+    while (shipped_ < sealed) {
+        lamport_time_t current = update_lamport_time();
+        shipped_ += fill_history_segment(&delta_msg, wire_timestamp(current), history_,
+                                         shipped_, sealed, false, rewrite_);
+        rewrite_ = false;
+        send(0, &delta_msg);
+    }
+    last_ship_ = now;
 }
 
 void ChildWorker::send_history() {
+    // 账本模式下本地历史只有初始余额，以账本中的日志为准从头发送
+    if (ledger_mode_ && SharedLedger::instance().export_history(self_id_, &history_)) {
+        rewrite_ = shipped_ != 0;
+        shipped_ = 0;
+    }
+    
+    // 增量发送之后剩余的变化点和结束时间作为最后一段（水位线），至少发送一段
     Message history_msg;
-    timestamp_t current = update_lamport_time();
-    fill_message(&history_msg, BALANCE_HISTORY, current, 
-               &history_, sizeof(history_));
-    send(0, &history_msg);
+    do {
+        lamport_time_t current = update_lamport_time();
+        shipped_ += fill_history_segment(&history_msg, wire_timestamp(current), history_,
+                                         shipped_, history_.size(), true, rewrite_);
+        rewrite_ = false;
+        send(0, &history_msg);
+    } while (shipped_ < history_.size());
 }
 
-void ChildWorker::handle_transfer_as_source(const TransferOrder* order) {
-    timestamp_t current = update_lamport_time();
-    
-    update_history(&history_, current, current, 
-                 now_balance(&history_) - order->s_amount, 0);
+void ChildWorker::handle_transfer_as_source(const TaggedTransferOrder* orders, size_t count) {
+    lamport_time_t current = update_lamport_time();
     
+    int total = 0;
     char buf[BUF_SIZE];
-    std::snprintf(buf, BUF_SIZE, log_transfer_out_fmt, 
-                current, self_id_, order->s_amount, order->s_dst);
-    shared_logger(buf);
+    for (size_t i = 0; i < count; ++i) {
+        // 目标ID来自线上消息，用作 outbox_ 下标之前先检查
+        const TransferOrder& order = orders[i].s_order;
+        if (order.s_src != self_id_ || order.s_dst <= PARENT_ID || order.s_dst > MAX_PROCESS_ID ||
+            order.s_dst >= count_nodes_ || order.s_dst == self_id_) {
+            std::cerr << "错误: 进程 " << static_cast<int>(self_id_) << " 收到无效订单 "
+                      << static_cast<int>(order.s_src) << " -> " << static_cast<int>(order.s_dst)
+                      << std::endl;
+            rejected_.push_back({{static_cast<account_id_t>(order.s_src),
+                                  static_cast<account_id_t>(order.s_dst), order.s_amount},
+                                 orders[i].s_correlation_id});
+            continue;
+        }
+        total += order.s_amount;
+        outbox_[order.s_dst].push_back(orders[i]);
+        
+        std::snprintf(buf, BUF_SIZE, log_transfer_out_fmt, 
+                    static_cast<int>(current), self_id_, order.s_amount, order.s_dst);
+        shared_logger(buf);
+    }
+    
+    update_history(&history_, current, current, 
+                 now_balance(&history_) - total, 0);
     
     Message response_msg;
-    fill_message(&response_msg, TRANSFER, current, 
-               const_cast<TransferOrder*>(order), sizeof(TransferOrder));
-    send(order->s_dst, &response_msg);
+    for (int dst = 0; dst <= MAX_PROCESS_ID; ++dst) {
+        std::vector<TaggedTransferOrder>& group = outbox_[dst];
+        if (group.empty()) continue;
+        
+        if (group.size() == 1) {
+            fill_message(&response_msg, TRANSFER, wire_timestamp(current), 
+                       &group[0], sizeof(TaggedTransferOrder));
+        } else {
+            fill_transfer_batch(&response_msg, wire_timestamp(current), 
+                                group.data(), group.size());
+        }
+        send(static_cast<local_id>(dst), &response_msg);
+        group.clear();
+    }
+    
+    send_rejects(current);
+}
+
+void ChildWorker::send_rejects(lamport_time_t current) {
+    // 父进程仍在等被拒绝订单的ACK：逐批回传NACK，让它按失败完成
+    Message reject_msg;
+    for (size_t first = 0; first < rejected_.size(); first += MAX_ACCOUNT_BATCH_ORDERS) {
+        size_t chunk = std::min(MAX_ACCOUNT_BATCH_ORDERS, rejected_.size() - first);
+        fill_transfer_reject(&reject_msg, wire_timestamp(current), &rejected_[first], chunk);
+        send(PARENT_ID, &reject_msg);
+    }
+    rejected_.clear();
 }
 
-void ChildWorker::handle_transfer_as_destination(const TransferOrder* order, 
-                                                 timestamp_t received_time) {
-    timestamp_t current = update_lamport_time(received_time);
+void ChildWorker::handle_transfer_as_destination(const TaggedTransferOrder* orders, size_t count,
+                                                 lamport_time_t received_time) {
+    lamport_time_t current = update_lamport_time(received_time);
     
-    update_history(&history_, 
-                 received_time,
-                 current,
-                 now_balance(&history_) + order->s_amount,
-                 order->s_amount);
+    int total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += orders[i].s_order.s_amount;
+        ack_ids_.push_back(orders[i].s_correlation_id);
+    }
+    
+    size_t modified = update_history(&history_, 
+                                     received_time,
+                                     current,
+                                     now_balance(&history_) + total,
+                                     total);
+    if (modified < shipped_) {
+        // 发送时间早于已发送的变化点：从第一个被修改处重发
+        shipped_ = modified;
+        rewrite_ = true;
+    }
     
     char buf[BUF_SIZE];
-    std::snprintf(buf, BUF_SIZE, log_transfer_in_fmt, 
-                current, self_id_, order->s_amount, order->s_src);
-    shared_logger(buf);
+    for (size_t i = 0; i < count; ++i) {
+        std::snprintf(buf, BUF_SIZE, log_transfer_in_fmt, 
+                    static_cast<int>(current), self_id_, orders[i].s_order.s_amount, orders[i].s_order.s_src);
+        shared_logger(buf);
+    }
     
+    // 在ACK中回传关联ID，父进程据此乱序完成转账
     Message response_msg;
-    fill_message(&response_msg, ACK, current, nullptr, 0);
+    if (count == 1 && ack_ids_[0] == 0) {
+        fill_message(&response_msg, ACK, wire_timestamp(current), nullptr, 0);
+    } else {
+        fill_batch_ack(&response_msg, wire_timestamp(current), ack_ids_.data(), ack_ids_.size());
+    }
     send(0, &response_msg);
+    ack_ids_.clear();
 }
 
 void child_work(struct child_arguments args) {
-    ChildWorker worker(args);
+    ChildWorker worker(ChildArguments{args.self_id, args.count_nodes, args.balance});
     worker.run();
 }
\ No newline at end of file
@@ -0,0 +1,369 @@
+#include "banking_system/process/multi_account_worker.h"
+#include "banking_system/common/clock.h"
+#include "banking_system/history/history_wire.h"
+#include "banking_system/ipc/shm_transport.h"
+#include "banking_system/ipc/shared_ledger.h"
+#include "banking_system/ipc/process_barrier.h"
+#include "banking_system/ipc/spanning_tree.h"
+#include "labs_headers/message.h"
+#include "labs_headers/log.h"
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <unistd.h>
+
+MultiAccountWorker::MultiAccountWorker(const MultiAccountArguments& args)
+    : self_id_(args.self_id)
+    , count_nodes_(args.count_nodes)
+    , directory_(args.directory)
+    , first_account_(args.directory.first_account(args.self_id))
+    , initial_balance_(args.balance)
+    , ledger_mode_(SharedLedger::instance().covers(args.directory.accounts()))
+    , done_count_(0)
+    , inbox_(kInboxBatch)
+    , senders_(kInboxBatch)
+    , last_ship_(std::chrono::steady_clock::now())
+{
+    account_id_t count = directory_.account_count(self_id_);
+    SharedLedger& ledger = SharedLedger::instance();
+    histories_.reserve(count);
+    for (account_id_t slot = 0; slot < count; ++slot) {
+        histories_.emplace_back(first_account_ + slot);
+        histories_.back().reset(first_account_ + slot, initial_balance_);
+        if (ledger_mode_) {
+            ledger.open_account(first_account_ + slot, initial_balance_);
+        }
+    }
+    shipped_.assign(count, 0);
+    rewrite_.assign(count, 0);
+    is_dirty_.assign(count, 0);
+    credit_.assign(count, 0);
+}
+
+void MultiAccountWorker::run() {
+    send_started_and_wait();
+    message_loop();
+    wait_all_done();
+    send_history();
+}
+
+int64_t MultiAccountWorker::total_at(lamport_time_t time) const {
+    int64_t total = 0;
+    for (const ScalableBalanceHistory& history : histories_) {
+        total += history.state_at(time).s_balance;
+    }
+    return total;
+}
+
+int64_t MultiAccountWorker::hosted_balance() const {
+    const SharedLedger& ledger = SharedLedger::instance();
+    int64_t total = 0;
+    for (const ScalableBalanceHistory& history : histories_) {
+        total += ledger_mode_ ? ledger.state(history.id()).s_balance : now_balance(&history);
+    }
+    return total;
+}
+
+void MultiAccountWorker::mark_dirty(account_id_t account) {
+    uint32_t slot = account - first_account_;
+    if (!is_dirty_[slot]) {
+        is_dirty_[slot] = 1;
+        dirty_.push_back(slot);
+    }
+}
+
+void MultiAccountWorker::send_started_and_wait() {
+    pid_t self_pid = getpid();
+    pid_t parent_pid = getppid();
+
+    char buf[BUF_SIZE];
+    lamport_time_t current = update_lamport_time();
+
+    std::snprintf(buf, BUF_SIZE, log_started_fmt, static_cast<int>(current), self_id_,
+                 self_pid, parent_pid, static_cast<int>(hosted_balance()));
+    shared_logger(buf);
+
+    if (ProcessBarrier::instance().wait(self_id_, count_nodes_, STARTED, buf, std::strlen(buf))) {
+        current = get_lamport_time();
+        std::snprintf(buf, BUF_SIZE, log_received_all_started_fmt,
+                     static_cast<int>(current), self_id_);
+        shared_logger(buf);
+    }
+}
+
+void MultiAccountWorker::message_loop() {
+    bool stopped = false;
+
+    while (!stopped) {
+        int count = receive_many(inbox_.data(), kInboxBatch, senders_.data());
+
+        for (int i = 0; i < count; ++i) {
+            const Message& req_msg = inbox_[i];
+            lamport_time_t sent_time = widen_timestamp(req_msg.s_header.s_local_time,
+                                                       get_lamport_time());
+            update_lamport_time(sent_time);
+
+            if (req_msg.s_header.s_magic != MESSAGE_MAGIC) {
+                continue;
+            }
+
+            if (req_msg.s_header.s_type == ACCOUNT_TRANSFER_BATCH) {
+                // 父进程只把订单发给源账户所在进程，其他工作进程转发的都是入账
+                if (senders_[i] == PARENT_ID) {
+                    handle_transfer_as_source(req_msg);
+                } else {
+                    handle_transfer_as_destination(req_msg, sent_time);
+                }
+            }
+            else if (req_msg.s_header.s_type == STOP) {
+                handle_stop(req_msg);
+                stopped = true;
+            }
+        }
+
+        if (!stopped) {
+            ship_history_delta();
+        }
+    }
+}
+
+void MultiAccountWorker::handle_stop(const Message& msg) {
+    lamport_time_t current = receive_lamport_time(msg.s_header.s_local_time);
+
+    char buf[BUF_SIZE];
+    std::snprintf(buf, BUF_SIZE, log_done_fmt,
+                static_cast<int>(current), self_id_, static_cast<int>(hosted_balance()));
+    shared_logger(buf);
+    done_line_ = buf;
+
+    // STOP沿生成树向下转发：每个进程只从树上的父节点收到一次
+    SpanningTree tree(self_id_, count_nodes_);
+    Message stop_msg;
+    fill_message(&stop_msg, STOP, wire_timestamp(current), nullptr, 0);
+    for (int k = 0; k < tree.child_count(); ++k) {
+        send(tree.child(k), &stop_msg);
+    }
+}
+
+void MultiAccountWorker::wait_all_done() {
+    SpanningTree tree(self_id_, count_nodes_);
+
+    // 汇合：子树内全部完成后向树上的父节点报告，DONE携带本进程的完成日志
+    receive_done(tree.child_count());
+    Message done_msg;
+    lamport_time_t current = update_lamport_time();
+    fill_message(&done_msg, DONE, wire_timestamp(current),
+                 const_cast<char*>(done_line_.data()), done_line_.size());
+    send(tree.parent(), &done_msg);
+
+    // 释放：父节点只有在整棵树都完成后才会回发DONE，
+    // 因此第 child_count()+1 个DONE一定来自父节点，不需要区分发送方
+    receive_done(tree.child_count() + 1);
+    current = update_lamport_time();
+    fill_message(&done_msg, DONE, wire_timestamp(current), nullptr, 0);
+    for (int k = 0; k < tree.child_count(); ++k) {
+        send(tree.child(k), &done_msg);
+    }
+
+    char buf[BUF_SIZE];
+    std::snprintf(buf, BUF_SIZE, log_received_all_done_fmt, static_cast<int>(current), self_id_);
+    shared_logger(buf);
+}
+
+void MultiAccountWorker::receive_done(int target) {
+    while (done_count_ < target) {
+        int count = receive_many(inbox_.data(), kInboxBatch);
+
+        for (int i = 0; i < count; ++i) {
+            const Message& msg = inbox_[i];
+            receive_lamport_time(msg.s_header.s_local_time);
+
+            if (msg.s_header.s_magic == MESSAGE_MAGIC &&
+                msg.s_header.s_type == DONE) {
+                done_count_++;
+            }
+        }
+    }
+}
+
+void MultiAccountWorker::ship_history_delta() {
+    if (dirty_.empty()) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_ship_ < kShipInterval) {
+        return;
+    }
+
+    // 最后一个变化点可能还会被同一时刻的事件覆盖，只发送之前已封存的部分；
+    // 未封存的部分在账户下次变化或最后一段中发送
+    Message delta_msg;
+    for (uint32_t slot : dirty_) {
+        is_dirty_[slot] = 0;
+        const ScalableBalanceHistory& history = histories_[slot];
+        size_t sealed = history.size() - 1;
+        while (shipped_[slot] < sealed) {
+            lamport_time_t current = update_lamport_time();
+            shipped_[slot] += fill_history_segment(&delta_msg, wire_timestamp(current), history,
+                                                   shipped_[slot], sealed, false, rewrite_[slot]);
+            rewrite_[slot] = 0;
+            send(PARENT_ID, &delta_msg);
+        }
+    }
+    dirty_.clear();
+    last_ship_ = now;
+}
+
+void MultiAccountWorker::send_history() {
+    // 每个托管账户至少发送一段（带水位线），父进程据此判断该账户收齐；
+    // 账本模式下以账本中的日志为准从头发送
+    const SharedLedger& ledger = SharedLedger::instance();
+    Message history_msg;
+    for (size_t slot = 0; slot < histories_.size(); ++slot) {
+        ScalableBalanceHistory& history = histories_[slot];
+        if (ledger_mode_ && ledger.export_history(history.id(), &history)) {
+            rewrite_[slot] = shipped_[slot] != 0;
+            shipped_[slot] = 0;
+        }
+        do {
+            lamport_time_t current = update_lamport_time();
+            shipped_[slot] += fill_history_segment(&history_msg, wire_timestamp(current), history,
+                                                   shipped_[slot], history.size(), true,
+                                                   rewrite_[slot]);
+            rewrite_[slot] = 0;
+            send(PARENT_ID, &history_msg);
+        } while (shipped_[slot] < history.size());
+    }
+}
+
+void MultiAccountWorker::handle_transfer_as_source(const Message& msg) {
+    lamport_time_t current = update_lamport_time();
+    size_t count = account_transfer_batch_count(&msg);
+
+    for (size_t i = 0; i < count; ++i) {
+        TaggedAccountTransfer order = account_transfer_batch_order(&msg, i);
+        account_id_t src = order.s_order.s_src;
+        account_id_t dst = order.s_order.s_dst;
+        if (!hosts(src) || !directory_.contains(dst)) {
+            std::cerr << "错误: 进程 " << static_cast<int>(self_id_) << " 收到无效订单 "
+                      << src << " -> " << dst << std::endl;
+            rejected_.push_back(order);
+            continue;
+        }
+
+        ScalableBalanceHistory& source = history_of(src);
+        update_history(&source, current, current,
+                     now_balance(&source) - order.s_order.s_amount, 0);
+        mark_dirty(src);
+
+        if (hosts(dst)) {
+            // 两端都在本进程：进程内结算，没有在途区间
+            ScalableBalanceHistory& target = history_of(dst);
+            update_history(&target, current, current,
+                         now_balance(&target) + order.s_order.s_amount, 0);
+            mark_dirty(dst);
+            ack_ids_.push_back(order.s_correlation_id);
+        } else {
+            outbox_[directory_.worker_of(dst)].push_back(order);
+        }
+    }
+
+    if (!ack_ids_.empty()) {
+        send_acks(current);
+    }
+    if (!rejected_.empty()) {
+        send_rejects(current);
+    }
+
+    Message forward_msg;
+    for (int dst = 1; dst <= MAX_PROCESS_ID; ++dst) {
+        std::vector<TaggedAccountTransfer>& group = outbox_[dst];
+        if (group.empty()) continue;
+
+        fill_account_transfer_batch(&forward_msg, wire_timestamp(current),
+                                    group.data(), group.size());
+        send(static_cast<local_id>(dst), &forward_msg);
+        group.clear();
+    }
+}
+
+void MultiAccountWorker::handle_transfer_as_destination(const Message& msg,
+                                                        lamport_time_t received_time) {
+    lamport_time_t current = update_lamport_time(received_time);
+    size_t count = account_transfer_batch_count(&msg);
+
+    // 同一账户的多笔入账先合并，每个账户只更新一次历史，在途金额才完整
+    for (size_t i = 0; i < count; ++i) {
+        TaggedAccountTransfer order = account_transfer_batch_order(&msg, i);
+        account_id_t dst = order.s_order.s_dst;
+        if (!hosts(dst)) {
+            std::cerr << "错误: 进程 " << static_cast<int>(self_id_) << " 不托管目标账户 "
+                      << dst << std::endl;
+            rejected_.push_back(order);
+            continue;
+        }
+        uint32_t slot = dst - first_account_;
+        // 入账合计和入账后的余额都要能放进 balance_t（在途金额同样是 balance_t）：
+        // 超出时拒绝这笔订单，而不是在下面的转换中静默截断
+        int32_t credit = credit_[slot] + order.s_order.s_amount;
+        int32_t balance = now_balance(&histories_[slot]) + credit;
+        if (credit < std::numeric_limits<balance_t>::min() ||
+            credit > std::numeric_limits<balance_t>::max() ||
+            balance < std::numeric_limits<balance_t>::min() ||
+            balance > std::numeric_limits<balance_t>::max()) {
+            std::cerr << "错误: 账户 " << dst << " 入账 " << order.s_order.s_amount
+                      << " 后余额超出范围，拒绝订单" << std::endl;
+            rejected_.push_back(order);
+            continue;
+        }
+        if (credit_[slot] == 0) {
+            credited_.push_back(slot);
+        }
+        credit_[slot] = credit;
+        ack_ids_.push_back(order.s_correlation_id);
+    }
+
+    for (uint32_t slot : credited_) {
+        ScalableBalanceHistory& target = histories_[slot];
+        balance_t total = static_cast<balance_t>(credit_[slot]);  // 入队时已检查范围
+        size_t modified = update_history(&target, received_time, current,
+                                         now_balance(&target) + total, total);
+        if (modified < shipped_[slot]) {
+            // 发送时间早于已发送的变化点：从第一个被修改处重发
+            shipped_[slot] = modified;
+            rewrite_[slot] = 1;
+        }
+        mark_dirty(first_account_ + slot);
+        credit_[slot] = 0;
+    }
+    credited_.clear();
+
+    if (!ack_ids_.empty()) {
+        send_acks(current);
+    }
+    if (!rejected_.empty()) {
+        send_rejects(current);
+    }
+}
+
+void MultiAccountWorker::send_acks(lamport_time_t time) {
+    // 一条入站消息最多 MAX_ACCOUNT_BATCH_ORDERS 笔，累计ACK总能放入单条消息
+    Message response_msg;
+    fill_batch_ack(&response_msg, wire_timestamp(time), ack_ids_.data(), ack_ids_.size());
+    send(PARENT_ID, &response_msg);
+    ack_ids_.clear();
+}
+
+void MultiAccountWorker::send_rejects(lamport_time_t time) {
+    // 被拒绝的订单来自同一条入站消息，单条NACK总能放下
+    Message reject_msg;
+    fill_transfer_reject(&reject_msg, wire_timestamp(time), rejected_.data(), rejected_.size());
+    send(PARENT_ID, &reject_msg);
+    rejected_.clear();
+}
+
+void multi_account_work(const MultiAccountArguments& args) {
+    MultiAccountWorker worker(args);
+    worker.run();
+}
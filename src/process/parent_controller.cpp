@@ -1,20 +1,42 @@
 #include "banking_system/process/parent_controller.h"
 #include "banking_system/shard/shard_manager.h"
 #include "banking_system/common/clock.h"
+#include "banking_system/ipc/shm_transport.h"
+#include "banking_system/ipc/shared_ledger.h"
+#include "banking_system/ipc/process_barrier.h"
+#include "banking_system/ipc/spanning_tree.h"
+#include "banking_system/history/history_aggregator.h"
 #include "labs_headers/message.h"
 #include "labs_headers/process.h"
 #include "labs_headers/banking.h"
 #include "labs_headers/log.h"
 #include <iostream>
+#include <fstream>
 #include <cstring>
 #include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
 
-ParentController::ParentController(int count_nodes, int num_shards)
+ParentController::ParentController(int count_nodes, int num_shards, account_id_t accounts,
+                                   ClockMode clock_mode)
     : count_nodes_(count_nodes)
     , num_shards_(num_shards)
+    , clock_mode_(clock_mode)
+    , multi_account_(accounts != 0)
+    , directory_(multi_account_ ? accounts : static_cast<account_id_t>(count_nodes - 1),
+                 count_nodes - 1)
+    , history_(directory_)
+    , inbox_(kCollectBatch)
+    , senders_(kCollectBatch)
+    , report_path_(kHistoryReportPath)
 {
 }
 
+void ParentController::set_report_directory(const std::string& directory) {
+    report_path_ = directory.empty() ? kHistoryReportPath : directory + "/" + kHistoryReportPath;
+}
+
 void ParentController::run() {
     phase1_wait_startup();
     phase2_execute_transfers();
@@ -24,10 +46,9 @@ void ParentController::run() {
 
 void ParentController::phase1_wait_startup() {
     std::cout << "=== 阶段1: 等待所有账户启动 ===" << std::endl;
-    for (int i = 1; i < count_nodes_; i++) {
-        Message msg;
-        receive(i, &msg);
-        update_lamport_time(msg.s_header.s_local_time);
+    ProcessBarrier& barrier = ProcessBarrier::instance();
+    if (!barrier.wait(PARENT_ID, count_nodes_, STARTED)) {
+        std::cerr << "✗ 启动屏障 (" << ProcessBarrier::name(barrier.algorithm()) << ") 失败" << std::endl;
     }
     std::cout << "所有账户已就绪！\n" << std::endl;
 }
@@ -37,19 +58,38 @@ void ParentController::phase2_execute_transfers() {
     
     auto start_time = std::chrono::high_resolution_clock::now();
     
+    // 共享账本（由启动方在fork之前创建）必须覆盖全部账户才能启用快速路径，
+    // 账户进程按同一条件决定是否从账本导出历史
+    SharedLedger* ledger = nullptr;
+    if (SharedLedger::instance().covers(directory_.accounts())) {
+        ledger = &SharedLedger::instance();
+    } else if (SharedLedger::instance().active()) {
+        std::cerr << "错误: 共享账本只覆盖 " << SharedLedger::instance().accounts()
+                  << " 个账户，少于 " << directory_.accounts() << " 个，改用消息路径" << std::endl;
+    }
+    
     {
-        ShardManager manager(num_shards_);
+        ShardManager manager(num_shards_, AccountShard::kDefaultMaxInFlight, 
+                             clock_mode_, &history_,
+                             multi_account_ ? &directory_ : nullptr, ledger);
+        
+        std::vector<AccountTransfer> transfers = workload_.empty() ? default_workload() : workload_;
         
         std::cout << "提交转账任务..." << std::endl;
-        for (int i = 1; i < count_nodes_ - 1; ++i) {
-            manager.submit_transfer(i, i + 1, i);
-        }
-        if (count_nodes_ - 1 > 1) {
-            manager.submit_transfer(count_nodes_ - 1, 1, 1);
+        // 第一笔单独异步提交，以其完成时刻作为启动开销的终点；其余整批提交，不等待第一笔
+        TransferHandle first;
+        auto first_submitted = std::chrono::steady_clock::now();
+        if (!transfers.empty()) {
+            first = manager.submit_transfer_async(transfers[0].s_src, transfers[0].s_dst,
+                                                  transfers[0].s_amount);
+            manager.submit_transfers(transfers.data() + 1, transfers.size() - 1);
         }
         
         std::cout << "等待所有分片完成...\n" << std::endl;
         manager.wait_all_complete();
+        if (first.valid()) {
+            first_transfer_ = first_submitted + first.get().latency;
+        }
         
         manager.print_statistics();
         
@@ -61,17 +101,56 @@ void ParentController::phase2_execute_transfers() {
     std::cout << "\n总耗时: " << duration.count() << " 毫秒\n" << std::endl;
 }
 
+std::vector<AccountTransfer> ParentController::default_workload() const {
+    // 账户环：i -> i+1，最后一个账户转回账户1。一个进程一个账户时金额为 i，
+    // 多账户模式下金额在 1..MAX_PROCESS_ID 之间循环
+    account_id_t accounts = directory_.accounts();
+    std::vector<AccountTransfer> transfers;
+    transfers.reserve(accounts);
+    for (account_id_t i = 1; i < accounts; ++i) {
+        balance_t amount = multi_account_ ? static_cast<balance_t>((i - 1) % MAX_PROCESS_ID + 1)
+                                          : static_cast<balance_t>(i);
+        transfers.push_back({i, i + 1, amount});
+    }
+    if (accounts > 1) {
+        transfers.push_back({accounts, 1, 1});
+    }
+    return transfers;
+}
+
 void ParentController::phase3_stop_all() {
     std::cout << "=== 阶段3: 通知所有账户停止 ===" << std::endl;
+    
+    // 终止检测：STOP沿生成树向下传播，DONE沿树向上汇合，
+    // 根只需等自己的子节点，不再向每个账户发送、从每个账户接收
+    SpanningTree tree(PARENT_ID, count_nodes_);
     Message msg;
-    timestamp_t current = update_lamport_time();
-    fill_message(&msg, STOP, current, nullptr, 0);
-    send_multicast(&msg);
+    lamport_time_t current = update_lamport_time();
+    fill_message(&msg, STOP, wire_timestamp(current), nullptr, 0);
+    for (int k = 0; k < tree.child_count(); ++k) {
+        send(tree.child(k), &msg);
+    }
+
+    // 按到达顺序接收：DONE之前可能还有历史增量
+    int done_count = 0;
+    while (done_count < tree.child_count()) {
+        int count = collect_batch();
+        if (count < 0) {
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            const Message& in = inbox_[i];
+            if (in.s_header.s_magic == MESSAGE_MAGIC && in.s_header.s_type == DONE) {
+                ++done_count;
+            }
+        }
+    }
 
-    for (int i = 1; i < count_nodes_; i++) {
-        Message msg;
-        receive(i, &msg);
-        update_lamport_time(msg.s_header.s_local_time);
+    // 整棵树都已完成，沿树回发DONE，各账户收到后记录 received all DONE
+    current = update_lamport_time();
+    fill_message(&msg, DONE, wire_timestamp(current), nullptr, 0);
+    for (int k = 0; k < tree.child_count(); ++k) {
+        send(tree.child(k), &msg);
     }
     std::cout << "所有账户已停止\n" << std::endl;
 }
@@ -79,26 +158,64 @@ void ParentController::phase3_stop_all() {
 void ParentController::phase4_collect_history() {
     std::cout << "=== 阶段4: 收集余额历史记录 ===" << std::endl;
     
-    AllHistory all_history;
-    all_history.s_history_len = count_nodes_ - 1;
+    // 大部分历史已在转账期间增量到达，这里只等每个账户带水位线的最后一段；
+    // 哪个账户先到就先解码哪个，不按账户ID顺序阻塞
+    while (!history_.all_complete()) {
+        if (collect_batch() < 0) {
+            break;
+        }
+    }
     
-    for (int i = 1; i < count_nodes_; i++) {
-        Message msg;
-        receive(i, &msg);
-        update_lamport_time(msg.s_header.s_local_time);
-        
-        if (msg.s_header.s_magic == MESSAGE_MAGIC && 
-            msg.s_header.s_type == BALANCE_HISTORY) {
-            BalanceHistory *history = reinterpret_cast<BalanceHistory*>(msg.s_payload);
-            std::memcpy(&all_history.s_history[i - 1], history, 
-                       msg.s_header.s_payload_len);
+    std::vector<const ScalableBalanceHistory*> histories;
+    histories.reserve(history_.accounts());
+    for (account_id_t account = 1; account <= history_.accounts(); ++account) {
+        if (!history_.complete(account)) {
+            std::cerr << "✗ 账户 " << account << " 的余额历史不完整" << std::endl;
         }
+        histories.push_back(&history_.history(account));
     }
     
-    print_history(&all_history);
+    // 历史已收齐、不再变化，可以建立时间点查询索引
+    index_.reset(new HistoryIndex(histories));
+    
+    // 全账户汇总和守恒检查在本进程内完成，不再依赖外部库的 print_history
+    HistoryAggregator aggregator(std::move(histories));
+    aggregator.run();
+    aggregator.print_table(std::cout, kTableTicks);
+    
+    std::ofstream report(report_path_);
+    if (report) {
+        aggregator.write_report(report);
+        std::cout << "余额历史报告已写入 " << report_path_ << std::endl;
+    } else {
+        std::cerr << "✗ 无法写入余额历史报告 " << report_path_ << std::endl;
+    }
+}
+
+balance_t ParentController::balance_at(account_id_t account, lamport_time_t time) const {
+    return index_ ? index_->balance_at(account, time) : 0;
+}
+
+int64_t ParentController::total_at(lamport_time_t time) const {
+    return index_ ? index_->total_at(time) : 0;
+}
+
+int ParentController::collect_batch() {
+    int count = receive_many(inbox_.data(), kCollectBatch, senders_.data());
+    if (count <= 0) {
+        return count;
+    }
+    for (int i = 0; i < count; ++i) {
+        receive_lamport_time(inbox_[i].s_header.s_local_time);
+    }
+    size_t rejected = history_.apply_batch(senders_.data(), inbox_.data(), count);
+    if (rejected > 0) {
+        std::cerr << "✗ " << rejected << " 条余额历史分段非法" << std::endl;
+    }
+    return count;
 }
 
-void parent_work(int count_nodes, int num_shards) {
-    ParentController controller(count_nodes, num_shards);
+void parent_work(int count_nodes, int num_shards, account_id_t accounts, ClockMode clock_mode) {
+    ParentController controller(count_nodes, num_shards, accounts, clock_mode);
     controller.run();
 }
\ No newline at end of file
@@ -1,25 +1,53 @@
 #include "banking_system/shard/account_shard.h"
 #include "banking_system/shard/shard_manager.h"
 #include "banking_system/common/clock.h"
+#include "banking_system/transfer/transfer_batch.h"
 #include "labs_headers/message.h"
 #include "labs_headers/process.h"
 #include "labs_headers/banking.h"
+#include "labs_headers/log.h"
+#include <cstdio>
 #include <iostream>
-#include <exception>
+#include <algorithm>
+#include <chrono>
 
-AccountShard::AccountShard(int shard_id, ShardManager* manager)
+AccountShard::AccountShard(int shard_id, int num_shards, ShardManager* manager, 
+                           size_t max_in_flight,
+                           size_t queue_capacity, ClockMode clock_mode)
     : shard_id_(shard_id)
     , manager_(manager)
+    , own_clock_(LamportClock::instance().time_source(), LamportClock::instance().physical_clock())
+    , clock_(clock_mode == ClockMode::PER_SHARD ? &own_clock_ : &LamportClock::instance())
+    , task_ring_(queue_capacity)
+    , completions_ready_(false)
+    , worker_sleeping_(false)
+    , submit_waiters_(0)
+    , spin_budget_(kMinSpin)
+    , deferred_per_target_(num_shards, 0)
+    , step2_deferred_(false)
+    , max_in_flight_(max_in_flight > 0 ? max_in_flight : 1)
+    , in_flight_(max_in_flight_)
+    , early_acks_(max_in_flight_)
+    , in_flight_order_(MAX_PROCESS_ID + 1)
     , stop_flag_(false)
     , local_transfers_(0)
     , cross_shard_transfers_(0)
     , failed_transfers_(0)
 {
+    src_groups_.resize(MAX_PROCESS_ID + 1);
+    for (int i = 0; i < num_shards; ++i) {
+        step2_inbound_.push_back(
+            std::make_unique<SpscRing<TransferTask>>(kStep2ChannelCapacity));
+    }
     worker_thread_ = std::thread(&AccountShard::worker_loop, this);
 }
 
 AccountShard::~AccountShard() {
-    stop_flag_.store(true);
+    {
+        // 持锁设置停止标志，避免工作线程在检查条件后、睡眠前错过通知
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stop_flag_.store(true);
+    }
     queue_cv_.notify_one();
     
     if (worker_thread_.joinable()) {
@@ -28,23 +56,93 @@ AccountShard::~AccountShard() {
 }
 
 void AccountShard::submit_task(const TransferTask& task) {
+    // 先计数再入队，保证计数覆盖任务的整个生命周期
+    pending_tasks_.add();
+    int spins = 0;
+    while (!task_ring_.try_push(task)) {
+        wait_for_space(spins);
+    }
+    wake_worker();
+}
+
+void AccountShard::submit_tasks(const TransferTask* tasks, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    pending_tasks_.add(count);
+    int spins = 0;
+    size_t submitted = 0;
+    while (submitted < count) {
+        size_t pushed = task_ring_.try_push_bulk(tasks + submitted, count - submitted);
+        if (pushed == 0) {
+            // 队列满之前先唤醒工作线程处理已入队的部分
+            wake_worker();
+            wait_for_space(spins);
+            continue;
+        }
+        submitted += pushed;
+        spins = 0;
+    }
+    wake_worker();
+}
+
+void AccountShard::wait_for_space(int& spins) {
+    if (spins < kMaxSpin) {
+        ++spins;
+        spin_pause();
+        return;
+    }
+    
+    // 队列已满：睡眠到工作线程出队后通知。先登记等待者再检查队列，
+    // 与 notify_submitters 的“先出队再检查等待者”配对，不会错过通知
+    std::unique_lock<std::mutex> lock(space_mutex_);
+    submit_waiters_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    space_cv_.wait(lock, [this] {
+        return !task_ring_.full_approx();
+    });
+    submit_waiters_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+bool AccountShard::try_submit_task(const TransferTask& task) {
+    pending_tasks_.add();
+    if (!task_ring_.try_push(task)) {
+        pending_tasks_.done();
+        return false;
+    }
+    wake_worker();
+    return true;
+}
+
+void AccountShard::connect_peers(const std::vector<AccountShard*>& peers) {
+    peers_ = peers;
+}
+
+bool AccountShard::offer_step2(int from_shard, const TransferTask& step2_task) {
+    pending_tasks_.add();
+    if (!step2_inbound_[from_shard]->try_push(step2_task)) {
+        pending_tasks_.done();
+        return false;
+    }
+    wake_worker();
+    return true;
+}
+
+void AccountShard::deliver_acks(const AckEvent* events, size_t count) {
     {
         std::lock_guard<std::mutex> lock(queue_mutex_);
-        task_queue_.push(task);
+        completions_.insert(completions_.end(), events, events + count);
+        completions_ready_.store(true, std::memory_order_release);
     }
     queue_cv_.notify_one();
 }
 
 void AccountShard::wait_completion() {
-    while (true) {
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            if (task_queue_.empty()) {
-                break;
-            }
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
+    pending_tasks_.wait();
+}
+
+bool AccountShard::wait_for(std::chrono::steady_clock::time_point deadline) {
+    return pending_tasks_.wait_until(deadline);
 }
 
 void AccountShard::print_statistics() {
@@ -57,29 +155,281 @@ void AccountShard::print_statistics() {
 }
 
 void AccountShard::worker_loop() {
+    std::vector<TransferTask> batch(kMaxBatchTasks);
+    std::vector<AckEvent> acks;
+    
     while (true) {
-        TransferTask task(0, 0, 0);
+        // 只有ACK分发线程投递过完成事件时才需要加锁
+        if (completions_ready_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            acks.swap(completions_);
+            completions_ready_.store(false, std::memory_order_relaxed);
+        }
         
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            
-            queue_cv_.wait(lock, [this] {
-                return stop_flag_.load() || !task_queue_.empty();
-            });
-            
-            if (stop_flag_.load() && task_queue_.empty()) {
-                break;
+        bool progress = !acks.empty();
+        for (const AckEvent& ack : acks) {
+            handle_ack(ack);
+        }
+        acks.clear();
+        
+        if (!deferred_step2_.empty()) {
+            retry_deferred_step2();
+        }
+        
+        // Step2只登记等待ACK，不发送消息，因此不受在途窗口限制
+        if (drain_step2_inbound() > 0) {
+            progress = true;
+        }
+        
+        // 窗口已满时不取新任务，只等待完成事件
+        size_t window = max_in_flight_ - std::min(max_in_flight_, in_flight_.size());
+        size_t limit = std::min(kMaxBatchTasks, window);
+        size_t count = limit > 0 ? task_ring_.pop_bulk(batch.data(), limit) : 0;
+        if (count > 0) {
+            notify_submitters();
+            process_batch(batch.data(), count);
+            progress = true;
+        }
+        
+        if (progress) {
+            continue;
+        }
+        
+        // 停止时需等在途转账、暂缓的和入站的Step2全部完成
+        if (stop_flag_.load() && task_ring_.empty_approx() && in_flight_.empty() &&
+            deferred_step2_.empty() && step2_inbound_empty() && !completions_ready_.load()) {
+            break;
+        }
+        
+        wait_for_work();
+    }
+}
+
+bool AccountShard::has_work() const {
+    if (completions_ready_.load(std::memory_order_acquire)) {
+        return true;
+    }
+    if (in_flight_.size() < max_in_flight_ && !task_ring_.empty_approx()) {
+        return true;
+    }
+    if (!step2_inbound_empty()) {
+        return true;
+    }
+    // 暂缓的Step2：目标分片出队后会唤醒本分片，这里确认它的通道确实有了空间
+    if (!deferred_step2_.empty()) {
+        for (size_t target = 0; target < deferred_per_target_.size(); ++target) {
+            if (deferred_per_target_[target] > 0 &&
+                !peers_[target]->step2_inbound_[shard_id_]->full_approx()) {
+                return true;
             }
-            
-            if (!task_queue_.empty()) {
-                task = task_queue_.front();
-                task_queue_.pop();
-            } else {
-                continue;
+        }
+    }
+    return stop_flag_.load() && in_flight_.empty();
+}
+
+bool AccountShard::step2_inbound_empty() const {
+    for (const auto& channel : step2_inbound_) {
+        if (!channel->empty_approx()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AccountShard::wait_for_work() {
+    for (int i = 0; i < spin_budget_; ++i) {
+        if (has_work()) {
+            spin_budget_ = std::min(spin_budget_ * 2, kMaxSpin);
+            return;
+        }
+        spin_pause();
+    }
+    spin_budget_ = std::max(spin_budget_ / 2, kMinSpin);
+    
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    // 先声明睡眠再复查条件，与 wake_worker 的“先入队再检查”配对，避免丢失唤醒
+    worker_sleeping_.store(true, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    queue_cv_.wait(lock, [this] { return has_work(); });
+    worker_sleeping_.store(false, std::memory_order_relaxed);
+}
+
+void AccountShard::wake_worker() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker_sleeping_.load(std::memory_order_seq_cst)) {
+        // 获取一次锁，确保工作线程已进入等待后再通知
+        { std::lock_guard<std::mutex> lock(queue_mutex_); }
+        queue_cv_.notify_one();
+    }
+}
+
+void AccountShard::notify_submitters() {
+    // 出队（释放tail）与读取等待者之间不能重排，否则可能漏掉刚登记的提交方
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (submit_waiters_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(space_mutex_);
+        space_cv_.notify_all();
+    }
+}
+
+void AccountShard::hand_off_step2(const TransferTask& step1_task) {
+    TransferTask step2_task = step1_task;
+    step2_task.task_type = TaskType::CROSS_SHARD_STEP2;
+    // 跨分片移交是一次时钟域间的“消息”，携带源分片当前时间
+    step2_task.causal_time = clock_->get_time();
+    
+    // 工作线程不能阻塞在其他分片的满通道上（对方可能也在等本分片），
+    // 因此只尝试移交，失败则暂缓到下一轮重试
+    if (!peers_[step2_task.dst_shard_id]->offer_step2(shard_id_, step2_task)) {
+        deferred_step2_.push_back(step2_task);
+        ++deferred_per_target_[step2_task.dst_shard_id];
+        step2_deferred_.store(true, std::memory_order_seq_cst);
+        return;
+    }
+    // Step2已计入目标分片，Step1到此结束
+    retire_task(false);
+}
+
+void AccountShard::retry_deferred_step2() {
+    size_t kept = 0;
+    for (const TransferTask& step2_task : deferred_step2_) {
+        if (!peers_[step2_task.dst_shard_id]->offer_step2(shard_id_, step2_task)) {
+            deferred_step2_[kept++] = step2_task;
+        } else {
+            --deferred_per_target_[step2_task.dst_shard_id];
+            retire_task(false);
+        }
+    }
+    deferred_step2_.resize(kept);
+    if (kept == 0) {
+        step2_deferred_.store(false, std::memory_order_seq_cst);
+    }
+}
+
+size_t AccountShard::drain_step2_inbound() {
+    size_t handled = 0;
+    TransferTask step2_task;
+    for (size_t from = 0; from < step2_inbound_.size(); ++from) {
+        size_t n = 0;
+        while (n < kMaxBatchTasks && step2_inbound_[from]->try_pop(step2_task)) {
+            observe_time(step2_task.causal_time);
+            handle_cross_shard_step2(step2_task);
+            ++n;
+        }
+        handled += n;
+        
+        // 腾出了通道空间：源分片有暂缓的Step2时唤醒它重试（出队与读标志之间不能重排）
+        if (n > 0) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (peers_[from]->step2_deferred_.load(std::memory_order_seq_cst)) {
+                peers_[from]->wake_worker();
+            }
+        }
+    }
+    return handled;
+}
+
+void AccountShard::process_batch(const TransferTask* batch, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const TransferTask& task = batch[i];
+        observe_time(task.causal_time);
+        if (task.task_type == TaskType::CROSS_SHARD_STEP2) {
+            process_task(task);
+        } else if (task.task_type == TaskType::LOCAL_TRANSFER &&
+                   manager_->settles_in_ledger(task.src_account, task.dst_account)) {
+            settle_in_ledger(task);
+        } else {
+            src_groups_[manager_->process_of(task.src_account)].push_back(&task);
+        }
+    }
+    
+    // 多账户模式下只有32位账户ID的批量格式，单笔也按批次发送
+    bool multi_account = manager_->multi_account();
+    for (size_t process = 0; process < src_groups_.size(); ++process) {
+        std::vector<const TransferTask*>& group = src_groups_[process];
+        if (group.empty()) continue;
+        
+        if (group.size() == 1 && !multi_account) {
+            process_task(*group[0]);
+        } else {
+            ship_source_batch(static_cast<local_id>(process), group);
+        }
+        group.clear();
+    }
+}
+
+void AccountShard::settle_in_ledger(const TransferTask& task) {
+    lamport_time_t commit_time = 0;
+    bool ok = manager_->ledger()->transfer(task.src_account, task.dst_account, task.amount,
+                                           clock_->update(), &commit_time);
+    if (ok) {
+        // 账本可能把时间戳推到两端最后一项之后，时钟跟上，之后的STOP不会早于它
+        clock_->merge(commit_time);
+        
+        // 与消息路径输出相同的事件：一个进程一个账户时账户ID即进程ID，
+        // 多账户进程的消息路径不逐笔记录转账，这里也不记录
+        if (!manager_->multi_account()) {
+            char buf[BUF_SIZE];
+            std::snprintf(buf, BUF_SIZE, log_transfer_out_fmt, static_cast<int>(commit_time),
+                          static_cast<int>(task.src_account), task.amount,
+                          static_cast<int>(task.dst_account));
+            shared_logger(buf);
+            std::snprintf(buf, BUF_SIZE, log_transfer_in_fmt, static_cast<int>(commit_time),
+                          static_cast<int>(task.dst_account), task.amount,
+                          static_cast<int>(task.src_account));
+            shared_logger(buf);
+        }
+    }
+    complete_transfer(task, ok, commit_time);
+}
+
+void AccountShard::ship_source_batch(local_id src, 
+                                     const std::vector<const TransferTask*>& tasks) {
+    bool multi_account = manager_->multi_account();
+    size_t max_orders = multi_account ? MAX_ACCOUNT_BATCH_ORDERS : MAX_BATCH_ORDERS;
+    std::vector<TaggedTransferOrder> orders;
+    std::vector<TaggedAccountTransfer> account_orders;
+    
+    for (size_t begin = 0; begin < tasks.size(); begin += max_orders) {
+        size_t end = std::min(tasks.size(), begin + max_orders);
+        
+        Message msg;
+        lamport_time_t current_time = clock_->update();
+        if (multi_account) {
+            account_orders.clear();
+            for (size_t i = begin; i < end; ++i) {
+                const TransferTask& task = *tasks[i];
+                account_orders.push_back({
+                    {task.src_account, task.dst_account, task.amount},
+                    task.correlation_id
+                });
+            }
+            fill_account_transfer_batch(&msg, wire_timestamp(current_time), 
+                                        account_orders.data(), account_orders.size());
+        } else {
+            orders.clear();
+            for (size_t i = begin; i < end; ++i) {
+                const TransferTask& task = *tasks[i];
+                orders.push_back({
+                    {static_cast<local_id>(task.src_account), 
+                     static_cast<local_id>(task.dst_account), task.amount},
+                    task.correlation_id
+                });
             }
+            fill_transfer_batch(&msg, wire_timestamp(current_time), orders.data(), orders.size());
+        }
+        if (send(src, &msg) != 0) {
+            fail_unsent(tasks.data() + begin, end - begin, src);
+            continue;
         }
         
-        process_task(task);
+        for (size_t i = begin; i < end; ++i) {
+            if (tasks[i]->task_type == TaskType::LOCAL_TRANSFER) {
+                track_in_flight(*tasks[i]);
+            } else {
+                hand_off_step2(*tasks[i]);
+            }
+        }
     }
 }
 
@@ -98,101 +448,161 @@ void AccountShard::process_task(const TransferTask& task) {
 }
 
 void AccountShard::handle_local_transfer(const TransferTask& task) {
-    try {
-        TransferOrder order = {task.src_account, task.dst_account, task.amount};
-        
-        Message msg;
-        timestamp_t current_time = update_lamport_time();
-        fill_message(&msg, TRANSFER, current_time, &order, sizeof(order));
-        send(task.src_account, &msg);
-        
-        Message ack_msg;
-        receive(task.dst_account, &ack_msg);
-        update_lamport_time(ack_msg.s_header.s_local_time);
-        
-        if (ack_msg.s_header.s_magic == MESSAGE_MAGIC && 
-            ack_msg.s_header.s_type == ACK) {
-            local_transfers_++;
-            
-            std::lock_guard<std::mutex> lock(log_mutex_);
-            std::cout << "✓ [分片" << shard_id_ << "] 本地转账: " 
-                     << static_cast<int>(task.src_account) << " → " 
-                     << static_cast<int>(task.dst_account) 
-                     << " (金额: " << static_cast<int>(task.amount) << ")" 
-                     << std::endl;
-        } else {
-            failed_transfers_++;
-            std::lock_guard<std::mutex> lock(log_mutex_);
-            std::cerr << "✗ [分片" << shard_id_ << "] 本地转账失败: 无效ACK" << std::endl;
-        }
-    } catch (const std::exception& e) {
-        failed_transfers_++;
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        std::cerr << "✗ [分片" << shard_id_ << "] 本地转账异常: " << e.what() << std::endl;
+    local_id src = static_cast<local_id>(task.src_account);
+    if (!send_single_order(task)) {
+        const TransferTask* unsent = &task;
+        fail_unsent(&unsent, 1, src);
+        return;
     }
+    track_in_flight(task);
 }
 
 void AccountShard::handle_cross_shard_step1(const TransferTask& task) {
-    try {
-        TransferOrder order = {task.src_account, task.dst_account, task.amount};
-        
-        Message msg;
-        timestamp_t current_time = update_lamport_time();
-        fill_message(&msg, TRANSFER, current_time, &order, sizeof(order));
-        send(task.src_account, &msg);
-        
-        {
-            std::lock_guard<std::mutex> lock(log_mutex_);
-            std::cout << "→ [分片" << shard_id_ << "] 跨分片Step1: " 
-                     << static_cast<int>(task.src_account) << " 扣款 " 
-                     << static_cast<int>(task.amount) 
-                     << " (目标: " << static_cast<int>(task.dst_account) << ")" 
-                     << std::endl;
-        }
-        
-        manager_->submit_cross_shard_step2(task.correlation_id);
-        
-    } catch (const std::exception& e) {
-        failed_transfers_++;
+    local_id src = static_cast<local_id>(task.src_account);
+    if (!send_single_order(task)) {
+        const TransferTask* unsent = &task;
+        fail_unsent(&unsent, 1, src);
+        return;
+    }
+    
+    hand_off_step2(task);
+}
+
+bool AccountShard::send_single_order(const TransferTask& task) {
+    // 单笔 TRANSFER 只在一个进程一个账户时使用，账户ID即进程ID
+    local_id src = static_cast<local_id>(task.src_account);
+    TaggedTransferOrder order = {
+        {src, static_cast<local_id>(task.dst_account), task.amount},
+        task.correlation_id
+    };
+    
+    Message msg;
+    lamport_time_t current_time = clock_->update();
+    fill_message(&msg, TRANSFER, wire_timestamp(current_time), &order, sizeof(order));
+    return send(src, &msg) == 0;
+}
+
+void AccountShard::fail_unsent(const TransferTask* const* tasks, size_t count, local_id src) {
+    {
         std::lock_guard<std::mutex> lock(log_mutex_);
-        std::cerr << "✗ [分片" << shard_id_ << "] 跨分片Step1异常: " << e.what() << std::endl;
+        std::cerr << "✗ [分片" << shard_id_ << "] 发往进程 " << static_cast<int>(src)
+                 << " 的 " << count << " 笔订单发送失败" << std::endl;
+    }
+    // 订单没有发出，不会有ACK：直接按失败完成（跨分片转账在这里归还上下文）
+    for (size_t i = 0; i < count; ++i) {
+        complete_transfer(*tasks[i], false, 0);
     }
 }
 
 void AccountShard::handle_cross_shard_step2(const TransferTask& task) {
-    try {
-        TransferOrder order = {task.src_account, task.dst_account, task.amount};
-        
-        Message msg;
-        timestamp_t current_time = update_lamport_time();
-        fill_message(&msg, TRANSFER, current_time, &order, sizeof(order));
-        send(task.dst_account, &msg);
-        
-        Message ack_msg;
-        receive(task.dst_account, &ack_msg);
-        update_lamport_time(ack_msg.s_header.s_local_time);
-        
-        if (ack_msg.s_header.s_magic == MESSAGE_MAGIC && 
-            ack_msg.s_header.s_type == ACK) {
-            cross_shard_transfers_++;
-            
-            std::lock_guard<std::mutex> lock(log_mutex_);
-            std::cout << "✓ [分片" << shard_id_ << "] 跨分片Step2完成: " 
-                     << static_cast<int>(task.dst_account) << " 入账 " 
-                     << static_cast<int>(task.amount) 
-                     << " (来源: " << static_cast<int>(task.src_account) << ")" 
-                     << std::endl;
-        } else {
-            failed_transfers_++;
+    // 源账户已把订单直接转发给目标账户，这里只需登记并等待目标账户的ACK
+    track_in_flight(task);
+}
+
+void AccountShard::track_in_flight(const TransferTask& task) {
+    // ACK可能先于登记到达（例如跨分片Step2排队期间）
+    lamport_time_t commit_time = 0;
+    if (early_acks_.erase(task.correlation_id, &commit_time)) {
+        complete_transfer(task, commit_time != kRejectedCommit, commit_time);
+        return;
+    }
+    
+    in_flight_.insert(task.correlation_id, task);
+    
+    // 按ID完成的转账不从队列中间删除，已完成的ID积累过多时整体清理一次
+    std::deque<uint64_t>& order = in_flight_order_[manager_->process_of(task.dst_account)];
+    order.push_back(task.correlation_id);
+    if (order.size() > in_flight_.size() + kOrderSlack) {
+        order.erase(std::remove_if(order.begin(), order.end(), [this](uint64_t id) {
+            return in_flight_.find(id) == nullptr;
+        }), order.end());
+    }
+}
+
+void AccountShard::handle_ack(const AckEvent& ack) {
+    observe_time(ack.commit_time);
+    
+    TransferTask task;
+    if (ack.rejected) {
+        {
             std::lock_guard<std::mutex> lock(log_mutex_);
-            std::cerr << "✗ [分片" << shard_id_ << "] 跨分片Step2失败: 无效ACK" << std::endl;
+            std::cerr << "✗ [分片" << shard_id_ << "] 转账失败: 进程 "
+                     << static_cast<int>(ack.from) << " 拒绝了订单 " << ack.correlation_id << std::endl;
         }
-        
-        manager_->cleanup_cross_shard_context(task.correlation_id);
-        
-    } catch (const std::exception& e) {
+        if (!in_flight_.erase(ack.correlation_id, &task)) {
+            // Step2还没登记：记下拒绝，登记时按失败完成
+            early_acks_.insert(ack.correlation_id, kRejectedCommit);
+            return;
+        }
+        complete_transfer(task, false, ack.commit_time);
+        return;
+    }
+    
+    if (ack.correlation_id == 0) {
+        // 旧格式ACK不带关联ID，按FIFO完成最早的一笔
+        if (in_flight_.erase(oldest_in_flight_to(ack.from), &task)) {
+            complete_transfer(task, true, ack.commit_time);
+        }
+        return;
+    }
+    
+    if (!in_flight_.erase(ack.correlation_id, &task)) {
+        early_acks_.insert(ack.correlation_id, ack.commit_time);
+        return;
+    }
+    complete_transfer(task, true, ack.commit_time);
+}
+
+void AccountShard::complete_transfer(const TransferTask& task, bool success, 
+                                     lamport_time_t commit_time) {
+    if (!success) {
         failed_transfers_++;
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        std::cerr << "✗ [分片" << shard_id_ << "] 跨分片Step2异常: " << e.what() << std::endl;
+    } else if (task.task_type == TaskType::LOCAL_TRANSFER) {
+        local_transfers_++;
+    } else {
+        cross_shard_transfers_++;
+    }
+    
+    // 跨分片上下文由结束转账的任务归还：通常是Step2，订单没能发出时是Step1
+    if (task.task_type != TaskType::LOCAL_TRANSFER) {
+        manager_->cleanup_cross_shard_context(task.correlation_id);
     }
-}
\ No newline at end of file
+    
+    resolve_transfer(task, success, success ? commit_time : 0);
+    retire_task(true);
+}
+
+void AccountShard::resolve_transfer(const TransferTask& task, bool success, 
+                                    lamport_time_t commit_time) {
+    if (!task.completion) {
+        return;
+    }
+    TransferResult result = {
+        success,
+        commit_time,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - task.submit_time),
+        task.correlation_id
+    };
+    task.completion->complete(result);
+}
+
+void AccountShard::retire_task(bool transfer_finished) {
+    // 先结束管理器级计数：分片计数归零时，整笔转账必然已经计完
+    if (transfer_finished) {
+        manager_->on_transfer_finished();
+    }
+    pending_tasks_.done();
+}
+
+uint64_t AccountShard::oldest_in_flight_to(local_id dst) {
+    if (dst < 0 || dst > MAX_PROCESS_ID) {
+        return 0;
+    }
+    // 队首可能是已按ID完成的转账，弹出直到遇到仍在途的一笔
+    std::deque<uint64_t>& order = in_flight_order_[dst];
+    while (!order.empty() && in_flight_.find(order.front()) == nullptr) {
+        order.pop_front();
+    }
+    return order.empty() ? 0 : order.front();
+}
@@ -1,71 +1,223 @@
 #include "banking_system/shard/shard_manager.h"
+#include "banking_system/common/clock.h"
+#include "banking_system/ipc/shm_transport.h"
+#include "banking_system/transfer/transfer_batch.h"
+#include <algorithm>
 #include <iostream>
 
-ShardManager::ShardManager(int num_shards)
+ShardManager::ShardManager(int num_shards, size_t max_in_flight, ClockMode clock_mode,
+                           HistoryCollector* history, const AccountDirectory* directory,
+                           SharedLedger* ledger)
     : num_shards_(num_shards)
+    , clock_mode_(clock_mode)
+    , contexts_(static_cast<size_t>(num_shards) * std::max<size_t>(max_in_flight, 1) *
+                kContextsPerWindowSlot)
+    , context_waiters_(0)
     , next_correlation_id_(1)
+    , reactor_stop_(false)
+    , history_(history)
+    , directory_(directory)
+    , ledger_(ledger)
+    , accounts_(ShmTransport::instance().count_nodes() - 1)
+    , rejected_transfers_(0)
 {
     std::cout << "\n=== 初始化分片管理器 ===" << std::endl;
     std::cout << "分片数量: " << num_shards_ << std::endl;
+    std::cout << "在途窗口: " << max_in_flight << std::endl;
+    std::cout << "跨分片上下文槽位: " << contexts_.capacity() << std::endl;
+    std::cout << "时钟域: " << (clock_mode_ == ClockMode::PER_SHARD ? "每分片独立" : "全局共享") 
+              << std::endl;
+    std::cout << "时间来源: " 
+              << (LamportClock::instance().time_source() == TimeSource::HYBRID 
+                  ? "混合逻辑时钟(HLC)" : "Lamport") 
+              << std::endl;
+    if (directory_) {
+        std::cout << "多账户模式: " << directory_->accounts() << " 个账户托管于 " 
+                  << directory_->workers() << " 个工作进程" << std::endl;
+    }
+    if (ledger_) {
+        std::cout << "共享账本已启用: 账本内转账直接原子结算" << std::endl;
+    }
     
+    std::vector<AccountShard*> peers;
     for (int i = 0; i < num_shards_; ++i) {
-        shards_.push_back(std::make_unique<AccountShard>(i, this));
+        shards_.push_back(std::make_unique<AccountShard>(i, num_shards_, this, max_in_flight,
+                                                      AccountShard::kDefaultQueueCapacity,
+                                                      clock_mode_));
+        peers.push_back(shards_.back().get());
     }
+    for (auto& shard : shards_) {
+        shard->connect_peers(peers);
+    }
+    
+    reactor_thread_ = std::thread(&ShardManager::reactor_loop, this);
     
     std::cout << "所有分片已启动\n" << std::endl;
 }
 
-int ShardManager::get_shard_id(local_id account_id) const {
-    return account_id % num_shards_;
+ShardManager::~ShardManager() {
+    // 分片之间会直接移交Step2，必须等所有转账结束后才能逐个销毁分片；
+    // 分片关闭时要等待在途转账的ACK，因此分发线程必须最后停止
+    pending_transfers_.wait();
+    sync_clocks();
+    shards_.clear();
+    
+    reactor_stop_.store(true);
+    ShmTransport::instance().interrupt();
+    if (reactor_thread_.joinable()) {
+        reactor_thread_.join();
+    }
+}
+
+void ShardManager::submit_transfer(account_id_t src, account_id_t dst, balance_t amount) {
+    dispatch_transfer(src, dst, amount, nullptr);
+}
+
+void ShardManager::submit_transfers(const TransferOrder* transfers, size_t count) {
+    submit_orders(transfers, count);
+}
+
+void ShardManager::submit_transfers(const AccountTransfer* transfers, size_t count) {
+    submit_orders(transfers, count);
 }
 
-void ShardManager::submit_transfer(local_id src, local_id dst, balance_t amount) {
+template <typename Order>
+void ShardManager::submit_orders(const Order* transfers, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    
+    // 整批一次性预留本地转账的关联ID和未完成计数
+    uint64_t first_id = next_correlation_id_.fetch_add(count);
+    pending_transfers_.add(count);
+    auto submit_time = std::chrono::steady_clock::now();
+    lamport_time_t causal_time = get_lamport_time();
+    
+    std::vector<std::vector<TransferTask>> buckets(num_shards_);
+    for (auto& bucket : buckets) {
+        bucket.reserve(count / num_shards_ + 1);
+    }
+    
+    auto flush = [&]() {
+        for (int shard = 0; shard < num_shards_; ++shard) {
+            if (buckets[shard].empty()) continue;
+            shards_[shard]->submit_tasks(buckets[shard].data(), buckets[shard].size());
+            buckets[shard].clear();
+        }
+    };
+    
+    for (size_t i = 0; i < count; ++i) {
+        const Order& order = transfers[i];
+        if (!hosts_account(order.s_src) || !hosts_account(order.s_dst)) {
+            reject_transfer(order.s_src, order.s_dst, nullptr);
+            on_transfer_finished();
+            continue;
+        }
+        int src_shard = get_shard_id(order.s_src);
+        int dst_shard = get_shard_id(order.s_dst);
+        // 账本内转账一次原子结算两端，不需要跨分片的两步操作
+        bool local = src_shard == dst_shard || settles_in_ledger(order.s_src, order.s_dst);
+        TaskType type = local ? TaskType::LOCAL_TRANSFER : TaskType::CROSS_SHARD_STEP1;
+        
+        std::vector<TransferTask>& bucket = buckets[src_shard];
+        bucket.emplace_back(type, order.s_src, order.s_dst, order.s_amount,
+                            first_id + i, src_shard, dst_shard);
+        TransferTask& task = bucket.back();
+        task.submit_time = submit_time;
+        task.causal_time = causal_time;
+        
+        // 跨分片转账使用上下文表分配的关联ID；表满时先提交已分桶的任务，
+        // 让它们完成后释放槽位，避免自己持有的槽位把自己卡住
+        if (type == TaskType::CROSS_SHARD_STEP1 && contexts_.acquire(task) == 0) {
+            TransferTask pending = task;
+            bucket.pop_back();
+            flush();
+            acquire_context(pending);
+            buckets[src_shard].push_back(pending);
+        }
+    }
+    
+    flush();
+}
+
+TransferHandle ShardManager::submit_transfer_async(account_id_t src, account_id_t dst, balance_t amount,
+                                                   TransferCallback callback) {
+    auto completion = std::make_shared<TransferCompletion>(std::move(callback));
+    dispatch_transfer(src, dst, amount, completion);
+    return TransferHandle(completion);
+}
+
+void ShardManager::dispatch_transfer(account_id_t src, account_id_t dst, balance_t amount,
+                                     std::shared_ptr<TransferCompletion> completion) {
+    if (!hosts_account(src) || !hosts_account(dst)) {
+        reject_transfer(src, dst, completion);
+        return;
+    }
+    
     int src_shard = get_shard_id(src);
     int dst_shard = get_shard_id(dst);
     
-    if (src_shard == dst_shard) {
+    pending_transfers_.add();
+    
+    if (src_shard == dst_shard || settles_in_ledger(src, dst)) {
         TransferTask task(src, dst, amount);
+        task.correlation_id = next_correlation_id_.fetch_add(1);
+        task.submit_time = std::chrono::steady_clock::now();
+        task.causal_time = get_lamport_time();
+        task.completion = std::move(completion);
         shards_[src_shard]->submit_task(task);
     } else {
-        handle_cross_shard_transfer(src, dst, amount, src_shard, dst_shard);
+        handle_cross_shard_transfer(src, dst, amount, src_shard, dst_shard, 
+                                    std::move(completion));
     }
 }
 
-void ShardManager::submit_cross_shard_step2(uint64_t correlation_id) {
-    CrossShardContext context(TransferTask(0, 0, 0));
-    
-    {
-        std::lock_guard<std::mutex> lock(context_mutex_);
-        auto it = cross_shard_contexts_.find(correlation_id);
-        if (it == cross_shard_contexts_.end()) {
-            std::cerr << "错误: 找不到correlation_id=" << correlation_id << std::endl;
-            return;
-        }
-        context = it->second;
-        context.step1_completed = true;
-    }
-    
-    TransferTask step2_task(
-        TaskType::CROSS_SHARD_STEP2,
-        context.task.src_account,
-        context.task.dst_account,
-        context.task.amount,
-        correlation_id,
-        context.task.src_shard_id,
-        context.task.dst_shard_id
-    );
-    
-    shards_[context.task.dst_shard_id]->submit_task(step2_task);
+void ShardManager::reject_transfer(account_id_t src, account_id_t dst,
+                                   const std::shared_ptr<TransferCompletion>& completion) {
+    rejected_transfers_++;
+    std::cerr << "✗ 拒绝转账: " << src << " -> " << dst << " 引用了不存在的账户" << std::endl;
+    if (completion) {
+        completion->complete({false, 0, std::chrono::nanoseconds(0), 0});
+    }
 }
 
 void ShardManager::cleanup_cross_shard_context(uint64_t correlation_id) {
-    std::lock_guard<std::mutex> lock(context_mutex_);
-    cross_shard_contexts_.erase(correlation_id);
+    if (!contexts_.release(correlation_id)) {
+        return;
+    }
+    // 槽位已归还：有提交方因表满而睡眠时唤醒它们重新申请
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (context_waiters_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(context_mutex_);
+        context_cv_.notify_all();
+    }
+}
+
+void ShardManager::on_transfer_finished() {
+    pending_transfers_.done();
 }
 
 void ShardManager::wait_all_complete() {
+    pending_transfers_.wait();
+    sync_clocks();
+}
+
+bool ShardManager::wait_for(std::chrono::steady_clock::time_point deadline) {
+    if (!pending_transfers_.wait_until(deadline)) {
+        return false;
+    }
+    sync_clocks();
+    return true;
+}
+
+void ShardManager::sync_clocks() {
+    if (clock_mode_ != ClockMode::PER_SHARD) {
+        return;
+    }
+    // 把各分片时钟域合并回进程级时钟，之后父进程发出的消息（如STOP）
+    // 在逻辑时间上晚于所有分片事件
     for (auto& shard : shards_) {
-        shard->wait_completion();
+        LamportClock::instance().merge(shard->clock().get_time());
     }
 }
 
@@ -74,23 +226,116 @@ void ShardManager::print_statistics() {
     for (auto& shard : shards_) {
         shard->print_statistics();
     }
+    if (rejected_transfers_.load() > 0) {
+        std::cout << "拒绝的转账（账户不存在）: " << rejected_transfers_.load() << std::endl;
+    }
 }
 
-void ShardManager::handle_cross_shard_transfer(local_id src, local_id dst, balance_t amount,
-                                               int src_shard, int dst_shard) {
-    uint64_t correlation_id = next_correlation_id_.fetch_add(1);
-    
+void ShardManager::handle_cross_shard_transfer(account_id_t src, account_id_t dst, balance_t amount,
+                                               int src_shard, int dst_shard,
+                                               std::shared_ptr<TransferCompletion> completion) {
     TransferTask step1_task(
         TaskType::CROSS_SHARD_STEP1,
         src, dst, amount,
-        correlation_id,
+        0,
         src_shard, dst_shard
     );
+    step1_task.submit_time = std::chrono::steady_clock::now();
+    step1_task.causal_time = get_lamport_time();
+    step1_task.completion = std::move(completion);
     
-    {
-        std::lock_guard<std::mutex> lock(context_mutex_);
-        cross_shard_contexts_.emplace(correlation_id, CrossShardContext(step1_task));
+    acquire_context(step1_task);
+    shards_[src_shard]->submit_task(step1_task);
+}
+
+void ShardManager::acquire_context(TransferTask& step1_task) {
+    if (contexts_.acquire(step1_task) != 0) {
+        return;
     }
     
-    shards_[src_shard]->submit_task(step1_task);
-}
\ No newline at end of file
+    // 表满说明在途的跨分片转账已达上限：睡眠到完成的转账释放槽位。
+    // 登记等待者和重新申请都在锁内，释放方看到等待者后取同一把锁再通知，不会错过唤醒
+    std::unique_lock<std::mutex> lock(context_mutex_);
+    context_waiters_.fetch_add(1, std::memory_order_seq_cst);
+    context_cv_.wait(lock, [this, &step1_task] {
+        return contexts_.acquire(step1_task) != 0;
+    });
+    context_waiters_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void ShardManager::reactor_loop() {
+    std::vector<Message> inbox(kReactorBatch);
+    std::vector<local_id> senders(kReactorBatch);
+    std::vector<std::vector<AckEvent>> routed(num_shards_);
+    
+    while (!reactor_stop_.load()) {
+        int count = receive_many_for(inbox.data(), kReactorBatch, senders.data(), 
+                                     kReactorPollMs);
+        if (count < 0) {
+            std::cerr << "错误: ACK分发线程接收失败，传输层未初始化" << std::endl;
+            break;
+        }
+        
+        for (int i = 0; i < count; ++i) {
+            route_inbound(senders[i], inbox[i], routed);
+        }
+        
+        for (int shard = 0; shard < num_shards_; ++shard) {
+            if (routed[shard].empty()) continue;
+            shards_[shard]->deliver_acks(routed[shard].data(), routed[shard].size());
+            routed[shard].clear();
+        }
+    }
+}
+
+void ShardManager::route_inbound(local_id from, const Message& msg,
+                                 std::vector<std::vector<AckEvent>>& routed) {
+    // ACK由托管目标账户的进程发出，而等待它的总是目标账户所在的分片
+    // （本地转账两端同分片，跨分片转账由目标分片执行Step2），分片又按
+    // 托管进程划分，因此ACK中的每个关联ID都投递到发送方进程所在分片的完成队列
+    int shard_id = from % num_shards_;
+    std::vector<AckEvent>& events = routed[shard_id];
+    
+    // 消息头只有低16位，以接收分片的时钟为参照还原
+    lamport_time_t commit_time = widen_timestamp(msg.s_header.s_local_time,
+                                                 shards_[shard_id]->clock().get_time());
+    
+    // PER_SHARD模式下由接收ACK的分片合并时间，不触碰进程级时钟
+    if (clock_mode_ == ClockMode::GLOBAL) {
+        update_lamport_time(commit_time);
+    }
+    
+    if (history_ && HistoryCollector::is_history_message(msg)) {
+        if (!history_->apply(from, msg)) {
+            std::cerr << "✗ 账户 " << static_cast<int>(from) << " 的余额历史分段非法" << std::endl;
+        }
+        return;
+    }
+    
+    if (msg.s_header.s_magic == MESSAGE_MAGIC && msg.s_header.s_type == TRANSFER_REJECT) {
+        // 被拒绝的订单由等待它的分片按失败完成：和ACK一样是目标账户所在分片
+        size_t rejected = account_transfer_batch_count(&msg);
+        for (size_t i = 0; i < rejected; ++i) {
+            TaggedAccountTransfer order = account_transfer_batch_order(&msg, i);
+            int target = hosts_account(order.s_order.s_dst) ? get_shard_id(order.s_order.s_dst)
+                                                            : shard_id;
+            routed[target].push_back({order.s_correlation_id, from, commit_time, true});
+        }
+        return;
+    }
+    
+    // 无法识别的消息不对应任何一笔转账：记录后丢弃，不能拿它去结束别的转账，
+    // 否则之后到达的真正ACK会滞留在 early_acks_ 中
+    size_t count = ack_count(&msg);
+    if (msg.s_header.s_magic != MESSAGE_MAGIC || 
+        msg.s_header.s_type != ACK || count == 0) {
+        std::cerr << "✗ 丢弃来自进程 " << static_cast<int>(from) << " 的无法识别的消息 (类型 "
+                  << msg.s_header.s_type << ", 负载 " << msg.s_header.s_payload_len << " 字节)"
+                  << std::endl;
+        return;
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        events.push_back({ack_correlation_id(&msg, i), from, commit_time, false});
+    }
+}
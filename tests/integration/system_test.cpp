@@ -0,0 +1,117 @@
+#include "../test_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ==================== 启动器端到端测试 ====================
+
+/**
+ * @brief 在临时目录中运行一次启动器
+ * @param program banking_system 的路径
+ * @param args 命令行参数
+ * @param output 输出：标准输出和标准错误
+ * @return 进程退出码（异常终止时为-1）
+ */
+static int run_launcher(const std::string& program, const std::string& args, std::string* output) {
+    std::string command = "'" + program + "' " + args + " 2>&1";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe == nullptr) {
+        return -1;
+    }
+    char buf[4096];
+    size_t n;
+    output->clear();
+    while ((n = std::fread(buf, 1, sizeof(buf), pipe)) > 0) {
+        output->append(buf, n);
+    }
+    int status = pclose(pipe);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * @brief 运行 repeat 次，每次都必须正常退出并通过资金守恒检查
+ */
+static void check_conservation(const std::string& program, const std::string& args, int repeat) {
+    for (int i = 0; i < repeat; ++i) {
+        std::string output;
+        int code = run_launcher(program, args, &output);
+        bool conserved = output.find("资金守恒:") != std::string::npos &&
+                         output.find("资金不守恒") == std::string::npos;
+        if (code != 0 || !conserved) {
+            std::cerr << "banking_system " << args << " (第" << (i + 1) << "次) 退出码 " << code
+                      << "\n" << output << std::endl;
+        }
+        CHECK_EQ(code, 0);
+        CHECK(conserved);
+    }
+}
+
+/**
+ * @brief 指定 --history-dir 时事件日志和历史报告写在该目录而不是当前目录
+ */
+static void check_history_dir(const std::string& program) {
+    char directory[] = "/tmp/system_test_history_XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        CHECK(false);
+        return;
+    }
+    std::string dir = directory;
+    std::remove("events.log");
+    std::remove("history_report.json");
+
+    check_conservation(program, "-p 4 --history-dir " + dir, 1);
+    CHECK(access((dir + "/events.log").c_str(), F_OK) == 0);
+    CHECK(access((dir + "/history_report.json").c_str(), F_OK) == 0);
+    CHECK(access("events.log", F_OK) != 0);
+    CHECK(access("history_report.json", F_OK) != 0);
+
+    std::remove((dir + "/events.log").c_str());
+    std::remove((dir + "/history_report.json").c_str());
+    rmdir(directory);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "用法: " << argv[0] << " <banking_system路径>" << std::endl;
+        return 2;
+    }
+    std::string program = argv[1];
+    if (program[0] != '/') {
+        char cwd[4096];
+        if (getcwd(cwd, sizeof(cwd)) != nullptr) {
+            program = std::string(cwd) + "/" + program;
+        }
+    }
+
+    // events.log 和 history_report.json 写在临时目录中
+    char directory[] = "/tmp/system_test_XXXXXX";
+    if (mkdtemp(directory) == nullptr || chdir(directory) != 0) {
+        std::cerr << "错误: 无法创建临时目录" << std::endl;
+        return 2;
+    }
+
+    // 一个进程一个账户：迟到的入账会回溯修改已发送的历史
+    check_conservation(program, "-p 10", 10);
+    check_conservation(program, "-p 10 -s 4", 5);
+    check_conservation(program, "-p 15 -s 8", 5);
+    check_conservation(program, "-p 3 10 20 30", 3);
+    // 多账户进程、共享账本和其他启动屏障
+    check_conservation(program, "-p 4 -a 64", 3);
+    check_conservation(program, "-p 8 -t ledger", 3);
+    check_conservation(program, "-p 6 --barrier tree", 3);
+    check_conservation(program, "-p 6 --barrier shm", 3);
+    // 每分片时钟域和混合逻辑时钟
+    check_conservation(program, "-p 8 --clock per-shard", 3);
+    check_conservation(program, "-p 8 --clock hlc", 3);
+    // 输出文件的目录
+    check_history_dir(program);
+
+    std::remove("events.log");
+    std::remove("history_report.json");
+    if (chdir("/") == 0) {
+        rmdir(directory);
+    }
+    return test_result("system_test");
+}
@@ -0,0 +1,55 @@
+#ifndef BANKING_SYSTEM_TESTS_TEST_COMMON_H
+#define BANKING_SYSTEM_TESTS_TEST_COMMON_H
+
+#include <iostream>
+
+// ==================== 测试辅助 ====================
+
+/**
+ * @brief 当前测试程序中失败的检查数
+ */
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+/**
+ * @brief 检查条件成立，失败时打印位置并计数（不中止，后续检查继续执行）
+ */
+#define CHECK(cond)                                                               \
+    do {                                                                          \
+        if (!(cond)) {                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": 检查失败: " #cond       \
+                      << std::endl;                                               \
+            ++test_failures();                                                    \
+        }                                                                         \
+    } while (0)
+
+/**
+ * @brief 检查两个整数相等，失败时打印两边的值
+ */
+#define CHECK_EQ(actual, expected)                                                \
+    do {                                                                          \
+        auto check_actual_ = (actual);                                            \
+        auto check_expected_ = (expected);                                        \
+        if (!(check_actual_ == check_expected_)) {                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": 检查失败: " #actual     \
+                      << " == " #expected " (" << +check_actual_ << " != "        \
+                      << +check_expected_ << ")" << std::endl;                    \
+            ++test_failures();                                                    \
+        }                                                                         \
+    } while (0)
+
+/**
+ * @brief 测试程序的退出码：有检查失败时返回1
+ */
+inline int test_result(const char* name) {
+    if (test_failures() != 0) {
+        std::cerr << name << ": " << test_failures() << " 项检查失败" << std::endl;
+        return 1;
+    }
+    std::cout << name << ": 全部通过" << std::endl;
+    return 0;
+}
+
+#endif // BANKING_SYSTEM_TESTS_TEST_COMMON_H
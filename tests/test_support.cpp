@@ -0,0 +1,21 @@
+#include "labs_headers/message.h"
+#include "labs_headers/log.h"
+#include <cstring>
+
+// 单元测试不链接 main.cpp，这里提供实验框架函数的最小实现
+
+void fill_message(Message* msg, MessageType type, timestamp_t time, void* payload, size_t psize) {
+    if (psize > MAX_PAYLOAD_LEN) {
+        psize = MAX_PAYLOAD_LEN;
+    }
+    msg->s_header.s_magic = MESSAGE_MAGIC;
+    msg->s_header.s_payload_len = static_cast<uint16_t>(psize);
+    msg->s_header.s_type = static_cast<int16_t>(type);
+    msg->s_header.s_local_time = time;
+    if (psize > 0 && payload != nullptr) {
+        std::memcpy(msg->s_payload, payload, psize);
+    }
+}
+
+void shared_logger(const char*) {
+}
@@ -0,0 +1,233 @@
+#include "banking_system/common/clock.h"
+#include "../test_common.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// ==================== Lamport时钟 ====================
+
+static void test_lamport_update() {
+    LamportClock clock;
+    CHECK_EQ(clock.get_time(), 0);
+    CHECK_EQ(clock.update(), 1);
+    CHECK_EQ(clock.update(), 2);
+    // 收到更晚的消息：max(本地, 消息) + 1
+    CHECK_EQ(clock.update(10), 11);
+    // 收到更早的消息：只递增本地时钟
+    CHECK_EQ(clock.update(5), 12);
+    CHECK_EQ(clock.get_time(), 12);
+}
+
+static void test_monotonic_under_contention() {
+    constexpr int kThreads = 4;
+    constexpr int kEvents = 100000;
+    LamportClock clock;
+
+    // 并发更新：每个线程看到的时间严格递增，所有返回值互不相同
+    std::atomic<lamport_time_t> mailbox(0);
+    std::vector<std::vector<lamport_time_t>> seen(kThreads);
+    std::vector<int> regressions(kThreads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&clock, &mailbox, &seen, &regressions, t] {
+            seen[t].reserve(kEvents);
+            lamport_time_t previous = 0;
+            for (int i = 0; i < kEvents; ++i) {
+                lamport_time_t received = i % 3 == 0 ? mailbox.load() : 0;
+                lamport_time_t time = clock.update(received);
+                if (time <= previous || time <= received) {
+                    ++regressions[t];
+                }
+                previous = time;
+                mailbox.store(time);
+                seen[t].push_back(time);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<lamport_time_t> all;
+    for (int t = 0; t < kThreads; ++t) {
+        CHECK_EQ(regressions[t], 0);
+        all.insert(all.end(), seen[t].begin(), seen[t].end());
+    }
+    std::sort(all.begin(), all.end());
+    CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+    // Lamport计数器每次更新恰好加1（收到的时间都不超过本地时钟）
+    CHECK_EQ(clock.get_time(), static_cast<lamport_time_t>(kThreads) * kEvents);
+}
+
+static void test_merge() {
+    LamportClock clock;
+    clock.update(100);
+    CHECK_EQ(clock.get_time(), 101);
+
+    // 合并只取最大值，不递增
+    clock.merge(50);
+    CHECK_EQ(clock.get_time(), 101);
+    clock.merge(101);
+    CHECK_EQ(clock.get_time(), 101);
+    clock.merge(500);
+    CHECK_EQ(clock.get_time(), 500);
+    // 合并之后的本地事件晚于被合并的时钟域
+    CHECK_EQ(clock.update(), 501);
+
+    // 并发合并：结果为所有输入的最大值
+    LamportClock merged;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&merged, t] {
+            for (lamport_time_t i = 0; i < 10000; ++i) {
+                merged.merge(i * 4 + t);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK_EQ(merged.get_time(), 9999 * 4 + 3);
+}
+
+// ==================== 16位时间戳还原 ====================
+
+static void test_widen_timestamp() {
+    // 不跨越16位边界
+    CHECK_EQ(widen_timestamp(wire_timestamp(1234), 1200), 1234);
+    CHECK_EQ(widen_timestamp(wire_timestamp(1200), 1234), 1200);
+
+    // 跨越 2^16 边界：发送方已回绕、接收方未回绕，以及相反方向
+    CHECK_EQ(widen_timestamp(wire_timestamp(65540), 65530), 65540);
+    CHECK_EQ(widen_timestamp(wire_timestamp(65530), 65540), 65530);
+    // 多次回绕后的高位时间
+    lamport_time_t high = (lamport_time_t(7) << 16) + 3;
+    CHECK_EQ(widen_timestamp(wire_timestamp(high), high - 10), high);
+    CHECK_EQ(widen_timestamp(wire_timestamp(high - 10), high), high - 10);
+
+    // ±32767 以内都能还原；超出后还原为离接收方更近的回绕值
+    lamport_time_t reference = 1000000;
+    CHECK_EQ(widen_timestamp(wire_timestamp(reference + 32767), reference), reference + 32767);
+    CHECK_EQ(widen_timestamp(wire_timestamp(reference - 32767), reference), reference - 32767);
+    CHECK_EQ(widen_timestamp(wire_timestamp(reference + 32769), reference), reference + 32769 - 65536);
+
+    // 时间0附近：接收方尚未开始计时
+    CHECK_EQ(widen_timestamp(wire_timestamp(5), 0), 5);
+    CHECK_EQ(widen_timestamp(wire_timestamp(0), 0), 0);
+}
+
+// ==================== 混合逻辑时钟 ====================
+
+static std::atomic<lamport_time_t> g_manual_ms(0);
+
+/**
+ * @brief 手动推进的物理时钟
+ */
+static lamport_time_t manual_physical() {
+    return g_manual_ms.load();
+}
+
+static std::atomic<long> g_physical_reads(0);
+static constexpr long kEventsPerTick = 200;
+
+/**
+ * @brief 负载下的物理时钟：每读取 kEventsPerTick 次前进1毫秒
+ *
+ * 每次 update 读取一次物理时间，因此每毫秒正好发生 kEventsPerTick 个事件
+ */
+static lamport_time_t loaded_physical() {
+    return g_physical_reads.fetch_add(1) / kEventsPerTick;
+}
+
+static void test_hlc_counter() {
+    g_manual_ms = 100;
+    LamportClock clock(TimeSource::HYBRID, &manual_physical);
+
+    // 同一毫秒内只有计数前进，物理时间前进后计数归零
+    CHECK_EQ(clock.update(), hlc_pack(100, 0));
+    CHECK_EQ(clock.update(), hlc_pack(100, 1));
+    CHECK_EQ(clock.update(), hlc_pack(100, 2));
+    g_manual_ms = 101;
+    CHECK_EQ(clock.update(), hlc_pack(101, 0));
+
+    // 消息的 l 更大：沿用消息的 l，计数为消息计数 + 1
+    CHECK_EQ(clock.update(hlc_pack(105, 7)), hlc_pack(105, 8));
+    CHECK_EQ(clock.update(), hlc_pack(105, 9));
+    // l 相同时取两边较大的计数
+    CHECK_EQ(clock.update(hlc_pack(105, 20)), hlc_pack(105, 21));
+    CHECK_EQ(clock.update(hlc_pack(105, 3)), hlc_pack(105, 22));
+    // 较早的消息不影响 l
+    CHECK_EQ(clock.update(hlc_pack(90, 100)), hlc_pack(105, 23));
+
+    g_manual_ms = 106;
+    lamport_time_t time = clock.update(hlc_pack(104, 50));
+    CHECK_EQ(hlc_physical(time), 106);
+    CHECK_EQ(hlc_logical(time), 0);
+}
+
+static void test_hlc_counter_overflow() {
+    g_manual_ms = 10;
+    LamportClock clock(TimeSource::HYBRID, &manual_physical);
+
+    // 一毫秒内的事件超过计数范围：进位到 l，时间戳仍严格递增
+    lamport_time_t previous = 0;
+    bool increasing = true;
+    for (lamport_time_t i = 0; i < 3 * (kHlcLogicalMask + 1); ++i) {
+        lamport_time_t time = clock.update();
+        increasing = increasing && time > previous;
+        previous = time;
+    }
+    CHECK(increasing);
+    CHECK_EQ(hlc_physical(previous), 12);
+
+    // 物理时间追上后领先归零
+    g_manual_ms = 13;
+    CHECK_EQ(clock.update(), hlc_pack(13, 0));
+}
+
+static void test_hlc_lead_bounded_under_load() {
+    constexpr int kThreads = 4;
+    constexpr int kEvents = 100000;
+    g_physical_reads = 0;
+    LamportClock clock(TimeSource::HYBRID, &loaded_physical);
+
+    // 每毫秒 kEventsPerTick 个事件，分布在多个线程上并互相传递时间戳：
+    // l 领先物理时间不超过1毫秒（读物理时间与CAS之间时钟可能已前进）。
+    // 把计数直接加在毫秒上的旧实现在这里会领先物理时间数十万毫秒
+    std::atomic<lamport_time_t> mailbox(0);
+    std::vector<lamport_time_t> max_lead(kThreads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&clock, &mailbox, &max_lead, t] {
+            for (int i = 0; i < kEvents; ++i) {
+                lamport_time_t received = i % 4 == 0 ? mailbox.load() : 0;
+                lamport_time_t time = clock.update(received);
+                mailbox.store(time);
+                lamport_time_t lead = hlc_physical(time) -
+                                      g_physical_reads.load() / kEventsPerTick;
+                if (lead > max_lead[t]) {
+                    max_lead[t] = lead;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < kThreads; ++t) {
+        CHECK(max_lead[t] <= 1);
+    }
+    CHECK(hlc_physical(clock.get_time()) <= g_physical_reads.load() / kEventsPerTick);
+}
+
+int main() {
+    test_lamport_update();
+    test_monotonic_under_contention();
+    test_merge();
+    test_widen_timestamp();
+    test_hlc_counter();
+    test_hlc_counter_overflow();
+    test_hlc_lead_bounded_under_load();
+    return test_result("clock_test");
+}
@@ -0,0 +1,225 @@
+#include "banking_system/history/balance_history.h"
+#include "banking_system/history/history_archive.h"
+#include "banking_system/history/history_index.h"
+#include "banking_system/history/history_wire.h"
+#include "../test_common.h"
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+// ==================== 变化点记录 ====================
+
+static void test_record_change_points() {
+    ScalableBalanceHistory history(1);
+    history.reset(1, 10);
+    update_history(&history, 4, 4, 10, 0);   // 余额未变：只延长结束时间
+    CHECK_EQ(history.size(), 1u);
+    CHECK_EQ(history.end_time(), 4);
+
+    update_history(&history, 6, 6, 7, 0);
+    CHECK_EQ(history.size(), 2u);
+    CHECK_EQ(history.state_at(5).s_balance, 10);
+    CHECK_EQ(history.state_at(6).s_balance, 7);
+    CHECK_EQ(history.state_at(100).s_balance, 7);
+}
+
+// ==================== 迟到的入账 ====================
+
+/**
+ * @brief 发送时间早于账户最后一个变化点的入账
+ *
+ * 账户在 t5、t8 各转出3，t3 发出的5元在 t12 才到达：
+ * [3, 12) 内每个时刻都必须计入这5元的在途金额
+ */
+static void test_late_credit_raises_whole_interval() {
+    ScalableBalanceHistory history(1);
+    history.reset(1, 10);
+    update_history(&history, 5, 5, 7, 0);
+    update_history(&history, 8, 8, 4, 0);
+
+    size_t modified = update_history(&history, 3, 12, 9, 5);
+    CHECK_EQ(modified, 1u);   // 在 t3 处拆分出新的变化点
+
+    for (lamport_time_t t = 0; t < 3; ++t) {
+        CHECK_EQ(history.state_at(t).s_balance_pending_in, 0);
+        CHECK_EQ(history.state_at(t).s_balance, 10);
+    }
+    const balance_t expected_balance[] = {10, 10, 7, 7, 7, 4, 4, 4, 4};
+    for (lamport_time_t t = 3; t < 12; ++t) {
+        CHECK_EQ(history.state_at(t).s_balance_pending_in, 5);
+        CHECK_EQ(history.state_at(t).s_balance, expected_balance[t - 3]);
+    }
+    CHECK_EQ(history.state_at(12).s_balance, 9);
+    CHECK_EQ(history.state_at(12).s_balance_pending_in, 0);
+    CHECK_EQ(history.end_time(), 12);
+}
+
+static void test_late_credit_on_change_point() {
+    ScalableBalanceHistory history(1);
+    history.reset(1, 10);
+    update_history(&history, 5, 5, 7, 0);
+    update_history(&history, 8, 8, 4, 0);
+    size_t before = history.size();
+
+    // 发送时间正好落在 t5 的变化点上：不拆分，直接从该变化点开始修改
+    size_t modified = update_history(&history, 5, 10, 6, 2);
+    CHECK_EQ(modified, 1u);
+    CHECK_EQ(history.size(), before + 1);
+    CHECK_EQ(history.state_at(4).s_balance_pending_in, 0);
+    for (lamport_time_t t = 5; t < 10; ++t) {
+        CHECK_EQ(history.state_at(t).s_balance_pending_in, 2);
+    }
+    CHECK_EQ(history.state_at(10).s_balance, 6);
+    CHECK_EQ(history.state_at(10).s_balance_pending_in, 0);
+}
+
+// ==================== 分段重发 ====================
+
+static bool ship(const ScalableBalanceHistory& from, ScalableBalanceHistory* to,
+                 size_t first, size_t end, bool final, bool rewrite, bool* last) {
+    Message msg;
+    fill_history_segment(&msg, 0, from, first, end, final, rewrite);
+    return read_history_segment(&msg, to, last);
+}
+
+static void test_rewrite_segment_after_late_credit() {
+    ScalableBalanceHistory sender(1);
+    ScalableBalanceHistory receiver(1);
+    sender.reset(1, 10);
+    update_history(&sender, 5, 5, 7, 0);
+    update_history(&sender, 8, 8, 4, 0);
+
+    // 先增量发送已封存的变化点
+    bool last = false;
+    size_t shipped = sender.size() - 1;
+    CHECK(ship(sender, &receiver, 0, shipped, false, false, &last));
+    CHECK(!last);
+
+    size_t modified = update_history(&sender, 3, 12, 9, 5);
+    CHECK(modified < shipped);
+
+    // 不带重写标志时，下标早于接收方已有长度的分段视为乱序
+    CHECK(!ship(sender, &receiver, modified, sender.size(), true, false, &last));
+    CHECK(ship(sender, &receiver, modified, sender.size(), true, true, &last));
+    CHECK(last);
+
+    CHECK_EQ(receiver.size(), sender.size());
+    CHECK_EQ(receiver.end_time(), sender.end_time());
+    for (size_t i = 0; i < sender.size(); ++i) {
+        CHECK_EQ(receiver[i].s_time, sender[i].s_time);
+        CHECK_EQ(receiver[i].s_balance, sender[i].s_balance);
+        CHECK_EQ(receiver[i].s_balance_pending_in, sender[i].s_balance_pending_in);
+    }
+}
+
+static void test_first_segment_resets_only_empty_history() {
+    ScalableBalanceHistory sender(2);
+    ScalableBalanceHistory receiver(2);
+    sender.reset(2, 10);
+    update_history(&sender, 4, 4, 6, 0);
+    update_history(&sender, 7, 7, 3, 0);
+
+    bool last = false;
+    CHECK(ship(sender, &receiver, 0, 2, false, false, &last));
+    CHECK_EQ(receiver.size(), 2u);
+
+    // 重复或乱序到达的0号段不能清掉已收到的变化点
+    CHECK(!ship(sender, &receiver, 0, 2, false, false, &last));
+    CHECK_EQ(receiver.size(), 2u);
+    CHECK_EQ(receiver[1].s_balance, 6);
+
+    // 账本导出从0开始重发时带重写标志，整段替换
+    ScalableBalanceHistory exported(2);
+    exported.reset(2, 10);
+    update_history(&exported, 5, 5, 1, 0);
+    CHECK(ship(exported, &receiver, 0, exported.size(), true, true, &last));
+    CHECK(last);
+    CHECK_EQ(receiver.size(), exported.size());
+    CHECK_EQ(receiver[1].s_time, 5);
+    CHECK_EQ(receiver[1].s_balance, 1);
+}
+
+// ==================== 时间点查询索引 ====================
+
+static void test_index_boundaries() {
+    // 账户1: t2 起余额10，t5 转出4（在途到 t7 由账户2收到）
+    // 账户2: t3 起余额5，t7 收到4
+    ScalableBalanceHistory first(1);
+    first.push_back({2, 10, 0});
+    first.push_back({5, 6, 0});
+    ScalableBalanceHistory second(2);
+    second.push_back({3, 5, 0});
+    second.push_back({5, 5, 4});
+    second.push_back({7, 9, 0});
+    second.set_end_time(9);
+    HistoryIndex index({&first, &second});
+
+    // 第一个变化点之前
+    CHECK_EQ(index.total_at(0), 0);
+    CHECK_EQ(index.total_at(1), 0);
+    CHECK_EQ(index.pending_in_at(1), 0);
+    CHECK_EQ(index.balance_at(1, 1), 0);
+
+    // 正好落在变化点上（含两个账户同一时刻的变化点合并为一项）
+    CHECK_EQ(index.total_at(2), 10);
+    CHECK_EQ(index.total_at(3), 15);
+    CHECK_EQ(index.total_at(4), 15);
+    CHECK_EQ(index.total_at(5), 11);
+    CHECK_EQ(index.pending_in_at(5), 4);
+    CHECK_EQ(index.total_at(7), 15);
+    CHECK_EQ(index.pending_in_at(7), 0);
+    CHECK_EQ(index.size(), 4u);
+    for (lamport_time_t t = 2; t <= 9; ++t) {
+        CHECK_EQ(index.total_at(t) + index.pending_in_at(t) - (t < 3 ? 0 : 5), 10);
+    }
+
+    // 最后一个变化点之后沿用最终状态
+    CHECK_EQ(index.total_at(1000), 15);
+    CHECK_EQ(index.balance_at(1, 1000), 6);
+    CHECK_EQ(index.balance_at(2, 1000), 9);
+    CHECK_EQ(index.balance_at(3, 1000), 0);   // 不存在的账户
+}
+
+// ==================== 冷存储 ====================
+
+static void test_archive_created_on_first_spill() {
+    char directory[] = "/tmp/history_test_XXXXXX";
+    CHECK(mkdtemp(directory) != nullptr);
+    HistoryArchive::set_directory(directory);
+    std::string path = HistoryArchive::temp_path(7);
+    const lamport_time_t chunk = static_cast<lamport_time_t>(ScalableBalanceHistory::kChunkStates);
+    {
+        ScalableBalanceHistory history(7);
+        history.reset(7, 0);
+        history.enable_archive(path, 2);
+        // 两块以内全部在内存中，不创建段文件
+        for (lamport_time_t t = 1; t < 2 * chunk; ++t) {
+            history.record(t, static_cast<balance_t>(t % 100), 0);
+        }
+        CHECK_EQ(history.archived_size(), 0u);
+        CHECK(access(path.c_str(), F_OK) != 0);
+
+        for (lamport_time_t t = 2 * chunk; t < 5 * chunk; ++t) {
+            history.record(t, static_cast<balance_t>(t % 100), 0);
+        }
+        CHECK(history.archived_size() > 0);
+        CHECK(access(path.c_str(), F_OK) == 0);
+        CHECK_EQ(history.state_at(12345).s_balance, 12345 % 100);
+        CHECK_EQ(history[3].s_balance, 3);
+    }
+    // 历史销毁时段文件随之删除
+    CHECK(access(path.c_str(), F_OK) != 0);
+    HistoryArchive::set_directory("");
+    rmdir(directory);
+}
+
+int main() {
+    test_record_change_points();
+    test_late_credit_raises_whole_interval();
+    test_late_credit_on_change_point();
+    test_rewrite_segment_after_late_credit();
+    test_first_segment_resets_only_empty_history();
+    test_index_boundaries();
+    test_archive_created_on_first_spill();
+    return test_result("history_test");
+}
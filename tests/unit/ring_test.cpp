@@ -0,0 +1,183 @@
+#include "banking_system/common/mpsc_ring.h"
+#include "banking_system/common/spsc_ring.h"
+#include "banking_system/transfer/transfer_task.h"
+#include "../test_common.h"
+#include <thread>
+#include <vector>
+
+// ==================== MPSC环形队列 ====================
+
+static void test_mpsc_empty_and_full() {
+    MpscRing<int> ring(5);
+    CHECK_EQ(ring.capacity(), 8u);   // 向上取整为2的幂
+
+    int item = -1;
+    CHECK(ring.empty_approx());
+    CHECK(!ring.try_pop(item));
+    CHECK_EQ(item, -1);
+
+    for (int i = 0; i < 8; ++i) {
+        CHECK(ring.try_push(i));
+    }
+    CHECK(ring.full_approx());
+    CHECK(!ring.try_push(8));
+    int bulk[3] = {8, 9, 10};
+    CHECK_EQ(ring.try_push_bulk(bulk, 3), 0u);
+
+    for (int i = 0; i < 8; ++i) {
+        CHECK(ring.try_pop(item));
+        CHECK_EQ(item, i);
+    }
+    CHECK(!ring.try_pop(item));
+    CHECK(ring.empty_approx());
+}
+
+static void test_mpsc_wrap_around() {
+    MpscRing<int> ring(4);
+    int next_push = 0;
+    int next_pop = 0;
+    int item = 0;
+    // 每轮写入3个、取出3个，读写位置多次越过容量，槽位序号随之回绕
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 3; ++i) {
+            CHECK(ring.try_push(next_push++));
+        }
+        for (int i = 0; i < 3; ++i) {
+            CHECK(ring.try_pop(item));
+            CHECK_EQ(item, next_pop++);
+        }
+    }
+
+    // 从非零偏移开始填满整个环，再按顺序取空
+    for (int i = 0; i < 4; ++i) {
+        CHECK(ring.try_push(next_push++));
+    }
+    CHECK(!ring.try_push(-1));
+    int out[8];
+    CHECK_EQ(ring.pop_bulk(out, 8), 4u);
+    for (int i = 0; i < 4; ++i) {
+        CHECK_EQ(out[i], next_pop++);
+    }
+
+    // 批量写入在环尾回绕，空间不足时只写入能放下的部分
+    CHECK(ring.try_push(next_push++));
+    int bulk[5] = {next_push, next_push + 1, next_push + 2, next_push + 3, next_push + 4};
+    CHECK_EQ(ring.try_push_bulk(bulk, 5), 3u);
+    next_push += 3;
+    while (ring.try_pop(item)) {
+        CHECK_EQ(item, next_pop++);
+    }
+    CHECK_EQ(next_pop, next_push);
+}
+
+static void test_mpsc_concurrent_producers() {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 100000;
+    MpscRing<int> ring(64);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&ring, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                while (!ring.try_push(p * kPerProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // 每个生产者的元素按它写入的顺序出队，且一个不少
+    std::vector<int> next(kProducers, 0);
+    int received = 0;
+    int item = 0;
+    bool ordered = true;
+    while (received < kProducers * kPerProducer) {
+        if (!ring.try_pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int producer = item / kPerProducer;
+        ordered = ordered && item % kPerProducer == next[producer];
+        ++next[producer];
+        ++received;
+    }
+    for (std::thread& t : producers) {
+        t.join();
+    }
+    CHECK(ordered);
+    CHECK(!ring.try_pop(item));
+}
+
+// ==================== SPSC环形队列（Step2通道） ====================
+
+static void test_spsc_empty_full_and_wrap() {
+    SpscRing<TransferTask> ring(4);
+    CHECK_EQ(ring.capacity(), 4u);
+
+    TransferTask task;
+    CHECK(ring.empty_approx());
+    CHECK(!ring.try_pop(task));
+
+    uint64_t next_push = 1;
+    uint64_t next_pop = 1;
+    for (int round = 0; round < 50; ++round) {
+        // 填满：第5个写入失败
+        for (int i = 0; i < 4; ++i) {
+            TransferTask step2(TaskType::CROSS_SHARD_STEP2, 1, 2, 1, next_push++, 0, 1);
+            CHECK(ring.try_push(step2));
+        }
+        CHECK(!ring.try_push(task));
+        // 取出一半再补满，读写位置在环内错开
+        for (int i = 0; i < 2; ++i) {
+            CHECK(ring.try_pop(task));
+            CHECK_EQ(task.correlation_id, next_pop++);
+        }
+        for (int i = 0; i < 2; ++i) {
+            TransferTask step2(TaskType::CROSS_SHARD_STEP2, 1, 2, 1, next_push++, 0, 1);
+            CHECK(ring.try_push(step2));
+        }
+        while (ring.try_pop(task)) {
+            CHECK_EQ(task.correlation_id, next_pop++);
+        }
+        CHECK(ring.empty_approx());
+    }
+    CHECK_EQ(next_pop, next_push);
+}
+
+static void test_spsc_concurrent() {
+    constexpr uint64_t kItems = 500000;
+    SpscRing<TransferTask> ring(16);
+
+    std::thread producer([&ring] {
+        for (uint64_t i = 1; i <= kItems; ++i) {
+            TransferTask step2(TaskType::CROSS_SHARD_STEP2, 1, 2, 1, i, 0, 1);
+            while (!ring.try_push(step2)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t expected = 1;
+    bool ordered = true;
+    TransferTask task;
+    while (expected <= kItems) {
+        if (!ring.try_pop(task)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && task.correlation_id == expected;
+        ++expected;
+    }
+    producer.join();
+    CHECK(ordered);
+    CHECK(!ring.try_pop(task));
+}
+
+int main() {
+    test_mpsc_empty_and_full();
+    test_mpsc_wrap_around();
+    test_mpsc_concurrent_producers();
+    test_spsc_empty_full_and_wrap();
+    test_spsc_concurrent();
+    return test_result("ring_test");
+}
@@ -0,0 +1,121 @@
+#include "banking_system/common/flat_id_map.h"
+#include "banking_system/transfer/cross_shard_table.h"
+#include "banking_system/transfer/transfer_task.h"
+#include "../test_common.h"
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// ==================== 在途转账表 ====================
+
+static void test_insert_find_erase() {
+    FlatIdMap<TransferTask> in_flight(64);
+    CHECK_EQ(in_flight.capacity(), 128u);
+    CHECK(in_flight.empty());
+
+    TransferTask task(1, 2, 3);
+    task.correlation_id = 42;
+    CHECK(in_flight.insert(42, task));
+    CHECK(!in_flight.insert(42, task));    // 重复登记
+    CHECK_EQ(in_flight.size(), 1u);
+
+    TransferTask* found = in_flight.find(42);
+    CHECK(found != nullptr);
+    if (found != nullptr) {
+        CHECK_EQ(found->amount, 3);
+    }
+    CHECK(in_flight.find(43) == nullptr);
+    CHECK(in_flight.find(0) == nullptr);   // 0 是空槽标记，从不命中
+
+    TransferTask out;
+    CHECK(in_flight.erase(42, &out));
+    CHECK_EQ(out.correlation_id, 42u);
+    CHECK(!in_flight.erase(42));
+    CHECK(in_flight.empty());
+}
+
+static void test_window_does_not_grow() {
+    // 在途深度不超过预留窗口时，槽位数不变（稳态不分配内存）
+    FlatIdMap<lamport_time_t> acks(64);
+    size_t capacity = acks.capacity();
+    uint64_t next = 1;
+    for (int round = 0; round < 1000; ++round) {
+        for (int i = 0; i < 64; ++i) {
+            CHECK(acks.insert(next + i, static_cast<lamport_time_t>(next + i)));
+        }
+        for (int i = 0; i < 64; ++i) {
+            lamport_time_t time = 0;
+            CHECK(acks.erase(next + i, &time));
+            CHECK_EQ(time, static_cast<lamport_time_t>(next + i));
+        }
+        next += 64;
+    }
+    CHECK_EQ(acks.capacity(), capacity);
+    CHECK(acks.empty());
+
+    // 超出窗口（不受窗口限制的Step2）时扩容，已有元素仍可找到
+    for (uint64_t id = 1; id <= 1000; ++id) {
+        CHECK(acks.insert(id, static_cast<lamport_time_t>(id)));
+    }
+    CHECK(acks.capacity() >= 2000u);
+    for (uint64_t id = 1; id <= 1000; ++id) {
+        lamport_time_t* time = acks.find(id);
+        CHECK(time != nullptr && *time == static_cast<lamport_time_t>(id));
+    }
+}
+
+static void test_matches_unordered_map() {
+    // 递增的本地ID和带代数、最高位的表ID混合，随机插入删除，与 unordered_map 对照
+    FlatIdMap<int> map(16);
+    std::unordered_map<uint64_t, int> expected;
+    std::mt19937_64 random(12345);
+    std::vector<uint64_t> ids;
+    for (uint64_t i = 1; i <= 512; ++i) {
+        ids.push_back(i);
+        ids.push_back(CrossShardContextTable::kTableIdFlag | ((i % 7) << 32) | (i % 97));
+    }
+    for (int step = 0; step < 200000; ++step) {
+        uint64_t id = ids[random() % ids.size()];
+        int value = static_cast<int>(random() % 1000);
+        switch (random() % 3) {
+            case 0:
+                CHECK_EQ(map.insert(id, value), expected.emplace(id, value).second);
+                break;
+            case 1: {
+                int out = -1;
+                bool erased = map.erase(id, &out);
+                auto it = expected.find(id);
+                CHECK_EQ(erased, it != expected.end());
+                if (it != expected.end()) {
+                    CHECK_EQ(out, it->second);
+                    expected.erase(it);
+                }
+                break;
+            }
+            default: {
+                int* found = map.find(id);
+                auto it = expected.find(id);
+                CHECK_EQ(found != nullptr, it != expected.end());
+                if (found != nullptr && it != expected.end()) {
+                    CHECK_EQ(*found, it->second);
+                }
+                break;
+            }
+        }
+    }
+    CHECK_EQ(map.size(), expected.size());
+    size_t visited = 0;
+    map.for_each([&](uint64_t id, int value) {
+        ++visited;
+        auto it = expected.find(id);
+        CHECK(it != expected.end() && it->second == value);
+    });
+    CHECK_EQ(visited, expected.size());
+}
+
+int main() {
+    test_insert_find_erase();
+    test_window_does_not_grow();
+    test_matches_unordered_map();
+    return test_result("shard_test");
+}
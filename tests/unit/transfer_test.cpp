@@ -0,0 +1,252 @@
+#include "banking_system/transfer/cross_shard_table.h"
+#include "banking_system/history/history_collector.h"
+#include "banking_system/ipc/process_barrier.h"
+#include "banking_system/ipc/shm_transport.h"
+#include "banking_system/ipc/spanning_tree.h"
+#include "banking_system/process/child_worker.h"
+#include "banking_system/shard/shard_manager.h"
+#include "../test_common.h"
+#include <chrono>
+#include <csignal>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ==================== 跨分片上下文表 ====================
+
+static uint32_t generation_of(uint64_t correlation_id) {
+    return static_cast<uint32_t>(correlation_id >> 32) & CrossShardContextTable::kGenerationMask;
+}
+
+static uint32_t index_of(uint64_t correlation_id) {
+    return static_cast<uint32_t>(correlation_id);
+}
+
+static void test_id_encoding() {
+    CrossShardContextTable table(4);
+    TransferTask task(TaskType::CROSS_SHARD_STEP1, 3, 7, 5, 0, 0, 1);
+    uint64_t id = table.acquire(task);
+
+    // bit 63 为表标志，bit 32-62 为代数，低32位为槽位下标
+    CHECK(id != 0);
+    CHECK(CrossShardContextTable::owns(id));
+    CHECK_EQ(id >> 63, 1u);
+    CHECK_EQ(generation_of(id), 0u);
+    CHECK(index_of(id) < table.capacity());
+    CHECK_EQ(task.correlation_id, id);
+
+    const CrossShardContext* context = table.find(id);
+    CHECK(context != nullptr);
+    if (context != nullptr) {
+        CHECK_EQ(context->task.src_account, 3u);
+        CHECK_EQ(context->task.dst_account, 7u);
+        CHECK_EQ(context->task.amount, 5);
+        CHECK(!context->step1_completed);
+    }
+    CHECK_EQ(table.in_use(), 1u);
+
+    // 管理器递增分配的本地ID没有表标志，下标越界的ID同样查不到
+    CHECK(!CrossShardContextTable::owns(12345));
+    CHECK(table.find(12345) == nullptr);
+    CHECK(table.find(CrossShardContextTable::kTableIdFlag | 4) == nullptr);
+    CHECK(!table.release(12345));
+}
+
+static void test_stale_id_rejected() {
+    CrossShardContextTable table(1);
+    TransferTask task(TaskType::CROSS_SHARD_STEP1, 1, 2, 1, 0, 0, 1);
+    uint64_t first = table.acquire(task);
+    CHECK(table.release(first));
+    CHECK(table.find(first) == nullptr);
+    CHECK(!table.release(first));          // 重复释放
+    CHECK_EQ(table.in_use(), 0u);
+
+    // 同一槽位被复用：代数加1，旧ID既查不到新上下文，也不能释放它
+    TransferTask reuse(TaskType::CROSS_SHARD_STEP1, 4, 5, 2, 0, 0, 1);
+    uint64_t second = table.acquire(reuse);
+    CHECK_EQ(index_of(second), index_of(first));
+    CHECK_EQ(generation_of(second), generation_of(first) + 1);
+    CHECK(table.find(first) == nullptr);
+    CHECK(!table.release(first));
+    CHECK(table.find(second) != nullptr);
+    CHECK(table.release(second));
+}
+
+static void test_full_table() {
+    CrossShardContextTable table(2);
+    TransferTask task;
+    uint64_t a = table.acquire(task);
+    uint64_t b = table.acquire(task);
+    CHECK(a != 0 && b != 0 && a != b);
+    CHECK_EQ(table.acquire(task), 0u);     // 表满返回0
+    CHECK(table.release(a));
+    uint64_t c = table.acquire(task);
+    CHECK(c != 0);
+    CHECK_EQ(index_of(c), index_of(a));
+}
+
+static void test_generation_rollover() {
+    // 代数从最大值开始：下一次复用回绕到0
+    CrossShardContextTable table(1, CrossShardContextTable::kGenerationMask);
+    TransferTask task;
+    uint64_t last = table.acquire(task);
+    CHECK_EQ(generation_of(last), CrossShardContextTable::kGenerationMask);
+    CHECK(CrossShardContextTable::owns(last));
+    CHECK(table.release(last));
+
+    uint64_t wrapped = table.acquire(task);
+    CHECK_EQ(generation_of(wrapped), 0u);
+    // 回绕后代数和下标都为0，表标志保证ID仍不为0（0表示表满）
+    CHECK_EQ(wrapped, CrossShardContextTable::kTableIdFlag);
+    CHECK(wrapped != last);
+    CHECK(table.find(last) == nullptr);
+    CHECK(!table.release(last));
+    CHECK(table.find(wrapped) != nullptr);
+    CHECK(table.release(wrapped));
+}
+
+static void test_concurrent_acquire_release() {
+    constexpr int kThreads = 4;
+    constexpr int kRounds = 50000;
+    CrossShardContextTable table(8);
+
+    // 带标签的空闲栈：并发申请/释放时每个ID只对应申请者自己的上下文
+    std::vector<int> mismatches(kThreads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&table, &mismatches, t] {
+            for (int i = 0; i < kRounds; ++i) {
+                account_id_t src = static_cast<account_id_t>(t);
+                account_id_t dst = static_cast<account_id_t>(i);
+                TransferTask task(TaskType::CROSS_SHARD_STEP1, src, dst, 1, 0, 0, 1);
+                uint64_t id = table.acquire(task);
+                if (id == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                const CrossShardContext* context = table.find(id);
+                if (context == nullptr || context->task.src_account != src ||
+                    context->task.dst_account != dst) {
+                    ++mismatches[t];
+                }
+                if (!table.release(id)) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < kThreads; ++t) {
+        CHECK_EQ(mismatches[t], 0);
+    }
+    CHECK_EQ(table.in_use(), 0u);
+
+    // 所有槽位都回到空闲栈
+    TransferTask task;
+    std::vector<uint64_t> ids;
+    for (size_t i = 0; i < table.capacity(); ++i) {
+        ids.push_back(table.acquire(task));
+        CHECK(ids.back() != 0);
+    }
+    CHECK_EQ(table.acquire(task), 0u);
+}
+
+// ==================== 无效订单 ====================
+
+/**
+ * @brief 通知子进程停止并等待它们退出（与 ParentController 阶段3相同的生成树协议）
+ */
+static void stop_children(int count_nodes, const std::vector<pid_t>& children) {
+    SpanningTree tree(PARENT_ID, count_nodes);
+    Message msg;
+    fill_message(&msg, STOP, 0, nullptr, 0);
+    for (int k = 0; k < tree.child_count(); ++k) {
+        send(tree.child(k), &msg);
+    }
+    std::vector<Message> inbox(16);
+    int done_count = 0;
+    while (done_count < tree.child_count()) {
+        int count = receive_many_for(inbox.data(), static_cast<int>(inbox.size()), nullptr, 1000);
+        if (count <= 0) {
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            if (inbox[i].s_header.s_type == DONE) {
+                ++done_count;
+            }
+        }
+    }
+    fill_message(&msg, DONE, 0, nullptr, 0);
+    for (int k = 0; k < tree.child_count(); ++k) {
+        send(tree.child(k), &msg);
+    }
+    for (pid_t pid : children) {
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+static void test_rejected_orders_complete() {
+    constexpr int kNodes = 3;
+    ShmTransport& transport = ShmTransport::instance();
+    CHECK(transport.create(kNodes));
+
+    std::vector<pid_t> children;
+    for (int id = 1; id < kNodes; ++id) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            transport.attach(static_cast<local_id>(id));
+            ChildWorker worker(ChildArguments{static_cast<local_id>(id), kNodes, 10});
+            worker.run();
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    transport.attach(PARENT_ID);
+    CHECK(ProcessBarrier::instance().wait(PARENT_ID, kNodes, STARTED));
+
+    // 父进程拒绝不存在的账户；自转账通过父进程检查，由源进程回传NACK。
+    // 两者都必须按失败完成，否则等待全部完成会一直挂起
+    HistoryCollector history(kNodes - 1);
+    bool finished = false;
+    {
+        ShardManager manager(2, AccountShard::kDefaultMaxInFlight, ClockMode::GLOBAL, &history);
+        TransferHandle out_of_range = manager.submit_transfer_async(1, 9, 1);
+        TransferHandle from_parent = manager.submit_transfer_async(0, 2, 1);
+        TransferHandle self_transfer = manager.submit_transfer_async(1, 1, 1);
+        TransferHandle valid = manager.submit_transfer_async(1, 2, 1);
+        AccountTransfer batch[] = {{2, 9, 1}, {2, 1, 1}};
+        manager.submit_transfers(batch, 2);
+
+        finished = manager.wait_for(std::chrono::steady_clock::now() + std::chrono::seconds(10));
+        CHECK(finished);
+        if (!finished) {
+            // 转账挂起：析构函数会一直等待，直接结束子进程并退出
+            for (pid_t pid : children) {
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+            }
+            transport.destroy();
+            std::_Exit(test_result("transfer_test"));
+        }
+        CHECK(!out_of_range.get().success);
+        CHECK(!from_parent.get().success);
+        CHECK(!self_transfer.get().success);
+        CHECK(valid.get().success);
+    }
+
+    stop_children(kNodes, children);
+    transport.destroy();
+}
+
+int main() {
+    test_id_encoding();
+    test_stale_id_rejected();
+    test_full_table();
+    test_generation_rollover();
+    test_concurrent_acquire_release();
+    test_rejected_orders_complete();
+    return test_result("transfer_test");
+}